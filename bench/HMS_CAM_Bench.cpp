@@ -0,0 +1,302 @@
+#include "HMS_CAM_Bench.h"
+
+#include <chrono>
+#include <ctime>
+#include <regex>
+#include <thread>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__) || defined(__APPLE__)
+    #include <unistd.h>
+#endif
+
+#ifndef HMS_CAM_BENCH_VERSION
+    #define HMS_CAM_BENCH_VERSION               "unknown"
+#endif
+
+namespace {
+
+struct BenchEntry {
+    std::string                     name;
+    HMS_CAM_BenchFunction           fn;
+    std::vector<int64_t>            args;
+};
+
+struct BenchResult {
+    std::string                     name;
+    uint64_t                        iterations;
+    double                          realNs;                                                 // Per iteration
+    double                          cpuNs;                                                  // Per iteration
+    double                          bytesPerSecond;
+    double                          itemsPerSecond;
+    std::string                     label;
+    std::string                     error;
+    std::map<std::string, double>   counters;
+};
+
+std::vector<BenchEntry>& benchRegistry() {
+    static std::vector<BenchEntry> registry;
+    return registry;
+}
+
+int64_t benchRealNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+int64_t benchCpuNs() {
+    #if defined(CLOCK_THREAD_CPUTIME_ID)
+        timespec ts;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+    #else
+        return (int64_t)std::clock() * (1000000000 / CLOCKS_PER_SEC);
+    #endif
+}
+
+std::string benchEscape(const std::string &in) {
+    std::string out;
+    for (char c : in) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if ((unsigned char)c < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", (unsigned)c);
+            out += buf;
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+void benchWriteJSON(FILE *out, const char *executable, const std::vector<BenchResult> &results) {
+    char date[64] = "";
+    time_t now = time(NULL);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", localtime(&now));
+
+    char host[256] = "unknown";
+    #if defined(__linux__) || defined(__APPLE__)
+        gethostname(host, sizeof(host) - 1);
+    #endif
+
+    fprintf(out, "{\n  \"context\": {\n");
+    fprintf(out, "    \"date\": \"%s\",\n", date);
+    fprintf(out, "    \"host_name\": \"%s\",\n", benchEscape(host).c_str());
+    fprintf(out, "    \"executable\": \"%s\",\n", benchEscape(executable).c_str());
+    fprintf(out, "    \"num_cpus\": %u,\n", std::thread::hardware_concurrency());
+    fprintf(out, "    \"library_version\": \"%s\",\n", HMS_CAM_BENCH_VERSION);
+    #ifdef NDEBUG
+        fprintf(out, "    \"library_build_type\": \"release\"\n");
+    #else
+        fprintf(out, "    \"library_build_type\": \"debug\"\n");
+    #endif
+    fprintf(out, "  },\n  \"benchmarks\": [");
+
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult &r = results[i];
+        fprintf(out, "%s\n    {\n", i ? "," : "");
+        fprintf(out, "      \"name\": \"%s\",\n", benchEscape(r.name).c_str());
+        fprintf(out, "      \"run_name\": \"%s\",\n", benchEscape(r.name).c_str());
+        fprintf(out, "      \"run_type\": \"iteration\",\n");
+        fprintf(out, "      \"repetitions\": 1,\n");
+        fprintf(out, "      \"repetition_index\": 0,\n");
+        fprintf(out, "      \"threads\": 1,\n");
+        if (!r.error.empty()) {
+            fprintf(out, "      \"error_occurred\": true,\n");
+            fprintf(out, "      \"error_message\": \"%s\",\n", benchEscape(r.error).c_str());
+        }
+        fprintf(out, "      \"iterations\": %llu,\n", (unsigned long long)r.iterations);
+        fprintf(out, "      \"real_time\": %.4e,\n", r.realNs);
+        fprintf(out, "      \"cpu_time\": %.4e,\n", r.cpuNs);
+        fprintf(out, "      \"time_unit\": \"ns\"");
+        if (r.bytesPerSecond > 0) fprintf(out, ",\n      \"bytes_per_second\": %.4e", r.bytesPerSecond);
+        if (r.itemsPerSecond > 0) fprintf(out, ",\n      \"items_per_second\": %.4e", r.itemsPerSecond);
+        for (const auto &counter : r.counters) {
+            fprintf(out, ",\n      \"%s\": %.4e", benchEscape(counter.first).c_str(), counter.second);
+        }
+        if (!r.label.empty()) fprintf(out, ",\n      \"label\": \"%s\"", benchEscape(r.label).c_str());
+        fprintf(out, "\n    }");
+    }
+    fprintf(out, "\n  ]\n}\n");
+}
+
+void benchPrintConsole(const BenchResult &r) {
+    if (!r.error.empty()) {
+        printf("%-44s ERROR OCCURRED: '%s'\n", r.name.c_str(), r.error.c_str());
+        return;
+    }
+
+    printf("%-44s %12.0f ns %12.0f ns %10llu", r.name.c_str(), r.realNs, r.cpuNs, (unsigned long long)r.iterations);
+    if (r.bytesPerSecond > 0) printf(" bytes_per_second=%.2fMi/s", r.bytesPerSecond / (1024.0 * 1024.0));
+    if (r.itemsPerSecond > 0) printf(" items_per_second=%.2fk/s", r.itemsPerSecond / 1000.0);
+    for (const auto &counter : r.counters) {
+        printf(" %s=%.4g", counter.first.c_str(), counter.second);
+    }
+    if (!r.label.empty()) printf(" %s", r.label.c_str());
+    printf("\n");
+    fflush(stdout);
+}
+
+BenchResult benchRunOne(const std::string &name, HMS_CAM_BenchFunction fn, int64_t arg, double minTime) {
+    const uint64_t maxIterations = 1000000000ull;
+    uint64_t iterations = 1;
+
+    for (;;) {
+        HMS_CAM_BenchState state(arg, iterations);
+        fn(state);
+
+        double seconds = state.realNs() / 1e9;
+        bool   done    = !state.error().empty() || seconds >= minTime || iterations >= maxIterations;
+        if (done) {
+            BenchResult r;
+            r.name           = name;
+            r.iterations     = iterations;
+            r.realNs         = (double)state.realNs() / iterations;
+            r.cpuNs          = (double)state.cpuNs() / iterations;
+            r.bytesPerSecond = seconds > 0 ? state.bytesProcessed() / seconds : 0;
+            r.itemsPerSecond = seconds > 0 ? state.itemsProcessed() / seconds : 0;
+            r.label          = state.label();
+            r.error          = state.error();
+            r.counters       = state.counters();
+            return r;
+        }
+
+        // Grow the iteration count towards minTime, at most 10x per step
+        double multiplier = seconds > 0 ? minTime * 1.4 / seconds : 10.0;
+        multiplier = multiplier > 10.0 ? 10.0 : multiplier;
+        uint64_t next = (uint64_t)(iterations * multiplier);
+        iterations = next > iterations ? (next < maxIterations ? next : maxIterations) : iterations + 1;
+    }
+}
+
+} // namespace
+
+void HMS_CAM_BenchState::pauseTiming() {
+    if (_running) {
+        _realNs  += benchRealNs() - _realStart;
+        _cpuNs   += benchCpuNs() - _cpuStart;
+        _running  = false;
+    }
+}
+
+void HMS_CAM_BenchState::resumeTiming() {
+    if (!_running) {
+        _realStart = benchRealNs();
+        _cpuStart  = benchCpuNs();
+        _running   = true;
+    }
+}
+
+bool HMS_CAM_Bench::add(const char *name, HMS_CAM_BenchFunction fn, const std::vector<int64_t> &args) {
+    benchRegistry().push_back({name, fn, args});
+    return true;
+}
+
+std::vector<int64_t> HMS_CAM_Bench::frameSizes() {
+    std::vector<int64_t> sizes;
+    for (int size = FRAMESIZE_QQVGA; size <= FRAMESIZE_UXGA; size++) {
+        sizes.push_back(size);
+    }
+    return sizes;
+}
+
+const char* HMS_CAM_Bench::frameSizeName(int64_t size) {
+    static const char *names[] = {
+        "96X96", "QQVGA", "128X128", "QCIF", "HQVGA", "240X240", "QVGA", "320X320",
+        "CIF", "HVGA", "VGA", "SVGA", "XGA", "HD", "SXGA", "UXGA",
+        "FHD", "P_HD", "P_3MP", "QXGA", "QHD", "WQXGA", "P_FHD", "QSXGA", "5MP"
+    };
+    return (size >= 0 && size < (int64_t)(sizeof(names) / sizeof(names[0]))) ? names[size] : "INVALID";
+}
+
+int HMS_CAM_Bench::run(int argc, char **argv) {
+    std::string filter  = ".";
+    std::string format  = "console";
+    std::string outPath;
+    double      minTime = 0.5;
+    bool        list    = false;
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        if (strncmp(a, "--benchmark_filter=", 19) == 0) {
+            filter = a + 19;
+        } else if (strncmp(a, "--benchmark_min_time=", 21) == 0) {
+            minTime = atof(a + 21);                                                         // Accepts "0.5" and "0.5s"
+        } else if (strncmp(a, "--benchmark_format=", 19) == 0) {
+            format = a + 19;
+        } else if (strncmp(a, "--benchmark_out=", 16) == 0) {
+            outPath = a + 16;
+        } else if (strcmp(a, "--benchmark_list_tests") == 0 || strcmp(a, "--benchmark_list_tests=true") == 0) {
+            list = true;
+        } else if (strncmp(a, "--benchmark_out_format=", 23) == 0) {
+            // JSON is the only file format
+        } else {
+            fprintf(stderr, "usage: %s [--benchmark_filter=<regex>] [--benchmark_min_time=<seconds>]\n"
+                            "          [--benchmark_format=console|json] [--benchmark_out=<file>] [--benchmark_list_tests]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::regex pattern;
+    try {
+        pattern = std::regex(filter);
+    } catch (const std::regex_error &) {
+        fprintf(stderr, "Invalid benchmark filter: %s\n", filter.c_str());
+        return 1;
+    }
+
+    bool json = format == "json";
+    if (!json && !list) {
+        printf("%-44s %15s %15s %10s\n", "Benchmark", "Time", "CPU", "Iterations");
+        printf("%s\n", std::string(88, '-').c_str());
+    }
+
+    std::vector<BenchResult> results;
+    for (const BenchEntry &entry : benchRegistry()) {
+        std::vector<int64_t> args = entry.args.empty() ? std::vector<int64_t>{0} : entry.args;
+        for (int64_t arg : args) {
+            std::string name = entry.name;
+            if (!entry.args.empty()) {
+                name += "/";
+                name += frameSizeName(arg);
+            }
+            if (!std::regex_search(name, pattern)) {
+                continue;
+            }
+            if (list) {
+                printf("%s\n", name.c_str());
+                continue;
+            }
+
+            results.push_back(benchRunOne(name, entry.fn, arg, minTime));
+            if (!json) {
+                benchPrintConsole(results.back());
+            }
+        }
+    }
+    if (list) {
+        return 0;
+    }
+
+    if (json) {
+        benchWriteJSON(stdout, argv[0], results);
+    }
+    if (!outPath.empty()) {
+        FILE *out = fopen(outPath.c_str(), "w");
+        if (!out) {
+            fprintf(stderr, "Cannot open %s\n", outPath.c_str());
+            return 1;
+        }
+        benchWriteJSON(out, argv[0], results);
+        fclose(out);
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    return HMS_CAM_Bench::run(argc, argv);
+}
@@ -0,0 +1,124 @@
+/*
+ ============================================================================================================================================
+ * File:        HMS_CAM_Bench.h
+ * Author:      Hamas Saeed
+ * Version:     Rev_1.0.0
+ * Date:        Jan 28 2026
+ * Brief:       This file package provides a minimal benchmark harness with Google Benchmark compatible JSON output.
+ ============================================================================================================================================
+ * License:
+ * MIT License
+ *
+ * Copyright (c) 2025 Hamas Saeed
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For any inquiries, contact Hamas Saeed at hamasaeed@gmail.com
+ ============================================================================================================================================
+ */
+
+#ifndef HMS_CAM_BENCH_H
+#define HMS_CAM_BENCH_H
+
+#include "HMS_CAM.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Per-run benchmark state                                       │
+  │       Timing covers the `while (state.keepRunning())` loop only,    │
+  │       setup before the loop is not measured.                        │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+class HMS_CAM_BenchState {
+public:
+    HMS_CAM_BenchState(int64_t arg, uint64_t iterations) : _arg(arg), _iterations(iterations) {}
+
+    bool keepRunning() {
+        if (_done == 0 && !_running) {
+            resumeTiming();
+        }
+        if (_done < _iterations) {
+            _done++;
+            return true;
+        }
+        pauseTiming();
+        return false;
+    }
+
+    void pauseTiming();
+    void resumeTiming();
+
+    int64_t arg() const                                     { return _arg;            }
+    uint64_t iterations() const                             { return _iterations;     }
+
+    void setBytesProcessed(uint64_t bytes)                  { _bytes = bytes;         }
+    void setItemsProcessed(uint64_t items)                  { _items = items;         }
+    void setLabel(const std::string &label)                 { _label = label;         }
+    void setCounter(const std::string &name, double value)  { _counters[name] = value; }
+    void skipWithError(const std::string &message)          { _error = message; _done = _iterations; }
+
+    int64_t realNs() const                                  { return _realNs;         }
+    int64_t cpuNs() const                                   { return _cpuNs;          }
+    uint64_t bytesProcessed() const                         { return _bytes;          }
+    uint64_t itemsProcessed() const                         { return _items;          }
+    const std::string& label() const                        { return _label;          }
+    const std::string& error() const                        { return _error;          }
+    const std::map<std::string, double>& counters() const   { return _counters;       }
+
+private:
+    int64_t                         _arg        = 0;                                        // Benchmark argument (frame size)
+    uint64_t                        _iterations = 0;                                        // Iterations requested for this run
+    uint64_t                        _done       = 0;                                        // Iterations started
+    bool                            _running    = false;                                    // Timer currently running
+    int64_t                         _realNs     = 0;                                        // Accumulated wall time
+    int64_t                         _cpuNs      = 0;                                        // Accumulated thread CPU time
+    int64_t                         _realStart  = 0;
+    int64_t                         _cpuStart   = 0;
+    uint64_t                        _bytes      = 0;                                        // Payload processed over the run
+    uint64_t                        _items      = 0;                                        // Items processed over the run
+    std::string                     _label;                                                 // Free-form label
+    std::string                     _error;                                                 // Set when the run was skipped
+    std::map<std::string, double>   _counters;                                              // User counters
+};
+
+typedef void (*HMS_CAM_BenchFunction)(HMS_CAM_BenchState &state);
+
+class HMS_CAM_Bench {
+public:
+    static bool add(const char *name, HMS_CAM_BenchFunction fn, const std::vector<int64_t> &args);
+    static int run(int argc, char **argv);
+
+    static std::vector<int64_t> frameSizes();                                               // QQVGA .. UXGA
+    static const char* frameSizeName(int64_t size);
+
+    template <typename T>
+    static void doNotOptimize(const T &value) {
+        #if defined(__GNUC__) || defined(__clang__)
+            asm volatile("" : : "r,m"(value) : "memory");
+        #else
+            static const void *volatile sink;
+            sink = &value;
+        #endif
+    }
+};
+
+#define HMS_CAM_BENCH(fn)                                                                   \
+    static const bool fn##_registered = HMS_CAM_Bench::add(#fn, fn, {})
+#define HMS_CAM_BENCH_FRAMESIZES(fn)                                                        \
+    static const bool fn##_registered = HMS_CAM_Bench::add(#fn, fn, HMS_CAM_Bench::frameSizes())
+
+#endif // HMS_CAM_BENCH_H
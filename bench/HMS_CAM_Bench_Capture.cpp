@@ -0,0 +1,511 @@
+#include "HMS_CAM_Bench.h"
+#include "HMS_CAM_Stream.h"
+#include "HMS_CAM_PreEvent.h"
+#include "HMS_CAM_Recorder.h"
+
+#include <vector>
+
+#ifndef _WIN32
+  #include <thread>
+  #include <unistd.h>
+  #include <sys/socket.h>
+#endif
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: One camera per scenario, frame sizes are switched with a live │
+  │       refresh so buffers are allocated once for UXGA.               │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+static HMS_CAM* benchCamera(framesize_t size, bool captureTask) {
+    static HMS_CAM *direct = NULL;
+    static HMS_CAM *engine = NULL;
+
+    HMS_CAM *&cam = captureTask ? engine : direct;
+    if (!cam) {
+        cam = new HMS_CAM();
+        cam->setPixelFormat(PIXFORMAT_JPEG);
+        cam->setFrameSize(size);
+        cam->setMaxFrameSize(FRAMESIZE_UXGA);
+        cam->setFBCount(3);
+        cam->setCaptureTask(captureTask);
+        cam->getSimSensor().setPattern(HMS_CAM_SIM_MOVING_BOX);
+        cam->getSimSensor().setFrameRate(0);                                                // Unpaced, measure library overhead
+        if (cam->begin() != HMS_CAM_OK) {
+            delete cam;
+            cam = NULL;
+            return NULL;
+        }
+    }
+
+    cam->setFrameSize(size);
+    if (cam->refresh() != HMS_CAM_OK) {
+        return NULL;
+    }
+    cam->resetStats();
+    return cam;
+}
+
+static void benchLabel(HMS_CAM_BenchState &state) {
+    char label[32];
+    snprintf(label, sizeof(label), "%ux%u",
+             (unsigned)resolution[state.arg()].width, (unsigned)resolution[state.arg()].height);
+    state.setLabel(label);
+}
+
+static void benchStatsCounters(HMS_CAM_BenchState &state, HMS_CAM *cam) {
+    HMS_CAM_StatsTypeDef stats;
+    cam->getStats(stats);
+    state.setCounter("fb_wait_p50_us", HMS_CAM_Stats::percentile(stats.fbWaitUs, 0.50f));
+    state.setCounter("fb_wait_p99_us", HMS_CAM_Stats::percentile(stats.fbWaitUs, 0.99f));
+    state.setCounter("retries", stats.retries);
+}
+
+static void BM_CaptureFrame(HMS_CAM_BenchState &state) {
+    HMS_CAM *cam = benchCamera((framesize_t)state.arg(), false);
+    if (!cam) {
+        state.skipWithError("camera setup failed");
+        return;
+    }
+
+    HMS_CAM_FrameBufferTypeDef frame;
+    uint64_t bytes = 0;
+    while (state.keepRunning()) {
+        if (cam->captureFrame(frame) != HMS_CAM_OK) {
+            state.skipWithError("captureFrame failed");
+            break;
+        }
+        bytes += frame.length;
+        HMS_CAM_Bench::doNotOptimize(frame);
+    }
+    cam->returnFrameBuffer();
+
+    state.setBytesProcessed(bytes);
+    state.setItemsProcessed(state.iterations());
+    benchStatsCounters(state, cam);
+    benchLabel(state);
+}
+HMS_CAM_BENCH_FRAMESIZES(BM_CaptureFrame);
+
+static void BM_CaptureLease(HMS_CAM_BenchState &state) {
+    HMS_CAM *cam = benchCamera((framesize_t)state.arg(), false);
+    if (!cam) {
+        state.skipWithError("camera setup failed");
+        return;
+    }
+
+    uint64_t bytes = 0;
+    while (state.keepRunning()) {
+        HMS_CAM_FrameLease lease;
+        if (cam->captureFrame(lease) != HMS_CAM_OK) {
+            state.skipWithError("captureFrame(lease) failed");
+            break;
+        }
+        bytes += lease.length();
+        HMS_CAM_Bench::doNotOptimize(lease.data());
+    }
+
+    state.setBytesProcessed(bytes);
+    state.setItemsProcessed(state.iterations());
+    benchStatsCounters(state, cam);
+    benchLabel(state);
+}
+HMS_CAM_BENCH_FRAMESIZES(BM_CaptureLease);
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Paced 30 fps sensor that stalls for 200 ms every 8th frame.   │
+  │       A 40 ms deadline keeps the worst call near the deadline where │
+  │       a blocking capture would sit out the whole stall.             │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+static void BM_CaptureDeadline(HMS_CAM_BenchState &state) {
+    HMS_CAM cam;
+    cam.setPixelFormat(PIXFORMAT_JPEG);
+    cam.setFrameSize((framesize_t)state.arg());
+    cam.setFBCount(2);
+    cam.setSettleTimeout(0);
+    cam.getSimSensor().setFrameRate(30);
+    cam.getSimSensor().setFault(HMS_CAM_SIM_FAULT_STALL, 8);
+    cam.getSimSensor().setStallTime(200);
+    if (cam.begin() != HMS_CAM_OK) {
+        state.skipWithError("camera setup failed");
+        return;
+    }
+
+    int64_t  worst    = 0;
+    uint64_t timeouts = 0;
+    while (state.keepRunning()) {
+        HMS_CAM_FrameLease lease;
+        int64_t start = HMS_CAM_Micros();
+        HMS_CAM_StatusTypeDef status = cam.captureFrame(lease, 40);
+        int64_t spent = HMS_CAM_Micros() - start;
+        if (status != HMS_CAM_OK && status != HMS_CAM_TIMEOUT) {
+            state.skipWithError("captureFrame(lease, timeout) failed");
+            break;
+        }
+        timeouts += status == HMS_CAM_TIMEOUT;
+        worst     = spent > worst ? spent : worst;
+        HMS_CAM_Bench::doNotOptimize(lease.data());
+    }
+
+    state.setItemsProcessed(state.iterations());
+    if (state.iterations()) {
+        state.setCounter("worst_us", (double)worst);
+        state.setCounter("timeout_ratio", (double)timeouts / state.iterations());
+    }
+    benchLabel(state);
+}
+HMS_CAM_BENCH_FRAMESIZES(BM_CaptureDeadline);
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Full begin() per iteration. The simulator charges 300 us per  │
+  │       SCCB register write and ramps exposure over six frames, so    │
+  │       the counters show where boot time goes.                       │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+static void BM_Begin(HMS_CAM_BenchState &state) {
+    HMS_CAM_BootReportTypeDef total = {};
+    uint32_t sccb = 0;
+    while (state.keepRunning()) {
+        HMS_CAM cam;
+        cam.setPixelFormat(PIXFORMAT_JPEG);
+        cam.setFrameSize((framesize_t)state.arg());
+        cam.getSimSensor().setFrameRate(0);
+        cam.getSimSensor().setSCCBDelay(300);
+        cam.getSimSensor().setSettleFrames(6);
+        if (cam.begin() != HMS_CAM_OK) {
+            state.skipWithError("begin failed");
+            return;
+        }
+        const HMS_CAM_BootReportTypeDef &report = cam.getBootReport();
+        total.initUs      += report.initUs;
+        total.configureUs += report.configureUs;
+        total.settleUs    += report.settleUs;
+        total.settleFrames = report.settleFrames;
+        sccb               = cam.getSimSensor().getSCCBWrites();
+    }
+
+    if (state.iterations()) {
+        state.setCounter("init_us", (double)total.initUs / state.iterations());
+        state.setCounter("configure_us", (double)total.configureUs / state.iterations());
+        state.setCounter("settle_us", (double)total.settleUs / state.iterations());
+        state.setCounter("settle_frames", total.settleFrames);
+        state.setCounter("sccb_writes", sccb);
+    }
+    benchLabel(state);
+}
+HMS_CAM_BENCH_FRAMESIZES(BM_Begin);
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Validates a private copy of one frame. `padding` zero bytes   │
+  │       after EOI emulate a DMA overrun the EOI scan has to cross.    │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+static void benchValidate(HMS_CAM_BenchState &state, HMS_CAM_JPEGCheck level, size_t padding) {
+    HMS_CAM *cam = benchCamera((framesize_t)state.arg(), false);
+    HMS_CAM_FrameBufferTypeDef frame;
+    if (!cam || cam->captureFrame(frame) != HMS_CAM_OK) {
+        state.skipWithError("camera setup failed");
+        return;
+    }
+    std::vector<uint8_t> jpeg(frame.buf, frame.buf + frame.length);
+    jpeg.resize(jpeg.size() + padding, 0);
+    size_t width = frame.width, height = frame.height;
+    cam->returnFrameBuffer();
+
+    HMS_CAM_JPEGInfoTypeDef info;
+    if (HMS_CAM_JPEG::check(jpeg.data(), jpeg.size(), level, info, width, height) != HMS_CAM_JPEG_VALID) {
+        state.skipWithError("reference frame rejected");
+        return;
+    }
+
+    uint64_t valid = 0;
+    while (state.keepRunning()) {
+        valid += HMS_CAM_JPEG::check(jpeg.data(), jpeg.size(), level, info, width, height) == HMS_CAM_JPEG_VALID;
+        HMS_CAM_Bench::doNotOptimize(valid);
+    }
+
+    state.setBytesProcessed((uint64_t)jpeg.size() * state.iterations());
+    state.setCounter("jpeg_bytes", (double)jpeg.size());
+    state.setCounter("trimmed", (double)info.trimmed);
+    benchLabel(state);
+}
+
+static void BM_ValidateJPEGBasic(HMS_CAM_BenchState &state)       { benchValidate(state, HMS_CAM_JPEG_BASIC, 0);  }
+static void BM_ValidateJPEGEOI(HMS_CAM_BenchState &state)         { benchValidate(state, HMS_CAM_JPEG_EOI, 0);    }
+static void BM_ValidateJPEGFull(HMS_CAM_BenchState &state)        { benchValidate(state, HMS_CAM_JPEG_FULL, 0);   }
+static void BM_ValidateJPEGPadded(HMS_CAM_BenchState &state)      { benchValidate(state, HMS_CAM_JPEG_FULL, 2048); }
+HMS_CAM_BENCH_FRAMESIZES(BM_ValidateJPEGBasic);
+HMS_CAM_BENCH_FRAMESIZES(BM_ValidateJPEGEOI);
+HMS_CAM_BENCH_FRAMESIZES(BM_ValidateJPEGFull);
+HMS_CAM_BENCH_FRAMESIZES(BM_ValidateJPEGPadded);
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Pre-event recorder with a 4 MiB arena. Append copies one      │
+  │       frame and evicts the oldest once the arena is full, flush     │
+  │       writes the whole arena to a file in the working directory.    │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+static bool benchPreEvent(HMS_CAM_BenchState &state, HMS_CAM_PreEvent &recorder, std::vector<uint8_t> &jpeg,
+                          HMS_CAM_FrameBufferTypeDef &frame) {
+    HMS_CAM *cam = benchCamera((framesize_t)state.arg(), false);
+    if (!cam || cam->captureFrame(frame) != HMS_CAM_OK) {
+        state.skipWithError("camera setup failed");
+        return false;
+    }
+    jpeg.assign(frame.buf, frame.buf + frame.length);
+    cam->returnFrameBuffer();
+    frame.buf = jpeg.data();
+
+    if (recorder.begin(4 << 20, 1024) != HMS_CAM_OK) {
+        state.skipWithError("arena allocation failed");
+        return false;
+    }
+    for (size_t filled = 0; filled < (4u << 20); filled += frame.length) {                 // Start in steady state, evicting
+        frame.timestampUs += 33333;
+        frame.sequence++;
+        recorder.append(frame);
+    }
+    return true;
+}
+
+static void BM_PreEventAppend(HMS_CAM_BenchState &state) {
+    HMS_CAM_PreEvent recorder;
+    std::vector<uint8_t> jpeg;
+    HMS_CAM_FrameBufferTypeDef frame;
+    if (!benchPreEvent(state, recorder, jpeg, frame)) {
+        return;
+    }
+
+    while (state.keepRunning()) {
+        frame.timestampUs += 33333;
+        frame.sequence++;
+        if (recorder.append(frame) != HMS_CAM_OK) {
+            state.skipWithError("append failed");
+            break;
+        }
+    }
+
+    HMS_CAM_PreEventStatsTypeDef stats;
+    recorder.getStats(stats);
+    state.setBytesProcessed((uint64_t)frame.length * state.iterations());
+    state.setItemsProcessed(state.iterations());
+    state.setCounter("held_frames", stats.frames);
+    state.setCounter("held_ms", (double)(stats.newestUs - stats.oldestUs) / 1000.0);
+    benchLabel(state);
+}
+HMS_CAM_BENCH_FRAMESIZES(BM_PreEventAppend);
+
+static void BM_PreEventFlush(HMS_CAM_BenchState &state) {
+    HMS_CAM_PreEvent recorder;
+    std::vector<uint8_t> jpeg;
+    HMS_CAM_FrameBufferTypeDef frame;
+    if (!benchPreEvent(state, recorder, jpeg, frame)) {
+        return;
+    }
+
+    const char *path = "HMS_CAM_bench_preevent.bin";
+    while (state.keepRunning()) {
+        if (recorder.flush(path) != HMS_CAM_OK) {
+            state.skipWithError("flush failed");
+            break;
+        }
+    }
+    remove(path);
+
+    HMS_CAM_PreEventStatsTypeDef stats;
+    recorder.getStats(stats);
+    state.setBytesProcessed(stats.flushedBytes);
+    state.setItemsProcessed(stats.flushedFrames);
+    state.setCounter("frames_per_flush", stats.flushes ? (double)stats.flushedFrames / stats.flushes : 0.0);
+    benchLabel(state);
+}
+HMS_CAM_BENCH_FRAMESIZES(BM_PreEventFlush);
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Indexed AVI recorder into the working directory, 16 MiB       │
+  │       preallocated. Frames are staged into 32 KiB writes, every 1024│
+  │       frames the file is closed and a new one begun. write_max_us is│
+  │       the slowest write.                                            │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+static void BM_RecorderAppend(HMS_CAM_BenchState &state) {
+    HMS_CAM *cam = benchCamera((framesize_t)state.arg(), false);
+    HMS_CAM_FrameBufferTypeDef frame;
+    if (!cam || cam->captureFrame(frame) != HMS_CAM_OK) {
+        state.skipWithError("camera setup failed");
+        return;
+    }
+    std::vector<uint8_t> jpeg(frame.buf, frame.buf + frame.length);
+    cam->returnFrameBuffer();
+    frame.buf = jpeg.data();
+
+    const char *path = "HMS_CAM_bench_recording.avi";
+    HMS_CAM_Recorder recorder;
+    HMS_CAM_RecorderStatsTypeDef stats;
+    uint64_t writes = 0;
+    uint32_t worst  = 0;
+    while (state.keepRunning()) {
+        if (!recorder.isOpen() && recorder.begin(path, 16 << 20) != HMS_CAM_OK) {
+            state.skipWithError("recorder begin failed");
+            break;
+        }
+        frame.timestampUs += 33333;
+        if (recorder.append(frame) != HMS_CAM_OK) {
+            state.skipWithError("append failed");
+            break;
+        }
+        recorder.getStats(stats);
+        if (stats.frames == 1024) {
+            recorder.end();
+            recorder.getStats(stats);
+            writes += stats.writes;
+            worst   = stats.maxWriteUs > worst ? stats.maxWriteUs : worst;
+        }
+    }
+    if (recorder.isOpen()) {
+        recorder.end();
+        recorder.getStats(stats);
+        writes += stats.writes;
+        worst   = stats.maxWriteUs > worst ? stats.maxWriteUs : worst;
+    }
+    remove(path);
+
+    state.setBytesProcessed((uint64_t)frame.length * state.iterations());
+    state.setItemsProcessed(state.iterations());
+    state.setCounter("writes_per_frame", state.iterations() ? (double)writes / state.iterations() : 0.0);
+    state.setCounter("write_max_us", (double)worst);
+    benchLabel(state);
+}
+HMS_CAM_BENCH_FRAMESIZES(BM_RecorderAppend);
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Handoff = time from the driver fetch (frame timestamp) until  │
+  │       the subscriber holds the view, measured per delivered frame.  │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+static void benchHandoff(HMS_CAM_BenchState &state, HMS_CAM_DropPolicy policy) {
+    HMS_CAM *cam = benchCamera((framesize_t)state.arg(), true);
+    HMS_CAM_Subscriber *sub = cam ? cam->subscribe(policy) : NULL;
+    if (!sub) {
+        state.skipWithError("camera setup failed");
+        return;
+    }
+
+    HMS_CAM_FrameView view;
+    if (sub->receive(view, 1000) != HMS_CAM_OK) {                                          // Warm up the pipeline
+        cam->unsubscribe(sub);
+        state.skipWithError("no frame from capture task");
+        return;
+    }
+
+    int64_t  total   = 0;
+    int64_t  worst   = 0;
+    uint64_t bytes   = 0;
+    while (state.keepRunning()) {
+        if (sub->receive(view, 1000) != HMS_CAM_OK) {
+            state.skipWithError("receive timed out");
+            break;
+        }
+        int64_t age = HMS_CAM_Micros() - view.frame().timestampUs;
+        total += age;
+        worst  = age > worst ? age : worst;
+        bytes += view.length();
+    }
+    view.release();
+
+    state.setBytesProcessed(bytes);
+    state.setItemsProcessed(state.iterations());
+    state.setCounter("handoff_mean_us", state.iterations() ? (double)total / state.iterations() : 0.0);
+    state.setCounter("handoff_max_us", (double)worst);
+    state.setCounter("dropped", sub->getDropped());
+    cam->unsubscribe(sub);
+    benchLabel(state);
+}
+
+static void BM_HandoffLatest(HMS_CAM_BenchState &state) {
+    benchHandoff(state, HMS_CAM_DROP_LATEST);
+}
+HMS_CAM_BENCH_FRAMESIZES(BM_HandoffLatest);
+
+static void BM_HandoffBlock(HMS_CAM_BenchState &state) {
+    benchHandoff(state, HMS_CAM_DROP_BLOCK);
+}
+HMS_CAM_BENCH_FRAMESIZES(BM_HandoffBlock);
+
+#ifndef _WIN32
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: MJPEG stream into a local socket pair. The slow reader pauses │
+  │       after every 16 KiB, frames the stream cannot keep up with are │
+  │       skipped while the capture task keeps its own pace.            │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+static void benchStream(HMS_CAM_BenchState &state, bool slowReader) {
+    HMS_CAM *cam = benchCamera((framesize_t)state.arg(), true);
+    int fds[2];
+    if (!cam || socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+        state.skipWithError("camera or socket setup failed");
+        return;
+    }
+
+    std::thread reader([&]() {
+        static char sink[16384];
+        while (recv(fds[1], sink, sizeof(sink), 0) > 0) {
+            if (slowReader) {
+                HMS_CAM_Delay(1);
+            }
+        }
+    });
+
+    HMS_CAM_Stream stream;
+    if (stream.begin(*cam, HMS_CAM_Stream::fdSink, (void*)(intptr_t)fds[0]) != HMS_CAM_OK) {
+        state.skipWithError("stream setup failed");
+    } else {
+        HMS_CAM_StatsTypeDef before, after;
+        cam->getStats(before);
+        while (state.keepRunning()) {
+            HMS_CAM_StatusTypeDef status;
+            while ((status = stream.pump(1000)) == HMS_CAM_BUSY) {
+                HMS_CAM_Yield();
+            }
+            if (status != HMS_CAM_OK) {
+                state.skipWithError("stream failed");
+                break;
+            }
+        }
+        cam->getStats(after);
+
+        HMS_CAM_StreamStatsTypeDef stats;
+        stream.getStats(stats);
+        state.setBytesProcessed(stats.bytesSent);
+        state.setItemsProcessed(stats.framesSent);
+        state.setCounter("captured", (double)(after.frames - before.frames));
+        state.setCounter("skipped", stats.framesSkipped);
+        state.setCounter("stalls", stats.stalls);
+    }
+    stream.end();
+
+    shutdown(fds[0], SHUT_RDWR);
+    reader.join();
+    close(fds[0]);
+    close(fds[1]);
+    benchLabel(state);
+}
+
+static void BM_StreamSocketPair(HMS_CAM_BenchState &state) {
+    benchStream(state, false);
+}
+HMS_CAM_BENCH_FRAMESIZES(BM_StreamSocketPair);
+
+static void BM_StreamSlowClient(HMS_CAM_BenchState &state) {
+    benchStream(state, true);
+}
+HMS_CAM_BENCH_FRAMESIZES(BM_StreamSlowClient);
+#endif
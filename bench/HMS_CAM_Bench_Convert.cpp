@@ -0,0 +1,100 @@
+#include "HMS_CAM_Bench.h"
+#include "HMS_CAM_Convert.h"
+
+#include <vector>
+#include <string.h>
+
+typedef HMS_CAM_StatusTypeDef (*BenchKernel)(const HMS_CAM_FrameBufferTypeDef &src, HMS_CAM_FrameBufferTypeDef &dst);
+
+static HMS_CAM_StatusTypeDef benchDownscaleGray2(const HMS_CAM_FrameBufferTypeDef &src, HMS_CAM_FrameBufferTypeDef &dst) {
+    return HMS_CAM_Convert::downscale(src, dst, 1, 2);
+}
+
+static HMS_CAM_StatusTypeDef benchDownscaleGray4(const HMS_CAM_FrameBufferTypeDef &src, HMS_CAM_FrameBufferTypeDef &dst) {
+    return HMS_CAM_Convert::downscale(src, dst, 1, 4);
+}
+
+static HMS_CAM_StatusTypeDef benchDownscaleRgb2(const HMS_CAM_FrameBufferTypeDef &src, HMS_CAM_FrameBufferTypeDef &dst) {
+    return HMS_CAM_Convert::downscale(src, dst, 3, 2);
+}
+
+static HMS_CAM_StatusTypeDef benchCropCenter(const HMS_CAM_FrameBufferTypeDef &src, HMS_CAM_FrameBufferTypeDef &dst) {
+    return HMS_CAM_Convert::crop(src, dst, 2, src.width / 4, src.height / 4, src.width / 2, src.height / 2);
+}
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Runs a kernel on a synthetic frame. Accelerated runs are      │
+  │       checked against the scalar reference before timing.           │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+static void benchKernel(HMS_CAM_BenchState &state, BenchKernel kernel, size_t inBpp, size_t outQuarterBytes,
+                        bool accelerated) {
+    size_t width  = resolution[state.arg()].width;
+    size_t height = resolution[state.arg()].height;
+
+    std::vector<uint8_t> input(width * height * inBpp);
+    uint32_t seed = 0x12345678;
+    for (uint8_t &b : input) {
+        seed = seed * 1664525u + 1013904223u;                                               // Deterministic noise
+        b    = (uint8_t)(seed >> 24);
+    }
+    std::vector<uint8_t> output(width * height * outQuarterBytes / 4 + 16);
+    std::vector<uint8_t> reference(output.size());
+
+    HMS_CAM_FrameBufferTypeDef src = {};
+    src.buf    = input.data();
+    src.length = input.size();
+    src.width  = width;
+    src.height = height;
+
+    HMS_CAM_FrameBufferTypeDef dst = {}, ref = {};
+    HMS_CAM_Convert::setAccelerated(false);
+    ref.buf = reference.data(); ref.length = reference.size();
+    HMS_CAM_StatusTypeDef status = kernel(src, ref);
+
+    HMS_CAM_Convert::setAccelerated(accelerated);
+    dst.buf = output.data(); dst.length = output.size();
+    if (status != HMS_CAM_OK || kernel(src, dst) != HMS_CAM_OK) {
+        state.skipWithError("kernel failed");
+        HMS_CAM_Convert::setAccelerated(true);
+        return;
+    }
+    if (dst.length != ref.length || memcmp(dst.buf, ref.buf, dst.length) != 0) {
+        state.skipWithError("accelerated output differs from scalar reference");
+        HMS_CAM_Convert::setAccelerated(true);
+        return;
+    }
+
+    while (state.keepRunning()) {
+        dst.buf    = output.data();
+        dst.length = output.size();
+        kernel(src, dst);
+        HMS_CAM_Bench::doNotOptimize(dst.buf[0]);
+    }
+    state.setLabel(HMS_CAM_Convert::getBackend());
+    HMS_CAM_Convert::setAccelerated(true);
+
+    state.setBytesProcessed((uint64_t)input.size() * state.iterations());
+    state.setItemsProcessed((uint64_t)width * height * state.iterations());                 // Pixels
+}
+
+// outQuarterBytes: output bytes per input pixel x 4 (downscale 2x gray = 1, RGB888 = 12)
+#define HMS_CAM_BENCH_KERNEL(name, kernel, inBpp, outQuarterBytes)                          \
+    static void BM_##name(HMS_CAM_BenchState &state) {                                      \
+        benchKernel(state, kernel, inBpp, outQuarterBytes, true);                           \
+    }                                                                                       \
+    static void BM_##name##Scalar(HMS_CAM_BenchState &state) {                              \
+        benchKernel(state, kernel, inBpp, outQuarterBytes, false);                          \
+    }                                                                                       \
+    HMS_CAM_BENCH_FRAMESIZES(BM_##name);                                                    \
+    HMS_CAM_BENCH_FRAMESIZES(BM_##name##Scalar)
+
+HMS_CAM_BENCH_KERNEL(SwapBytes,       HMS_CAM_Convert::swapBytes,       2, 8);
+HMS_CAM_BENCH_KERNEL(Rgb565ToRgb888,  HMS_CAM_Convert::rgb565ToRgb888,  2, 12);
+HMS_CAM_BENCH_KERNEL(Rgb565ToGray,    HMS_CAM_Convert::rgb565ToGray,    2, 4);
+HMS_CAM_BENCH_KERNEL(Yuv422ToGray,    HMS_CAM_Convert::yuv422ToGray,    2, 4);
+HMS_CAM_BENCH_KERNEL(DownscaleGray2x, benchDownscaleGray2,              1, 1);
+HMS_CAM_BENCH_KERNEL(DownscaleGray4x, benchDownscaleGray4,              1, 1);
+HMS_CAM_BENCH_KERNEL(DownscaleRgb2x,  benchDownscaleRgb2,               3, 3);
+HMS_CAM_BENCH_KERNEL(CropCenter,      benchCropCenter,                  2, 2);
@@ -0,0 +1,249 @@
+#include "HMS_CAM_Bench.h"
+#include "HMS_CAM_Motion.h"
+
+#include <map>
+#include <memory>
+#include <vector>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#ifdef HMS_CAM_BENCH_LIBJPEG
+    #include <stdio.h>
+    #include <jpeglib.h>
+#endif
+
+#define BENCH_MOTION_MOVING     16                                                          // Frames with the box moving
+#define BENCH_MOTION_STATIC     112                                                         // Replays of the last frame, ~88% static
+
+struct BenchSequence {
+    std::vector<std::vector<uint8_t>>   frames;
+    std::vector<size_t>                 order;                                              // Playback order into frames
+    size_t                              width;
+    size_t                              height;
+};
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Frames are copied out of the simulator once per format and    │
+  │       size. The moving box clip is followed by a long static tail,  │
+  │       most deployments see a still scene most of the time.          │
+  │       HMS_CAM_BENCH_SEQUENCE replaces the JPEG clip with a recorded │
+  │       directory or recorder AVI, played once per loop at its native │
+  │       size.                                                         │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+static const BenchSequence* benchSequence(pixformat_t format, framesize_t size) {
+    static std::map<std::pair<int, int>, BenchSequence> cache;
+    const char *recorded = format == PIXFORMAT_JPEG ? getenv("HMS_CAM_BENCH_SEQUENCE") : NULL;
+
+    std::pair<int, int> key(format, recorded ? -1 : size);
+    auto it = cache.find(key);
+    if (it != cache.end()) {
+        return &it->second;
+    }
+
+    HMS_CAM cam;
+    cam.setPixelFormat(format);
+    cam.setFrameSize(size);
+    cam.setFBCount(2);
+    cam.getSimSensor().setFrameRate(0);
+    if (recorded) {
+        size_t length = strlen(recorded);
+        bool   avi    = length > 4 && strcasecmp(recorded + length - 4, ".avi") == 0;
+        cam.getSimSensor().setSource(avi ? HMS_CAM_SIM_RECORDING : HMS_CAM_SIM_DIRECTORY);
+        cam.getSimSensor().setPath(recorded);
+    } else {
+        cam.getSimSensor().setPattern(HMS_CAM_SIM_MOVING_BOX);
+    }
+    if (cam.begin() != HMS_CAM_OK) {
+        return NULL;
+    }
+
+    BenchSequence sequence = {};
+    size_t count = recorded ? cam.getSimSensor().getFrameCount() : BENCH_MOTION_MOVING;
+    for (size_t i = 0; i < count; i++) {
+        HMS_CAM_FrameBufferTypeDef frame;
+        if (cam.captureFrame(frame) != HMS_CAM_OK) {
+            break;
+        }
+        sequence.order.push_back(sequence.frames.size());
+        sequence.frames.emplace_back(frame.buf, frame.buf + frame.length);
+        sequence.width  = frame.width;
+        sequence.height = frame.height;
+        cam.returnFrameBuffer();
+    }
+
+    if (sequence.frames.empty()) {
+        return NULL;
+    }
+    for (size_t i = 0; !recorded && i < BENCH_MOTION_STATIC; i++) {
+        sequence.order.push_back(sequence.frames.size() - 1);
+    }
+    return &(cache[key] = std::move(sequence));
+}
+
+static void benchMotion(HMS_CAM_BenchState &state, pixformat_t format, bool earlyExit) {
+    const BenchSequence *sequence = benchSequence(format, (framesize_t)state.arg());
+    if (!sequence) {
+        state.skipWithError("sequence capture failed");
+        return;
+    }
+
+    HMS_CAM_MotionConfigTypeDef config = HMS_CAM_Motion::defaultConfig();
+    config.earlyExit = earlyExit;
+    HMS_CAM_Motion motion;
+    if (motion.begin(sequence->width, sequence->height, config) != HMS_CAM_OK) {
+        state.skipWithError("detector allocation failed");
+        return;
+    }
+
+    HMS_CAM_FrameBufferTypeDef frame = {};
+    frame.width  = sequence->width;
+    frame.height = sequence->height;
+
+    HMS_CAM_MotionResultTypeDef result;
+    size_t   index  = 0;
+    uint64_t bytes  = 0;
+    uint64_t scores = 0;
+    uint64_t moving = 0;
+    while (state.keepRunning()) {
+        const std::vector<uint8_t> &data = sequence->frames[sequence->order[index]];
+        index = (index + 1) % sequence->order.size();
+
+        frame.buf    = (uint8_t*)data.data();
+        frame.length = data.size();
+        if (motion.process(frame, format, result) != HMS_CAM_OK) {
+            state.skipWithError("process failed");
+            break;
+        }
+        bytes  += data.size();
+        scores += result.score;
+        moving += result.motion;
+        HMS_CAM_Bench::doNotOptimize(result);
+    }
+
+    char label[32];
+    snprintf(label, sizeof(label), "%ux%u", (unsigned)sequence->width, (unsigned)sequence->height);
+    state.setLabel(label);
+    state.setBytesProcessed(bytes);
+    state.setItemsProcessed(state.iterations());
+    if (state.iterations()) {
+        state.setCounter("motion_ratio", (double)moving / state.iterations());
+        state.setCounter("mean_score", (double)scores / state.iterations());
+    }
+}
+
+static void BM_MotionJPEG(HMS_CAM_BenchState &state)               { benchMotion(state, PIXFORMAT_JPEG, false);      }
+static void BM_MotionJPEGEarlyExit(HMS_CAM_BenchState &state)      { benchMotion(state, PIXFORMAT_JPEG, true);       }
+static void BM_MotionGray(HMS_CAM_BenchState &state)               { benchMotion(state, PIXFORMAT_GRAYSCALE, false); }
+static void BM_MotionYUV422(HMS_CAM_BenchState &state)             { benchMotion(state, PIXFORMAT_YUV422, false);    }
+static void BM_MotionRGB565(HMS_CAM_BenchState &state)             { benchMotion(state, PIXFORMAT_RGB565, false);    }
+HMS_CAM_BENCH_FRAMESIZES(BM_MotionJPEG);
+HMS_CAM_BENCH_FRAMESIZES(BM_MotionJPEGEarlyExit);
+HMS_CAM_BENCH_FRAMESIZES(BM_MotionGray);
+HMS_CAM_BENCH_FRAMESIZES(BM_MotionYUV422);
+HMS_CAM_BENCH_FRAMESIZES(BM_MotionRGB565);
+
+static void BM_JPEGDCLuma(HMS_CAM_BenchState &state) {
+    const BenchSequence *sequence = benchSequence(PIXFORMAT_JPEG, (framesize_t)state.arg());
+    if (!sequence) {
+        state.skipWithError("sequence capture failed");
+        return;
+    }
+
+    std::vector<uint8_t> blocks(((sequence->width + 7) / 8) * ((sequence->height + 7) / 8));
+    const std::vector<uint8_t> &jpeg = sequence->frames[0];
+    std::unique_ptr<HMS_CAM_JPEGWorkspaceTypeDef> work(new HMS_CAM_JPEGWorkspaceTypeDef());
+    uint16_t blocksX, blocksY;
+    while (state.keepRunning()) {
+        if (HMS_CAM_JPEG::dcLuma(jpeg.data(), jpeg.size(), blocks.data(), blocks.size(), blocksX, blocksY, *work) != HMS_CAM_OK) {
+            state.skipWithError("dcLuma failed");
+            break;
+        }
+        HMS_CAM_Bench::doNotOptimize(blocks[0]);
+    }
+
+    state.setBytesProcessed((uint64_t)jpeg.size() * state.iterations());
+    state.setCounter("blocks", (double)blocks.size());
+}
+HMS_CAM_BENCH_FRAMESIZES(BM_JPEGDCLuma);
+
+static void benchThumbnail(HMS_CAM_BenchState &state, bool color) {
+    const BenchSequence *sequence = benchSequence(PIXFORMAT_JPEG, (framesize_t)state.arg());
+    if (!sequence) {
+        state.skipWithError("sequence capture failed");
+        return;
+    }
+
+    std::vector<uint8_t> thumbnail(((sequence->width + 7) / 8) * ((sequence->height + 7) / 8) * (color ? 3 : 1));
+    const std::vector<uint8_t> &jpeg = sequence->frames[0];
+    std::unique_ptr<HMS_CAM_JPEGWorkspaceTypeDef> work(new HMS_CAM_JPEGWorkspaceTypeDef());
+    HMS_CAM_JPEGThumbnailTypeDef thumb;
+    while (state.keepRunning()) {
+        if (HMS_CAM_JPEG::thumbnail(jpeg.data(), jpeg.size(), thumbnail.data(), thumbnail.size(), thumb, *work,
+                                    color) != HMS_CAM_OK) {
+            state.skipWithError("thumbnail failed");
+            break;
+        }
+        HMS_CAM_Bench::doNotOptimize(thumb);
+    }
+
+    state.setBytesProcessed((uint64_t)jpeg.size() * state.iterations());
+    state.setCounter("mean", thumb.mean);
+    state.setCounter("sharpness", thumb.sharpness);
+}
+
+static void BM_JPEGThumbnail(HMS_CAM_BenchState &state)            { benchThumbnail(state, false);                  }
+static void BM_JPEGThumbnailColor(HMS_CAM_BenchState &state)       { benchThumbnail(state, true);                   }
+HMS_CAM_BENCH_FRAMESIZES(BM_JPEGThumbnail);
+HMS_CAM_BENCH_FRAMESIZES(BM_JPEGThumbnailColor);
+
+#ifdef HMS_CAM_BENCH_LIBJPEG
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: libjpeg baselines for the thumbnail benchmarks. Full decodes  │
+  │       every pixel to grayscale, Scaled asks libjpeg for 1/8 scale,  │
+  │       which also stops at the DC term but still runs its full       │
+  │       decoder pipeline per block.                                   │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+static void benchLibjpeg(HMS_CAM_BenchState &state, unsigned denominator) {
+    const BenchSequence *sequence = benchSequence(PIXFORMAT_JPEG, (framesize_t)state.arg());
+    if (!sequence) {
+        state.skipWithError("sequence capture failed");
+        return;
+    }
+
+    const std::vector<uint8_t> &jpeg = sequence->frames[0];
+    std::vector<uint8_t> pixels(sequence->width * sequence->height);
+    jpeg_decompress_struct decoder;
+    jpeg_error_mgr         errors;
+    decoder.err = jpeg_std_error(&errors);
+    jpeg_create_decompress(&decoder);
+    while (state.keepRunning()) {
+        jpeg_mem_src(&decoder, (unsigned char *)jpeg.data(), (unsigned long)jpeg.size());
+        jpeg_read_header(&decoder, TRUE);
+        decoder.out_color_space = JCS_GRAYSCALE;
+        decoder.scale_num       = 1;
+        decoder.scale_denom     = denominator;
+        jpeg_start_decompress(&decoder);
+        while (decoder.output_scanline < decoder.output_height) {
+            JSAMPROW row = &pixels[(size_t)decoder.output_scanline * decoder.output_width];
+            jpeg_read_scanlines(&decoder, &row, 1);
+        }
+        jpeg_finish_decompress(&decoder);
+        HMS_CAM_Bench::doNotOptimize(pixels[0]);
+    }
+    jpeg_destroy_decompress(&decoder);
+
+    state.setBytesProcessed((uint64_t)jpeg.size() * state.iterations());
+}
+
+static void BM_JPEGFullDecode(HMS_CAM_BenchState &state)           { benchLibjpeg(state, 1);                        }
+static void BM_JPEGScaledDecode(HMS_CAM_BenchState &state)         { benchLibjpeg(state, 8);                        }
+HMS_CAM_BENCH_FRAMESIZES(BM_JPEGFullDecode);
+HMS_CAM_BENCH_FRAMESIZES(BM_JPEGScaledDecode);
+
+#endif // HMS_CAM_BENCH_LIBJPEG
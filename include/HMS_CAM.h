@@ -31,10 +31,81 @@
 #define HMS_CAM_H
 
 #include "HMS_CAM_Config.h"
+#include "HMS_CAM_Stats.h"
+
+#ifdef HMS_CAM_PLATFORM_DESKTOP
+    #include "HMS_CAM_Sim.h"
+#endif
+
+#ifdef HMS_CAM_HAS_CAMERA_API
+    #include <atomic>
+    #include <memory>
+    #include <mutex>
+    #include "HMS_CAM_Engine.h"
+    #include "HMS_CAM_Rate.h"
+    #include "HMS_CAM_Motion.h"
+    #include "HMS_CAM_Planner.h"
+    #include "HMS_CAM_Sensor.h"
+    #include "HMS_CAM_Trace.h"
+#endif
+
+class HMS_CAM;
+
+#ifdef HMS_CAM_HAS_CAMERA_API
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Move-only frame lease                                         │
+  │       Owns one driver frame buffer until destroyed or released,     │
+  │       up to fb_count leases can be in flight at the same time.      │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+class HMS_CAM_FrameLease {
+public:
+    HMS_CAM_FrameLease() = default;
+    ~HMS_CAM_FrameLease()                                   { release();              }
+
+    HMS_CAM_FrameLease(HMS_CAM_FrameLease &&other) noexcept;
+    HMS_CAM_FrameLease& operator=(HMS_CAM_FrameLease &&other) noexcept;
+
+    HMS_CAM_FrameLease(const HMS_CAM_FrameLease&)            = delete;
+    HMS_CAM_FrameLease& operator=(const HMS_CAM_FrameLease&) = delete;
+
+    void release();
+
+    bool valid() const                                      { return _fb != NULL;     }
+    explicit operator bool() const                          { return _fb != NULL;     }
+
+    camera_fb_t* get() const                                { return _fb;             }
+    const HMS_CAM_FrameBufferTypeDef& frame() const         { return _frame;          }
+
+    uint8_t* data() const                                   { return _frame.buf;      }
+    size_t length() const                                   { return _frame.length;   }
+    size_t width() const                                    { return _frame.width;    }
+    size_t height() const                                   { return _frame.height;   }
+
+private:
+    friend class HMS_CAM;
+
+    HMS_CAM                     *_owner         = NULL;                                     // Driver the buffer is returned to
+    camera_fb_t                 *_fb            = NULL;                                     // Leased driver frame buffer
+    HMS_CAM_FrameBufferTypeDef  _frame          = {};                                       // Cached frame description
+};
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: captureFrameAsync() completion                                │
+  │       Runs on the capture task, with HMS_CAM_OK and a valid lease or│
+  │       with TIMEOUT / BUSY / ERROR and an empty one. Move the lease  │
+  │       out to keep the frame after the callback returns.             │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+typedef void (*HMS_CAM_CaptureCallback)(HMS_CAM_StatusTypeDef status, HMS_CAM_FrameLease &lease, void *context);
+#endif
 
 class HMS_CAM {
 public:
     HMS_CAM();
+    explicit HMS_CAM(const char *name);                                                     // Tags this instance's logs and capture task
     ~HMS_CAM();
     
     HMS_CAM_StatusTypeDef stop();
@@ -43,10 +114,41 @@ public:
     HMS_CAM_StatusTypeDef refresh();
     HMS_CAM_StatusTypeDef captureFrame(HMS_CAM_FrameBufferTypeDef &frame);
 
-    #ifdef HMS_CAM_PLATFORM_ESP_IDF
+    #ifdef HMS_CAM_HAS_CAMERA_API
         void returnFrameBuffer();
 
+        HMS_CAM_StatusTypeDef captureFrame(HMS_CAM_FrameLease &lease);
+        HMS_CAM_StatusTypeDef captureFrame(HMS_CAM_FrameLease &lease, uint32_t timeoutMs);  // BUSY / TIMEOUT instead of blocking
+        HMS_CAM_StatusTypeDef captureFrameUntil(HMS_CAM_FrameLease &lease, int64_t deadlineUs); // Deadline on HMS_CAM_Micros()
+        HMS_CAM_StatusTypeDef tryCaptureFrame(HMS_CAM_FrameLease &lease) { return captureFrameUntil(lease, HMS_CAM_Micros()); }
+        HMS_CAM_StatusTypeDef captureFrameAsync(HMS_CAM_CaptureCallback callback, void *context, uint32_t timeoutMs);
+        size_t getLeasesInFlight() const                    { return _leases.load();  }
+
+        HMS_CAM_Subscriber* subscribe(HMS_CAM_DropPolicy policy = HMS_CAM_DROP_LATEST);
+        HMS_CAM_StatusTypeDef unsubscribe(HMS_CAM_Subscriber *subscriber);
+        bool isCaptureTaskRunning() const                   { return _taskRunning.load(); }
+
+        void setCaptureTask(bool enable)                    { _taskEnabled = enable;  }
+        void setCaptureTaskCore(int core)                   { _taskCore = core;       }
+        void setCaptureTaskPriority(int priority)           { _taskPriority = priority; }
+
         void setFrameSize(framesize_t size)                 { _frameSize = size;      }
+        void setMaxFrameSize(framesize_t size)              { _maxFrameSize = size;   }
+        void setMinFrameSize(framesize_t size)              { _minFrameSize = size;   }    // Floor for the buffer plan
+        const HMS_CAM_PlanTypeDef& getFBPlan() const        { return _plan;           }
+        void setRateControl(const HMS_CAM_RateConfigTypeDef &config, bool enable = true);
+        void getRateStats(HMS_CAM_RateStatsTypeDef &stats) const { _rate.getStats(stats); }
+        void setMotionDetector(HMS_CAM_Motion *motion, bool gate = false);
+        void setSensorProfile(const HMS_CAM_SensorProfileTypeDef *profile) { _sensorProfile = profile; } // NULL: module profile
+        void setSettleTimeout(uint32_t ms)                  { _settleTimeoutMs = ms;  }
+        void setMinFrameRate(uint8_t fps)                   { _minFrameRate = fps;    }    // Caps frame size, 0 disables
+        const HMS_CAM_SensorDriverTypeDef* getSensorDriver() const { return _sensorDriver; }
+        HMS_CAM_ModuleType getModule() const { return _sensorDriver ? _sensorDriver->module : HMS_CAM_MODULE_UNKNOWN; }
+
+        HMS_CAM_StatusTypeDef setROI(uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+                                     uint16_t outWidth = 0, uint16_t outHeight = 0);        // Array coordinates, 0 = no scaling
+        HMS_CAM_StatusTypeDef clearROI();                                                   // Back to the full frame size
+        bool getROI(HMS_CAM_SensorWindowTypeDef &roi) const { roi = _roi; return _roiActive; }
         void setPixelFormat(pixformat_t format)             { _pixelFormat = format;  }
         void setGrabMode(camera_grab_mode_t mode)           { _grabMode = mode;       }
         void setFBLocation(camera_fb_location_t location)   { _fbLocation = location; }
@@ -59,17 +161,76 @@ public:
         void setFBLocation(int location)                    { _fbLocation = location; }
     #endif
 
+    #ifdef HMS_CAM_PLATFORM_DESKTOP
+        HMS_CAM_SimSensor& getSimSensor()                   { return _sim;            }
+    #endif
+
+    const HMS_CAM_RefreshReportTypeDef& getRefreshReport() const { return _refreshReport; }
+    const HMS_CAM_BootReportTypeDef& getBootReport() const       { return _bootReport;    }
+    const char* getName() const                             { return _name;           }
+
+    void getStats(HMS_CAM_StatsTypeDef &stats) const;
+    void resetStats()                                       { _stats.reset();         }
+
     void setFBCount(int count)                              { _fbCount = count;       }
     void setJPEGQuality(int quality)                        { _jpegQuality = quality; }
     void setXCLKFrequency(int freqHz)                       { _frequencyHz = freqHz;  }
+    void setJPEGValidation(HMS_CAM_JPEGCheck level)         { _jpegCheck = level;     }
 
 private:
-    #ifdef HMS_CAM_PLATFORM_ESP_IDF
+    #ifdef HMS_CAM_HAS_CAMERA_API
         camera_fb_t             *_fb            = NULL;                                     // Frame buffer pointer ESP-IDF
         framesize_t             _frameSize      = FRAMESIZE_QQVGA;                          // Default to QQVGA ESP-IDF
         pixformat_t             _pixelFormat    = PIXFORMAT_JPEG;                           // Default to JPEG  ESP-IDF
         camera_grab_mode_t      _grabMode       = CAMERA_GRAB_WHEN_EMPTY;                   // Default grab mode ESP-IDF
         camera_fb_location_t    _fbLocation     = CAMERA_FB_IN_DRAM;                        // Default to DRAM  ESP-IDF
+        framesize_t             _maxFrameSize   = FRAMESIZE_INVALID;                        // Preallocate buffers for this size
+        framesize_t             _minFrameSize   = FRAMESIZE_INVALID;                        // Plan floor, INVALID = smallest size
+        HMS_CAM_PlanTypeDef     _plan           = {};                                       // Buffers the last init used
+
+        struct {
+            framesize_t             frameSize;
+            pixformat_t             pixelFormat;
+            int                     jpegQuality;
+            size_t                  fbCount;
+            size_t                  fbBytes;
+            camera_fb_location_t    fbLocation;
+            size_t                  fbCountWanted;                                          // Request the plan started from
+            camera_fb_location_t    fbLocationWanted;
+            camera_grab_mode_t      grabMode;
+            int                     frequencyHz;
+        }                       _active         = {};                                       // Settings the driver runs with
+
+        std::atomic<size_t>     _leases{0};                                                 // Driver buffers held (leases, views, _fb)
+
+        bool                    _taskEnabled    = false;                                    // Start the capture task from begin()
+        int                     _taskCore       = -1;                                       // Capture task core, -1 for no affinity
+        int                     _taskPriority   = HMS_CAM_TASK_PRIORITY;                    // Capture task priority
+        std::atomic<bool>       _taskRunning{false};                                        // Capture loop keeps running while set
+        std::atomic<bool>       _taskAlive{false};                                          // Capture loop has not exited yet
+        HMS_CAM_Subscriber      _subscribers[HMS_CAM_MAX_SUBSCRIBERS];                      // Subscriber slots
+        HMS_CAM_Signal          _taskWake;                                                  // Subscriber, request or free buffer
+        std::unique_ptr<HMS_CAM_SharedFrame[]> _shared;                                     // Shared frame pool (fb_count entries)
+        size_t                  _sharedCount    = 0;                                        // Entries in the shared frame pool
+        HMS_CAM_RateControl     _rate;                                                      // Quality / frame size controller
+        bool                    _rateEnabled    = false;                                    // Run _rate on every JPEG frame
+        HMS_CAM_Motion          *_motion        = NULL;                                     // Optional motion analysis stage
+        bool                    _motionGate     = false;                                    // Capture task holds back static frames
+        std::mutex              _stageLock;                                                 // Motion, rate control and live setters
+        int64_t                 _lastPublishUs  = 0;                                        // Last frame published (keep-alive)
+        const HMS_CAM_SensorProfileTypeDef *_sensorProfile = NULL;                          // Overrides the module profile
+        const HMS_CAM_SensorDriverTypeDef  *_sensorDriver  = NULL;                          // Detected from the sensor PID
+        uint8_t                 _minFrameRate   = 0;                                        // High frame rate floor, 0 = off
+        HMS_CAM_SensorWindowTypeDef _roi        = {};                                       // Sensor window, aligned by the driver
+        bool                    _roiActive      = false;                                    // Frames come from _roi
+        bool                    _roiApplied     = false;                                    // _roi written since the last init
+        uint32_t                _settleTimeoutMs = HMS_CAM_SETTLE_TIMEOUT_MS;               // Boot exposure wait, 0 to skip
+        std::atomic<bool>       _timedBusy{false};                                          // A deadline capture is running
+        std::atomic<bool>       _fetchCarried{false};                                       // Reservation held by a timed-out fetch
+        std::atomic<uint8_t>    _requestState{0};                                           // Async request: 0 idle, 1 filling, 2 queued
+        HMS_CAM_CaptureCallback _requestCallback = NULL;                                    // Async request completion
+        void                    *_requestContext = NULL;                                    // Passed back to _requestCallback
+        int64_t                 _requestDeadline = 0;                                       // Async request deadline (us)
     #elif defined(HMS_CAM_PLATFORM_ARDUINO)
         uint8_t                 *_fb            = NULL;                                     // Frame buffer pointer Arduino
         int                     _frameSize      = FRAMESIZE_QQVGA;                          // Default to QQVGA Arduino
@@ -78,15 +239,79 @@ private:
         int                     _fbLocation     = CAMERA_FB_IN_DRAM;                        // Default to DRAM Arduino
     #endif
 
+    #ifdef HMS_CAM_PLATFORM_ESP_IDF
+        TaskHandle_t            _taskHandle     = NULL;                                     // Capture task ESP-IDF
+        TaskHandle_t            _grabHandle     = NULL;                                     // fb_get helper task ESP-IDF
+        QueueHandle_t           _grabQueue      = NULL;                                     // Frames from _grabHandle ESP-IDF
+        bool                    _grabInFlight   = false;                                    // _grabHandle is inside fb_get ESP-IDF
+    #endif
+
+    #ifdef HMS_CAM_PLATFORM_DESKTOP
+        HMS_CAM_SimSensor       _sim;                                                       // Simulated sensor Desktop
+        std::thread             _taskThread;                                                // Capture thread Desktop
+    #endif
+
+    char                        _name[HMS_CAM_NAME_MAX] = "HMS_CAM";                        // Logger tag and capture task name
+    #if HMS_CAM_DEBUG_ENABLED
+        ChronoLogger            *camLogger      = nullptr;                                  // Own logger, shadows the global in HMS_CAM_LOGGER
+    #endif
+
     int                         _jpegQuality    = 20;                                       // JPEG quality (0-63), lower means better quality
     int                         _frequencyHz    = 20000000;                                 // XCLK frequency in Hz
     bool                        _initialized    = false;                                    // Initialization state
     size_t                      _fbCount        = 1;                                        // Size of the allocated buffer
+    HMS_CAM_RefreshReportTypeDef _refreshReport = {};                                       // Outcome of the last refresh()
+    HMS_CAM_BootReportTypeDef   _bootReport     = {};                                       // Phase timings of the last begin()
+    HMS_CAM_Stats               _stats;                                                     // Capture statistics
+    std::atomic<uint32_t>       _sequence{0};                                               // Next frame sequence number
+    HMS_CAM_JPEGCheck           _jpegCheck      = HMS_CAM_JPEG_EOI;                         // Validation applied to JPEG frames
 
     HMS_CAM_StatusTypeDef _initCamera();
+    HMS_CAM_StatusTypeDef _deinitCamera();
     HMS_CAM_StatusTypeDef _configureSensor();
     HMS_CAM_StatusTypeDef _refreshSettings();
     HMS_CAM_StatusTypeDef _verifyConnections();
+
+    #ifdef HMS_CAM_HAS_CAMERA_API
+        friend class HMS_CAM_FrameLease;
+        friend struct HMS_CAM_SharedFrame;
+
+        static size_t _frameBufferBytes(framesize_t size, pixformat_t format);              // Driver fb size for a mode
+        static size_t _frameBufferBytes(size_t width, size_t height, pixformat_t format);   // Same for an ROI output
+        static framesize_t _coveringFrameSize(size_t width, size_t height);                 // Smallest mode holding width x height
+        framesize_t _allocFrameSize() const;                                                // Frame size buffers are sized for
+        void _recordActiveConfig(const camera_config_t &config);                            // Remember what init applied
+        HMS_CAM_StatusTypeDef _initPlanned(camera_config_t &config);                        // Plan buffers, init along the ladder
+        bool _canRefreshLive() const;                                                       // Pending changes fit the buffers
+        HMS_CAM_StatusTypeDef _applyLiveSettings();                                         // sensor_t setters, no re-init
+        void _settleExposure();                                                             // Wait for AEC, bounded by a timeout
+        void _applySensorClock();                                                           // Driver PLL for the frame rate floor
+        framesize_t _cappedFrameSize(framesize_t size, uint32_t xclkHz) const;              // Largest size meeting _minFrameRate
+        void _applyRateControl(size_t bytes, uint32_t latencyUs, int64_t nowUs);            // Feed _rate, apply its decision
+
+        bool _reserveBuffer();                                                              // Claim one of the fb_count buffers
+        camera_fb_t* _acquireFrame(HMS_CAM_FrameBufferTypeDef &frame, int64_t deadlineUs = HMS_CAM_NO_DEADLINE,
+                                   HMS_CAM_StatusTypeDef *status = NULL, bool *pending = NULL); // Get + validate with retries
+        HMS_CAM_StatusTypeDef _captureUntil(HMS_CAM_FrameLease &lease, int64_t deadlineUs); // Reserve + acquire, bounded
+        void _serveRequest();                                                               // Complete a captureFrameAsync()
+        void _cancelFetch();                                                                // Drop a timed-out fetch + its buffer
+        void _releaseLease(camera_fb_t *fb);                                                // Return a leased buffer
+        void _releaseShared(HMS_CAM_SharedFrame *shared);                                   // Return a published buffer
+
+        HMS_CAM_StatusTypeDef _startEngine();                                               // Allocate pool + start task
+        void _stopEngine();                                                                 // Stop task + drain subscribers
+        void _captureTaskLoop();                                                            // Capture task body
+        HMS_CAM_StatusTypeDef _startCaptureTask();                                          // Platform task/thread start
+        void _stopCaptureTask();                                                            // Platform task/thread stop
+
+        camera_fb_t* _fbGet();                                                              // Platform frame getter
+        camera_fb_t* _fbGetUntil(int64_t deadlineUs, bool &pending);                        // Platform getter, NULL at the deadline
+        void _fbCancel();                                                                   // Platform, wait out a pending fetch
+        void _fbReturn(camera_fb_t *fb);                                                    // Platform frame return
+        sensor_t* _sensorGet();                                                             // Platform sensor control block
+        HMS_CAM_StatusTypeDef _driverInit(const camera_config_t &config);                   // Platform init, NO_MEM = try smaller
+        void _memoryProbe(HMS_CAM_MemoryTypeDef &memory);                                   // Platform free memory per region
+    #endif
 };
 
 #endif // HMS_CAM_H
\ No newline at end of file
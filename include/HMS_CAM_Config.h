@@ -54,16 +54,32 @@
   #include "esp_camera.h"
   #include "freertos/FreeRTOS.h"
   #include "freertos/task.h"
+  #include "freertos/queue.h"
+  #include "freertos/semphr.h"
   #define HMS_CAM_PLATFORM_ESP_IDF
 #elif defined(__ZEPHYR__)
   #define HMS_CAM_PLATFORM_ZEPHYR
 #elif defined(__STM32__)
   #define HMS_CAM_PLATFORM_STM32_HAL
 #elif defined(__linux__) || defined(_WIN32) || defined(__APPLE__)
-  // Desktop specific includes
+  #include <stdio.h>
+  #include <stdint.h>
+  #include <stddef.h>
+  #include <chrono>
+  #include <thread>
   #define HMS_CAM_PLATFORM_DESKTOP
 #endif // Platform detection
 
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: esp32-camera API availability                                 │
+  │       ESP-IDF uses the real driver, desktop uses HMS_CAM_Sim.h      │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+#if defined(HMS_CAM_PLATFORM_ESP_IDF) || defined(HMS_CAM_PLATFORM_DESKTOP)
+  #define HMS_CAM_HAS_CAMERA_API
+#endif
+
 /*
   ┌─────────────────────────────────────────────────────────────────────┐
   │ Note:     Enable only if ChronoLog is included                      │
@@ -100,7 +116,7 @@
         #else
             #define HMS_CAM_LOG_LEVEL          CHRONOLOG_LEVEL_DEBUG
         #endif
-      extern ChronoLogger *camLogger;
+      extern ChronoLogger *camLogger;                                      // Shared, HMS_CAM members shadow it
     #endif
     #define HMS_CAM_LOGGER(level, msg, ...)    \
       do {                                     \
@@ -116,6 +132,20 @@
   #define HMS_CAM_LOGGER(level, msg, ...)       do {} while (0)
 #endif
 
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Hot path tracing, see HMS_CAM_Trace.h                         │
+  │       Compiled out unless enabled, no formatting at record time     │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+#if defined(CONFIG_HMS_CAM_TRACE)
+    #define HMS_CAM_TRACE_ENABLED              1
+#elif defined(HMS_CAM_TRACE)
+    #define HMS_CAM_TRACE_ENABLED              1
+#else
+    #define HMS_CAM_TRACE_ENABLED              0                            // Record binary trace events (1=enabled, 0=disabled)
+#endif
+
 /*
   ┌─────────────────────────────────────────────────────────────────────┐
   │ Note: HMS CAM Custom Types & Definitions                            │
@@ -153,10 +183,92 @@
   #define HMS_CAM_Delay(ms) vTaskDelay(pdMS_TO_TICKS(ms))
 #elif defined(HMS_CAM_PLATFORM_ARDUINO)
   #define HMS_CAM_Delay(ms) delay(ms)
+#elif defined(HMS_CAM_PLATFORM_DESKTOP)
+  #define HMS_CAM_Delay(ms) std::this_thread::sleep_for(std::chrono::milliseconds(ms))
 #else
   #define HMS_CAM_Delay(ms)
 #endif
 
+#ifdef HMS_CAM_PLATFORM_ESP_IDF
+  #define HMS_CAM_Yield()   vTaskDelay(1)                                   // One tick, lets lower priority tasks run
+  #define HMS_CAM_Micros()  ((int64_t)esp_timer_get_time())
+#elif defined(HMS_CAM_PLATFORM_ARDUINO)
+  #define HMS_CAM_Yield()   delay(1)
+  #define HMS_CAM_Micros()  ((int64_t)micros())
+#elif defined(HMS_CAM_PLATFORM_DESKTOP)
+  #define HMS_CAM_Yield()   std::this_thread::sleep_for(std::chrono::microseconds(100))
+  #define HMS_CAM_Micros()  ((int64_t)std::chrono::duration_cast<std::chrono::microseconds>( \
+                              std::chrono::steady_clock::now().time_since_epoch()).count())
+#else
+  #define HMS_CAM_Yield()
+  #define HMS_CAM_Micros()  ((int64_t)0)
+#endif
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Capture task and subscriber limits                            │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+#ifndef HMS_CAM_NAME_MAX
+  #define HMS_CAM_NAME_MAX                      16                          // Instance name with terminator (logger tag, task name)
+#endif
+
+#ifndef HMS_CAM_MAX_SUBSCRIBERS
+  #define HMS_CAM_MAX_SUBSCRIBERS               4                           // Concurrent frame subscribers
+#endif
+
+#ifndef HMS_CAM_SUBSCRIBER_DEPTH
+  #define HMS_CAM_SUBSCRIBER_DEPTH              4                           // Queue depth of a blocking subscriber
+#endif
+
+#ifndef HMS_CAM_SIGNAL_WAIT_MS
+  #define HMS_CAM_SIGNAL_WAIT_MS                50                          // Longest engine wait before state is rechecked
+#endif
+
+#if defined(CONFIG_HMS_CAM_TASK_STACK_SIZE)
+  #define HMS_CAM_TASK_STACK_SIZE               CONFIG_HMS_CAM_TASK_STACK_SIZE
+#elif !defined(HMS_CAM_TASK_STACK_SIZE)
+  #define HMS_CAM_TASK_STACK_SIZE               4096                        // Capture task stack in bytes
+#endif
+
+#if defined(CONFIG_HMS_CAM_TASK_PRIORITY)
+  #define HMS_CAM_TASK_PRIORITY                 CONFIG_HMS_CAM_TASK_PRIORITY
+#elif !defined(HMS_CAM_TASK_PRIORITY)
+  #define HMS_CAM_TASK_PRIORITY                 5                           // Capture task priority
+#endif
+
+#ifndef HMS_CAM_CAPTURE_RETRIES
+  #define HMS_CAM_CAPTURE_RETRIES               3                           // fb_get attempts per capture
+#endif
+
+#ifndef HMS_CAM_RETRY_BACKOFF_MS
+  #define HMS_CAM_RETRY_BACKOFF_MS              5                           // Delay after a rejected frame, doubles per retry
+#endif
+
+#ifndef HMS_CAM_FB_RETRY_MS
+  #define HMS_CAM_FB_RETRY_MS                   50                          // Delay after fb_get fails, cut short by a deadline
+#endif
+
+#ifndef HMS_CAM_GRAB_STACK_SIZE
+  #define HMS_CAM_GRAB_STACK_SIZE               2048                        // fb_get helper task behind deadline captures (ESP)
+#endif
+
+#define HMS_CAM_NO_DEADLINE                     INT64_MAX                   // Capture blocks inside fb_get
+
+#if defined(CONFIG_HMS_CAM_SETTLE_TIMEOUT_MS)
+  #define HMS_CAM_SETTLE_TIMEOUT_MS             CONFIG_HMS_CAM_SETTLE_TIMEOUT_MS
+#elif !defined(HMS_CAM_SETTLE_TIMEOUT_MS)
+  #define HMS_CAM_SETTLE_TIMEOUT_MS             500                         // Upper bound on the boot exposure wait, 0 skips it
+#endif
+
+#ifndef HMS_CAM_SETTLE_TOLERANCE
+  #define HMS_CAM_SETTLE_TOLERANCE              2                           // Mean luma step still counted as settled
+#endif
+
+#ifndef HMS_CAM_SETTLE_FRAMES
+  #define HMS_CAM_SETTLE_FRAMES                 2                           // Consecutive stable frames to call AEC settled
+#endif
+
 typedef enum {
   HMS_CAM_OK                                    = 0x00,
   HMS_CAM_BUSY                                  = 0x01,
@@ -171,13 +283,50 @@ typedef enum {
   HMS_CAM_OV3660                                = 0x01,
   HMS_CAM_OV5640                                = 0x02,
   HMS_CAM_OV7670                                = 0x03,
+  HMS_CAM_MODULE_UNKNOWN                        = 0xFF,                     // PID without a sensor driver
 } HMS_CAM_ModuleType;
 
+typedef enum {
+  HMS_CAM_REFRESH_NONE                          = 0x00,                     // Nothing changed
+  HMS_CAM_REFRESH_LIVE                          = 0x01,                     // Applied through sensor setters, no re-init
+  HMS_CAM_REFRESH_REINIT                        = 0x02,                     // Driver torn down and re-initialized
+} HMS_CAM_RefreshPath;
+
+typedef struct {
+  HMS_CAM_RefreshPath path;                                                 // Path taken by the last refresh()
+  uint32_t durationUs;                                                      // Time spent in refresh() in microseconds
+} HMS_CAM_RefreshReportTypeDef;
+
+typedef struct {
+  uint32_t verifyUs;                                                        // Pin checks before driver init
+  uint32_t initUs;                                                          // Driver init, includes verifyUs
+  uint32_t configureUs;                                                     // Sensor profile writes
+  uint32_t applyUs;                                                         // Frame size, format and quality setters
+  uint32_t settleUs;                                                        // Waiting for exposure to settle
+  uint32_t engineUs;                                                        // Capture task start
+  uint32_t totalUs;                                                         // Whole begin() in microseconds
+  uint16_t sensorWritten;                                                   // Profile entries written over SCCB
+  uint16_t sensorSkipped;                                                   // Profile entries the sensor already held
+  uint8_t  initAttempts;                                                    // Driver init attempts along the buffer plan
+  uint8_t  settleFrames;                                                    // Frames consumed while settling
+  bool     settled;                                                         // Exposure settled before the timeout
+} HMS_CAM_BootReportTypeDef;
+
+typedef struct {
+  size_t dramFree;                                                          // Internal 8-bit RAM free
+  size_t dramLargest;                                                       // Largest internal block
+  size_t psramFree;                                                         // 0 without PSRAM
+  size_t psramLargest;                                                      // Largest PSRAM block
+} HMS_CAM_MemoryTypeDef;
+
 typedef struct {
   uint8_t *buf;                                                             // Pointer to the pixel data
   size_t length;                                                            // Length of the buffer in bytes
   size_t width;                                                             // Width of the buffer in pixels
   size_t height;                                                            // Height of the buffer in pixels
+  int64_t timestampUs;                                                      // Sensor timestamp (start of frame) in microseconds
+  uint32_t sequence;                                                        // Capture sequence number, increments per valid frame
+  uint16_t motion;                                                          // Motion score in permille, 0 without a detector
 } HMS_CAM_FrameBufferTypeDef;
 
 #endif // HMS_CAM_CONFIG_H
\ No newline at end of file
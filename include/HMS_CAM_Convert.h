@@ -0,0 +1,108 @@
+/*
+ ============================================================================================================================================
+ * File:        HMS_CAM_Convert.h
+ * Author:      Hamas Saeed
+ * Version:     Rev_1.0.0
+ * Date:        Jan 28 2026
+ * Brief:       This file package provides pixel-format conversion, downscale and crop kernels with SIMD and scalar paths.
+ ============================================================================================================================================
+ * License:
+ * MIT License
+ *
+ * Copyright (c) 2025 Hamas Saeed
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For any inquiries, contact Hamas Saeed at hamasaeed@gmail.com
+ ============================================================================================================================================
+ */
+
+#ifndef HMS_CAM_CONVERT_H
+#define HMS_CAM_CONVERT_H
+
+#include "HMS_CAM_Config.h"
+
+#include <atomic>
+
+#define HMS_CAM_POOL_MAX_BUFFERS                32                          // One bit per buffer in the free mask
+#define HMS_CAM_POOL_ALIGNMENT                  16                          // Buffer alignment for vector loads
+
+typedef enum {
+  HMS_CAM_SCALE_BOX                             = 0x00,                     // Average of the full factor x factor block
+  HMS_CAM_SCALE_BILINEAR                        = 0x01,                     // Sample at the block centre (2x2 neighbourhood)
+} HMS_CAM_ScaleMode;
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Conversion kernels                                            │
+  │       `dst.buf` / `dst.length` give the output buffer and capacity, │
+  │       on success they describe the written image. Shrinking         │
+  │       conversions may run in place (dst.buf == src.buf).            │
+  │       RGB565 is big endian as delivered by the sensor, RGB888 is    │
+  │       written in R, G, B order.                                     │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+class HMS_CAM_Convert {
+public:
+    static HMS_CAM_StatusTypeDef swapBytes(const HMS_CAM_FrameBufferTypeDef &src, HMS_CAM_FrameBufferTypeDef &dst);
+    static HMS_CAM_StatusTypeDef rgb565ToRgb888(const HMS_CAM_FrameBufferTypeDef &src, HMS_CAM_FrameBufferTypeDef &dst);
+    static HMS_CAM_StatusTypeDef rgb565ToGray(const HMS_CAM_FrameBufferTypeDef &src, HMS_CAM_FrameBufferTypeDef &dst);
+    static HMS_CAM_StatusTypeDef yuv422ToGray(const HMS_CAM_FrameBufferTypeDef &src, HMS_CAM_FrameBufferTypeDef &dst);
+    static HMS_CAM_StatusTypeDef downscale(const HMS_CAM_FrameBufferTypeDef &src, HMS_CAM_FrameBufferTypeDef &dst,
+                                           size_t channels, size_t factor, HMS_CAM_ScaleMode mode = HMS_CAM_SCALE_BOX);
+    static HMS_CAM_StatusTypeDef crop(const HMS_CAM_FrameBufferTypeDef &src, HMS_CAM_FrameBufferTypeDef &dst,
+                                      size_t bytesPerPixel, size_t x, size_t y, size_t width, size_t height);
+
+    static void setAccelerated(bool enable)                 { _accelerated = enable;  }
+    static bool isAccelerated()                             { return _accelerated;    }
+    static const char* getBackend();                                                        // "SSE2", "NEON", "SWAR" or "scalar"
+
+private:
+    static bool _accelerated;
+};
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Fixed pool of conversion buffers                              │
+  │       One allocation in begin(), acquire/release are lock-free.     │
+  │       On ESP-IDF buffers prefer PSRAM and fall back to DRAM.        │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+class HMS_CAM_BufferPool {
+public:
+    HMS_CAM_BufferPool() = default;
+    ~HMS_CAM_BufferPool()                                   { end();                  }
+
+    HMS_CAM_BufferPool(const HMS_CAM_BufferPool &) = delete;
+    HMS_CAM_BufferPool& operator=(const HMS_CAM_BufferPool &) = delete;
+
+    HMS_CAM_StatusTypeDef begin(size_t count, size_t bytes);
+    void end();
+
+    HMS_CAM_StatusTypeDef acquire(HMS_CAM_FrameBufferTypeDef &frame);                       // HMS_CAM_BUSY when exhausted
+    HMS_CAM_StatusTypeDef release(const HMS_CAM_FrameBufferTypeDef &frame);
+
+    size_t getCount() const                                 { return _count;          }
+    size_t getBufferSize() const                            { return _bytes;          }
+    size_t getAvailable() const;
+
+private:
+    void                        *_raw           = NULL;                                     // Allocation as returned by the allocator
+    uint8_t                     *_memory        = NULL;                                     // Aligned start of buffer 0
+    size_t                      _count          = 0;                                        // Number of buffers
+    size_t                      _bytes          = 0;                                        // Usable bytes per buffer
+    size_t                      _stride         = 0;                                        // Distance between buffers
+    std::atomic<uint32_t>       _free{0};                                                   // Bit n set = buffer n free
+};
+
+#endif // HMS_CAM_CONVERT_H
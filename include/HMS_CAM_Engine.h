@@ -0,0 +1,170 @@
+/*
+ ============================================================================================================================================
+ * File:        HMS_CAM_Engine.h
+ * Author:      Hamas Saeed
+ * Version:     Rev_1.0.0
+ * Date:        Jan 28 2026
+ * Brief:       This file package provides the background capture engine types (shared frames, views, subscribers).
+ ============================================================================================================================================
+ * License:
+ * MIT License
+ *
+ * Copyright (c) 2025 Hamas Saeed
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For any inquiries, contact Hamas Saeed at hamasaeed@gmail.com
+ ============================================================================================================================================
+ */
+
+#ifndef HMS_CAM_ENGINE_H
+#define HMS_CAM_ENGINE_H
+
+#include "HMS_CAM_Config.h"
+
+#ifdef HMS_CAM_PLATFORM_DESKTOP
+    #include <condition_variable>
+    #include <mutex>
+    #include "HMS_CAM_Sim.h"
+#endif
+
+#ifdef HMS_CAM_HAS_CAMERA_API
+
+#include <atomic>
+
+class HMS_CAM;
+
+typedef enum {
+  HMS_CAM_DROP_LATEST                           = 0x00,                     // Keep only the newest frame, undelivered ones are dropped
+  HMS_CAM_DROP_BLOCK                            = 0x01,                     // Never drop, the capture task waits for this subscriber
+} HMS_CAM_DropPolicy;
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Binary wake-up signal between the capture task and consumers  │
+  │       give() sets it, wait() blocks until it is set or the timeout  │
+  │       passes and clears it. A give with nobody waiting is kept for  │
+  │       the next wait, so waiters recheck their condition in a loop.  │
+  │       Binary semaphore on ESP-IDF, condition variable on desktop.   │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+class HMS_CAM_Signal {
+public:
+    HMS_CAM_Signal();
+    ~HMS_CAM_Signal();
+
+    HMS_CAM_Signal(const HMS_CAM_Signal&)                   = delete;
+    HMS_CAM_Signal& operator=(const HMS_CAM_Signal&)        = delete;
+
+    void give();
+    bool wait(int64_t timeoutUs);                                                           // false on timeout
+
+private:
+    #ifdef HMS_CAM_PLATFORM_ESP_IDF
+        StaticSemaphore_t       _storage;                                                   // No heap allocation
+        SemaphoreHandle_t       _handle         = NULL;
+    #else
+        std::mutex              _lock;
+        std::condition_variable _cond;
+        bool                    _set            = false;
+    #endif
+};
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Reference counted driver frame published by the capture task  │
+  │       The buffer returns to the driver when the last view is gone.  │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+struct HMS_CAM_SharedFrame {
+    HMS_CAM                     *owner          = NULL;                                     // Driver the buffer is returned to
+    camera_fb_t                 *fb             = NULL;                                     // Driver frame buffer
+    HMS_CAM_FrameBufferTypeDef  frame           = {};                                       // Cached frame description
+    std::atomic<uint32_t>       refs{0};                                                    // Live references (views + queues)
+    std::atomic<bool>           inUse{false};                                               // Pool slot claimed
+
+    void retain()                                           { refs.fetch_add(1, std::memory_order_relaxed); }
+    void release();
+};
+
+class HMS_CAM_FrameView {
+public:
+    HMS_CAM_FrameView() = default;
+    ~HMS_CAM_FrameView()                                    { release();              }
+
+    HMS_CAM_FrameView(const HMS_CAM_FrameView &other);
+    HMS_CAM_FrameView(HMS_CAM_FrameView &&other) noexcept;
+    HMS_CAM_FrameView& operator=(const HMS_CAM_FrameView &other);
+    HMS_CAM_FrameView& operator=(HMS_CAM_FrameView &&other) noexcept;
+
+    void release();
+
+    bool valid() const                                      { return _shared != NULL; }
+    explicit operator bool() const                          { return _shared != NULL; }
+
+    camera_fb_t* get() const                                { return _shared ? _shared->fb : NULL; }
+    const HMS_CAM_FrameBufferTypeDef& frame() const         { return _shared ? _shared->frame : _empty; }
+
+    const uint8_t* data() const                             { return frame().buf;     }
+    size_t length() const                                   { return frame().length;  }
+    size_t width() const                                    { return frame().width;   }
+    size_t height() const                                   { return frame().height;  }
+
+private:
+    friend class HMS_CAM_Subscriber;
+
+    HMS_CAM_SharedFrame         *_shared        = NULL;                                     // Referenced frame, NULL when empty
+    static const HMS_CAM_FrameBufferTypeDef _empty;
+};
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Frame subscriber                                              │
+  │       Single producer (capture task), single consumer. LATEST uses  │
+  │       one atomic slot, BLOCK uses a bounded lock-free ring. Both    │
+  │       sides block on a signal instead of polling.                   │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+class HMS_CAM_Subscriber {
+public:
+    HMS_CAM_StatusTypeDef receive(HMS_CAM_FrameView &view, uint32_t timeoutMs = 0);
+
+    HMS_CAM_DropPolicy getPolicy() const                    { return _policy;         }
+    uint32_t getDelivered() const                           { return _delivered.load(); }
+    uint32_t getDropped() const                             { return _dropped.load(); }
+
+private:
+    friend class HMS_CAM;
+
+    HMS_CAM_DropPolicy          _policy         = HMS_CAM_DROP_LATEST;                      // Drop policy of this subscriber
+    std::atomic<bool>           _claimed{false};                                            // Slot owned by a subscriber
+    std::atomic<bool>           _active{false};                                             // Accepting frames
+    std::atomic<bool>           _busy{false};                                               // Producer is publishing into it
+    std::atomic<HMS_CAM_SharedFrame*> _latest{NULL};                                        // LATEST: newest undelivered frame
+    HMS_CAM_SharedFrame         *_ring[HMS_CAM_SUBSCRIBER_DEPTH] = {};                      // BLOCK: queued frames
+    std::atomic<uint32_t>       _head{0};                                                   // BLOCK: producer index
+    std::atomic<uint32_t>       _tail{0};                                                   // BLOCK: consumer index
+    std::atomic<uint32_t>       _delivered{0};                                              // Frames handed to the consumer
+    std::atomic<uint32_t>       _dropped{0};                                                // Frames dropped for this subscriber
+    HMS_CAM_Signal              _ready;                                                     // Frame published or unsubscribed
+    HMS_CAM_Signal              _space;                                                     // BLOCK: consumer took a frame
+
+    bool _publish(HMS_CAM_SharedFrame *shared, const std::atomic<bool> &running);
+    HMS_CAM_SharedFrame* _take();
+    bool _reclaim();
+    void _drain();
+};
+
+#endif // HMS_CAM_HAS_CAMERA_API
+
+#endif // HMS_CAM_ENGINE_H
@@ -0,0 +1,136 @@
+/*
+ ============================================================================================================================================
+ * File:        HMS_CAM_JPEG.h
+ * Author:      Hamas Saeed
+ * Version:     Rev_1.0.0
+ * Date:        Jan 28 2026
+ * Brief:       This file package provides bounded-time JPEG frame integrity checks, trimming and header parsing.
+ ============================================================================================================================================
+ * License:
+ * MIT License
+ *
+ * Copyright (c) 2025 Hamas Saeed
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For any inquiries, contact Hamas Saeed at hamasaeed@gmail.com
+ ============================================================================================================================================
+ */
+
+#ifndef HMS_CAM_JPEG_H
+#define HMS_CAM_JPEG_H
+
+#include "HMS_CAM_Config.h"
+
+#ifndef HMS_CAM_JPEG_MIN_LENGTH
+  #define HMS_CAM_JPEG_MIN_LENGTH               100                         // Smaller frames cannot hold a valid header
+#endif
+
+#ifndef HMS_CAM_JPEG_EOI_WINDOW
+  #define HMS_CAM_JPEG_EOI_WINDOW               4096                        // Bytes scanned back from the tail for EOI
+#endif
+
+#ifndef HMS_CAM_JPEG_MAX_SEGMENTS
+  #define HMS_CAM_JPEG_MAX_SEGMENTS             32                          // Header segments walked before giving up on SOF
+#endif
+
+#ifndef HMS_CAM_JPEG_HISTOGRAM_BINS
+  #define HMS_CAM_JPEG_HISTOGRAM_BINS           64                          // Luma histogram bins in thumbnail(), power of two <= 256
+#endif
+
+typedef enum {
+  HMS_CAM_JPEG_NONE                             = 0x00,                     // No validation
+  HMS_CAM_JPEG_BASIC                            = 0x01,                     // Minimum length and SOI marker
+  HMS_CAM_JPEG_EOI                              = 0x02,                     // BASIC + EOI tail scan, trailing bytes trimmed
+  HMS_CAM_JPEG_FULL                             = 0x03,                     // EOI + SOF parsed, dimensions must match
+} HMS_CAM_JPEGCheck;
+
+typedef enum {
+  HMS_CAM_JPEG_VALID                            = 0x00,
+  HMS_CAM_JPEG_TOO_SHORT                        = 0x01,                     // Below HMS_CAM_JPEG_MIN_LENGTH
+  HMS_CAM_JPEG_NO_SOI                           = 0x02,                     // Does not start with FFD8
+  HMS_CAM_JPEG_NO_EOI                           = 0x03,                     // Truncated, no FFD9 within the tail window
+  HMS_CAM_JPEG_BAD_HEADER                       = 0x04,                     // No parsable SOF before the scan
+  HMS_CAM_JPEG_SIZE_MISMATCH                    = 0x05,                     // SOF dimensions differ from the frame
+  HMS_CAM_JPEG_RESULT_COUNT
+} HMS_CAM_JPEGResult;
+
+typedef struct {
+  size_t length;                                                            // Length up to and including EOI
+  size_t trimmed;                                                           // Trailing bytes after EOI
+  uint16_t width;                                                           // SOF width (FULL only)
+  uint16_t height;                                                          // SOF height (FULL only)
+} HMS_CAM_JPEGInfoTypeDef;
+
+typedef struct {
+  uint16_t blocksX;                                                         // Thumbnail size, one pixel per 8x8 block
+  uint16_t blocksY;
+  uint8_t  channels;                                                        // 1 = gray, 3 = R, G, B
+  uint8_t  mean;                                                            // Mean luma of the blocks
+  uint8_t  min;                                                             // Darkest block
+  uint8_t  max;                                                             // Brightest block
+  uint32_t sharpness;                                                       // Mean dequantized |AC| per luma block
+  uint32_t histogram[HMS_CAM_JPEG_HISTOGRAM_BINS];                          // Blocks per luma bin
+} HMS_CAM_JPEGThumbnailTypeDef;
+
+typedef struct {
+  uint16_t lookup[256];                                                     // 8-bit prefix: (length << 8) | symbol, 0 = slow path
+  int32_t  maxCode[18];                                                     // Largest code per length, -1 = none
+  int32_t  valOffset[17];                                                   // Symbol index minus first code per length
+  uint8_t  values[256];
+  bool     present;
+} HMS_CAM_JPEGHuffmanTypeDef;
+
+typedef struct {
+  HMS_CAM_JPEGHuffmanTypeDef dc[2];                                         // Baseline DC tables 0 and 1
+  HMS_CAM_JPEGHuffmanTypeDef ac[2];                                         // Baseline AC tables 0 and 1
+} HMS_CAM_JPEGWorkspaceTypeDef;
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: dcLuma() decodes only the DC coefficients of a baseline       │
+  │       Huffman JPEG. AC coefficients are entropy-decoded and skipped │
+  │       without dequantization or IDCT, giving the mean of every 8x8  │
+  │       luma block at 1/64 of the pixel count. Progressive and        │
+  │       arithmetic coded frames return HMS_CAM_ERROR.                 │
+  │       thumbnail() runs the same pass and also returns the luma mean,│
+  │       range and histogram of the block means. Sharpness is the mean │
+  │       dequantized |AC| per luma block, read from the magnitudes the │
+  │       skip decodes anyway; it tracks focus and motion blur but      │
+  │       scales with scene contrast, compare it across frames of one   │
+  │       scene. With color the thumbnail is R, G, B with one chroma    │
+  │       value per MCU, and out may be NULL for the statistics alone.  │
+  │       Both take a caller owned workspace for the Huffman tables     │
+  │       (about 3.6 KB): keep it in a long-lived object or on the heap,│
+  │       not on a small task stack. One workspace per decoding thread. │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+class HMS_CAM_JPEG {
+public:
+    static HMS_CAM_JPEGResult check(const uint8_t *buf, size_t len, HMS_CAM_JPEGCheck level,
+                                    HMS_CAM_JPEGInfoTypeDef &info, size_t width = 0, size_t height = 0);
+
+    static bool parseHeader(const uint8_t *buf, size_t len, uint16_t &width, uint16_t &height);
+    static size_t findEOI(const uint8_t *buf, size_t len, size_t window = HMS_CAM_JPEG_EOI_WINDOW);
+    static size_t findMarker(const uint8_t *buf, size_t len, size_t from, uint8_t marker);
+
+    static const char* resultName(HMS_CAM_JPEGResult result);
+
+    static HMS_CAM_StatusTypeDef dcLuma(const uint8_t *buf, size_t len, uint8_t *out, size_t capacity,
+                                        uint16_t &blocksX, uint16_t &blocksY, HMS_CAM_JPEGWorkspaceTypeDef &work);
+    static HMS_CAM_StatusTypeDef thumbnail(const uint8_t *buf, size_t len, uint8_t *out, size_t capacity,
+                                           HMS_CAM_JPEGThumbnailTypeDef &thumb, HMS_CAM_JPEGWorkspaceTypeDef &work,
+                                           bool color = false);
+};
+
+#endif // HMS_CAM_JPEG_H
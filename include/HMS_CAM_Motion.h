@@ -0,0 +1,135 @@
+/*
+ ============================================================================================================================================
+ * File:        HMS_CAM_Motion.h
+ * Author:      Hamas Saeed
+ * Version:     Rev_1.0.0
+ * Date:        Jan 28 2026
+ * Brief:       This file package provides a low-resolution luma background model for motion and change detection.
+ ============================================================================================================================================
+ * License:
+ * MIT License
+ *
+ * Copyright (c) 2025 Hamas Saeed
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For any inquiries, contact Hamas Saeed at hamasaeed@gmail.com
+ ============================================================================================================================================
+ */
+
+#ifndef HMS_CAM_MOTION_H
+#define HMS_CAM_MOTION_H
+
+#include "HMS_CAM_Config.h"
+#include "HMS_CAM_JPEG.h"
+
+#ifdef HMS_CAM_PLATFORM_DESKTOP
+    #include "HMS_CAM_Sim.h"
+#endif
+
+#ifdef HMS_CAM_HAS_CAMERA_API
+
+#include <atomic>
+
+typedef struct {
+  uint8_t  cellSize;                                                        // Cell edge in pixels: 8, 16 or 32
+  uint8_t  threshold;                                                       // Luma difference that marks a cell changed
+  uint16_t triggerPermille;                                                 // Changed cells that count as motion
+  uint16_t resetPermille;                                                   // Global change (lights), background is re-seeded
+  uint8_t  learnShift;                                                      // Background weight 1/2^n for static cells
+  uint8_t  learnShiftMoving;                                                // Background weight 1/2^n for changing cells
+  bool     earlyExit;                                                       // Stop scanning once the trigger is reached
+  uint32_t keepAliveMs;                                                     // Gate: pass a static frame at least this often
+} HMS_CAM_MotionConfigTypeDef;
+
+typedef struct {
+  uint16_t score;                                                           // Changed cells in permille
+  bool     motion;                                                          // score >= triggerPermille
+  bool     sceneReset;                                                      // Background was re-seeded from this frame
+  bool     partial;                                                         // Early exit, bbox covers the scanned rows only
+  uint16_t x;                                                               // Changed region in frame pixels
+  uint16_t y;
+  uint16_t width;                                                           // 0 when nothing changed
+  uint16_t height;
+  uint32_t changedCells;                                                    // Cells above the threshold
+} HMS_CAM_MotionResultTypeDef;
+
+typedef struct {
+  uint32_t frames;                                                          // Frames analyzed
+  uint32_t motionFrames;                                                    // Frames with motion
+  uint32_t gatedFrames;                                                     // Static frames held back by the capture task
+  uint32_t sceneResets;                                                     // Background re-seeds
+  uint32_t errors;                                                          // Frames that could not be analyzed
+} HMS_CAM_MotionStatsTypeDef;
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Motion detector                                               │
+  │       Frames are reduced to one mean luma value per cell: JPEG via  │
+  │       the DC coefficients, grayscale, YUV422 and RGB565 by summing. │
+  │       Cells are compared with an EWMA background (8.8 fixed point). │
+  │       Changed cells learn slower while they keep changing, cells    │
+  │       that settle (parked objects, ghosts) learn at the normal rate.│
+  │       All memory is allocated in begin(), process() never allocates.│
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+class HMS_CAM_Motion {
+public:
+    HMS_CAM_Motion() = default;
+    ~HMS_CAM_Motion()                                       { end();                  }
+
+    HMS_CAM_Motion(const HMS_CAM_Motion&)                   = delete;
+    HMS_CAM_Motion& operator=(const HMS_CAM_Motion&)        = delete;
+
+    static HMS_CAM_MotionConfigTypeDef defaultConfig();
+
+    HMS_CAM_StatusTypeDef begin(size_t maxWidth, size_t maxHeight, const HMS_CAM_MotionConfigTypeDef &config = defaultConfig());
+    void end();
+    void reset()                                            { _seeded = false;        }
+
+    HMS_CAM_StatusTypeDef process(const HMS_CAM_FrameBufferTypeDef &frame, pixformat_t format,
+                                  HMS_CAM_MotionResultTypeDef &result);
+
+    const HMS_CAM_MotionConfigTypeDef& getConfig() const    { return _config;         }
+    const uint8_t* getCells() const                         { return _cells;          }
+    size_t getCellsX() const                                { return _cellsX;         }
+    size_t getCellsY() const                                { return _cellsY;         }
+    void getStats(HMS_CAM_MotionStatsTypeDef &stats) const;
+    void recordGated()                                      { _gated.fetch_add(1, std::memory_order_relaxed); }
+
+private:
+    HMS_CAM_MotionConfigTypeDef _config         = defaultConfig();                          // Thresholds and learning rates
+    void                        *_raw           = NULL;                                     // Single allocation for all buffers
+    uint16_t                    *_background    = NULL;                                     // Background per cell, 8.8 fixed point
+    uint8_t                     *_cells         = NULL;                                     // Current frame, mean luma per cell
+    uint8_t                     *_previous      = NULL;                                     // Previous frame, tells moving from settled
+    uint8_t                     *_blocks        = NULL;                                     // JPEG DC map, one byte per 8x8 block
+    size_t                      _maxCells       = 0;                                        // Capacity of _cells / _background
+    size_t                      _maxBlocks      = 0;                                        // Capacity of _blocks
+    HMS_CAM_JPEGWorkspaceTypeDef *_jpegWork     = NULL;                                     // DC decoder tables, in _raw
+    size_t                      _cellsX         = 0;                                        // Cells per row of the last frame
+    size_t                      _cellsY         = 0;                                        // Cell rows of the last frame
+    bool                        _seeded         = false;                                    // Background holds a frame
+    std::atomic<uint32_t>       _frames{0};
+    std::atomic<uint32_t>       _motionFrames{0};
+    std::atomic<uint32_t>       _gated{0};
+    std::atomic<uint32_t>       _sceneResets{0};
+    std::atomic<uint32_t>       _errors{0};
+
+    HMS_CAM_StatusTypeDef _reduce(const HMS_CAM_FrameBufferTypeDef &frame, pixformat_t format);
+    void _seed();
+};
+
+#endif // HMS_CAM_HAS_CAMERA_API
+
+#endif // HMS_CAM_MOTION_H
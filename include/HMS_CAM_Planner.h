@@ -0,0 +1,119 @@
+/*
+ ============================================================================================================================================
+ * File:        HMS_CAM_Planner.h
+ * Author:      Hamas Saeed
+ * Version:     Rev_1.0.0
+ * Date:        Jan 28 2026
+ * Brief:       This file package provides a frame buffer planner that sizes and places buffers from the free memory.
+ ============================================================================================================================================
+ * License:
+ * MIT License
+ *
+ * Copyright (c) 2025 Hamas Saeed
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For any inquiries, contact Hamas Saeed at hamasaeed@gmail.com
+ ============================================================================================================================================
+ */
+
+
+
+#ifndef HMS_CAM_PLANNER_H
+#define HMS_CAM_PLANNER_H
+
+#include "HMS_CAM_Config.h"
+
+#ifdef HMS_CAM_PLATFORM_DESKTOP
+    #include "HMS_CAM_Sim.h"
+#endif
+
+#ifdef HMS_CAM_HAS_CAMERA_API
+
+#if defined(CONFIG_HMS_CAM_PLAN_DRAM_RESERVE)
+  #define HMS_CAM_PLAN_DRAM_RESERVE             CONFIG_HMS_CAM_PLAN_DRAM_RESERVE
+#elif !defined(HMS_CAM_PLAN_DRAM_RESERVE)
+  #define HMS_CAM_PLAN_DRAM_RESERVE             (48 * 1024)                 // Internal RAM kept free for Wi-Fi, lwIP and stacks
+#endif
+
+#ifndef HMS_CAM_PLAN_DMA_BYTES
+  #define HMS_CAM_PLAN_DMA_BYTES                (16 * 1024)                 // Driver DMA line buffers, internal whatever fb_location
+#endif
+
+#ifndef HMS_CAM_PLAN_JPEG_QUALITY_REF
+  #define HMS_CAM_PLAN_JPEG_QUALITY_REF         12                          // Quality whose worst frame just fits width * height / 5
+#endif
+
+#ifndef HMS_CAM_PLAN_MAX_ATTEMPTS
+  #define HMS_CAM_PLAN_MAX_ATTEMPTS             4                           // Driver init attempts along the ladder
+#endif
+
+#define HMS_CAM_PLAN_JPEG_HEADER                1024                        // Headers and tables in front of the scan
+
+typedef struct {
+  framesize_t frameSize;                                                    // Frame size the buffers are for
+  pixformat_t pixelFormat;
+  int jpegQuality;                                                          // 0-63, lower means better quality
+  size_t fbCount;                                                           // Buffers wanted, the plan may use fewer
+  camera_fb_location_t fbLocation;                                          // Region tried first
+  framesize_t minFrameSize;                                                 // Last ladder step, FRAMESIZE_INVALID = smallest
+} HMS_CAM_PlanRequestTypeDef;
+
+typedef struct {
+  framesize_t frameSize;                                                    // Frame size passed to the driver
+  size_t fbCount;                                                           // Buffers passed to the driver
+  camera_fb_location_t fbLocation;                                          // Region passed to the driver
+  size_t fbBytes;                                                           // Driver allocation per buffer
+  size_t worstBytes;                                                        // Largest frame expected at the quality
+  uint16_t step;                                                            // Ladder position, 0 = as requested
+  bool degraded;                                                            // Frame size, count or region differs
+} HMS_CAM_PlanTypeDef;
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Frame buffer planner                                          │
+  │       plan() walks a ladder of configurations and returns the first │
+  │       one whose buffers fit the free memory. Buffer count drops     │
+  │       first (wanted count down to 1, preferred region then the      │
+  │       other), then the frame size steps down along sizes with the   │
+  │       same aspect ratio, never below minFrameSize. More buffers come│
+  │       before the preferred region because a second buffer lets DMA  │
+  │       fill one frame while the caller holds the other.              │
+  │       A region fits when one buffer fits its largest block and all  │
+  │       of them fit its free space; DRAM also keeps                   │
+  │       HMS_CAM_PLAN_DRAM_RESERVE back, and the driver's DMA line     │
+  │       buffers are charged to DRAM in both cases. Fragmentation can  │
+  │       still make the driver fail, the caller then re-probes and     │
+  │       continues from step + 1.                                      │
+  │       worstCaseBytes() is the largest frame the planner expects. Raw│
+  │       formats are exact; JPEG assumes size scales with 1 / quality  │
+  │       and that the driver's width * height / 5 just holds a detailed│
+  │       scene at HMS_CAM_PLAN_JPEG_QUALITY_REF.                       │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+class HMS_CAM_Planner {
+public:
+    static size_t bufferBytes(size_t width, size_t height, pixformat_t format);             // What the driver allocates
+    static size_t bufferBytes(framesize_t size, pixformat_t format);
+    static size_t worstCaseBytes(framesize_t size, pixformat_t format, int jpegQuality);
+
+    static HMS_CAM_StatusTypeDef plan(const HMS_CAM_PlanRequestTypeDef &request, const HMS_CAM_MemoryTypeDef &memory,
+                                      HMS_CAM_PlanTypeDef &plan, uint16_t fromStep = 0);    // NO_MEM and a log line when nothing fits
+    static bool fits(const HMS_CAM_MemoryTypeDef &memory, camera_fb_location_t location, size_t bytes, size_t count);
+
+    static const char* regionName(camera_fb_location_t location);
+};
+
+#endif // HMS_CAM_HAS_CAMERA_API
+
+#endif // HMS_CAM_PLANNER_H
@@ -0,0 +1,132 @@
+/*
+ ============================================================================================================================================
+ * File:        HMS_CAM_PreEvent.h
+ * Author:      Hamas Saeed
+ * Version:     Rev_1.0.0
+ * Date:        Jan 28 2026
+ * Brief:       This file package provides a pre-event frame recorder on a fixed arena with an indexed sequential flush.
+ ============================================================================================================================================
+ * License:
+ * MIT License
+ *
+ * Copyright (c) 2025 Hamas Saeed
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For any inquiries, contact Hamas Saeed at hamasaeed@gmail.com
+ ============================================================================================================================================
+ */
+
+#ifndef HMS_CAM_PREEVENT_H
+#define HMS_CAM_PREEVENT_H
+
+#include "HMS_CAM_Config.h"
+
+#ifdef HMS_CAM_HAS_CAMERA_API
+
+#include <atomic>
+#include <mutex>
+#include "HMS_CAM_Engine.h"
+#include "HMS_CAM_Stream.h"
+
+#ifndef HMS_CAM_PREEVENT_STALL_MS
+  #define HMS_CAM_PREEVENT_STALL_MS             2000                        // Sink blocked this long during a flush = failed
+#endif
+
+#define HMS_CAM_PREEVENT_MAGIC                  "HMSPRE01"                  // Flushed file signature, 8 bytes
+#define HMS_CAM_PREEVENT_HEADER_SIZE            16                          // Magic, frame count, entry size
+#define HMS_CAM_PREEVENT_ENTRY_SIZE             24                          // One index entry on disk, little endian
+
+typedef struct {
+  uint32_t offset;                                                          // Arena offset (in memory) or file offset (flushed)
+  uint32_t length;                                                          // JPEG bytes
+  int64_t  timestampUs;                                                     // Frame timestamp
+  uint32_t sequence;                                                        // Frame sequence number
+  uint16_t width;
+  uint16_t height;
+} HMS_CAM_PreEventEntryTypeDef;
+
+typedef struct {
+  uint32_t frames;                                                          // Frames held now
+  uint32_t bytes;                                                           // Arena bytes held now
+  int64_t  oldestUs;                                                        // Timestamp of the oldest frame held, 0 when empty
+  int64_t  newestUs;                                                        // Timestamp of the newest frame held, 0 when empty
+  uint32_t appended;                                                        // Frames stored since begin()
+  uint32_t evicted;                                                         // Oldest frames overwritten
+  uint32_t dropped;                                                         // New frames refused (oversize or pinned by a flush)
+  uint32_t flushes;                                                         // Completed flushes
+  uint32_t flushedFrames;                                                   // Frames written by flushes
+  uint64_t flushedBytes;                                                    // Bytes written by flushes, headers included
+} HMS_CAM_PreEventStatsTypeDef;
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Pre-event recorder                                            │
+  │       Frames are copied into one arena allocated in begin() (PSRAM  │
+  │       on ESP32) and described by a ring of index entries. The arena │
+  │       is a circular log: a frame that does not fit before the end   │
+  │       starts at offset 0, and the oldest frames are evicted one     │
+  │       index entry at a time. Nothing is allocated per frame.        │
+  │       Entries carry a running ticket and live at ticket % maxFrames;│
+  │       the oldest held is ticket _ticket - _count.                   │
+  │       flush() writes the selected window as header, index and JPEG  │
+  │       data, strictly in file order. Frames being flushed are pinned:│
+  │       while they are, new frames that would overwrite them are      │
+  │       dropped instead, so append() never waits for storage.         │
+  │       One producer (pump() or append()), flush() from any task.     │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+class HMS_CAM_PreEvent {
+public:
+    HMS_CAM_PreEvent() = default;
+    ~HMS_CAM_PreEvent()                                     { end();                  }
+
+    HMS_CAM_PreEvent(const HMS_CAM_PreEvent&)               = delete;
+    HMS_CAM_PreEvent& operator=(const HMS_CAM_PreEvent&)    = delete;
+
+    HMS_CAM_StatusTypeDef begin(HMS_CAM &camera, size_t arenaBytes, size_t maxFrames);
+    HMS_CAM_StatusTypeDef begin(size_t arenaBytes, size_t maxFrames);                       // append() only, no subscriber
+    void end();
+    void clear();
+
+    HMS_CAM_StatusTypeDef pump(uint32_t timeoutMs = 0);                                     // OK stored, TIMEOUT no frame, BUSY dropped
+    HMS_CAM_StatusTypeDef append(const HMS_CAM_FrameBufferTypeDef &frame);                  // Copies the frame, caller keeps the buffer
+
+    HMS_CAM_StatusTypeDef flush(HMS_CAM_StreamSink sink, void *context, int64_t fromUs = 0, int64_t toUs = INT64_MAX);
+    HMS_CAM_StatusTypeDef flush(const char *path, int64_t fromUs = 0, int64_t toUs = INT64_MAX);
+
+    void getStats(HMS_CAM_PreEventStatsTypeDef &stats) const;
+
+private:
+    HMS_CAM                     *_camera        = NULL;                                     // Source for pump()
+    HMS_CAM_Subscriber          *_subscriber    = NULL;                                     // LATEST subscriber of the capture task
+    uint8_t                     *_arena         = NULL;                                     // Circular frame log
+    size_t                      _arenaBytes     = 0;                                        // Arena capacity
+    HMS_CAM_PreEventEntryTypeDef *_index        = NULL;                                     // Ring of entries, ticket % _slots
+    size_t                      _slots          = 0;                                        // Index capacity
+    size_t                      _count          = 0;                                        // Entries held
+    uint64_t                    _tailPos        = 0;                                        // Log position of the oldest frame
+    uint64_t                    _headPos        = 0;                                        // Log position after the newest frame
+    uint64_t                    _ticket         = 0;                                        // Entries ever appended, oldest = _ticket - _count
+    std::atomic<uint64_t>       _pin{UINT64_MAX};                                           // Oldest ticket a flush still reads
+    std::atomic<bool>           _flushing{false};                                           // One flush at a time
+    mutable std::mutex          _lock;                                                      // Guards the ring bookkeeping
+    HMS_CAM_PreEventStatsTypeDef _stats         = {};                                       // Counters, guarded by _lock
+
+    bool _evictOldest();
+    HMS_CAM_StatusTypeDef _write(HMS_CAM_StreamSink sink, void *context, const uint8_t *data, size_t length);
+};
+
+#endif // HMS_CAM_HAS_CAMERA_API
+
+#endif // HMS_CAM_PREEVENT_H
@@ -0,0 +1,136 @@
+/*
+ ============================================================================================================================================
+ * File:        HMS_CAM_Rate.h
+ * Author:      Hamas Saeed
+ * Version:     Rev_1.0.0
+ * Date:        Jan 28 2026
+ * Brief:       This file package provides a closed-loop JPEG quality and frame size controller for a bitrate or frame budget.
+ ============================================================================================================================================
+ * License:
+ * MIT License
+ *
+ * Copyright (c) 2025 Hamas Saeed
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For any inquiries, contact Hamas Saeed at hamasaeed@gmail.com
+ ============================================================================================================================================
+ */
+
+#ifndef HMS_CAM_RATE_H
+#define HMS_CAM_RATE_H
+
+#include "HMS_CAM_Config.h"
+
+#ifdef HMS_CAM_PLATFORM_DESKTOP
+    #include "HMS_CAM_Sim.h"
+#endif
+
+#ifdef HMS_CAM_HAS_CAMERA_API
+
+#include <atomic>
+
+#define HMS_CAM_RATE_LADDER_MAX                 FRAMESIZE_INVALID           // Frame sizes the controller can step through
+
+typedef enum {
+  HMS_CAM_RATE_HOLD                             = 0x00,                     // Inside the hysteresis band or waiting
+  HMS_CAM_RATE_QUALITY_DOWN                     = 0x01,                     // Raised the quality value (smaller frames)
+  HMS_CAM_RATE_QUALITY_UP                       = 0x02,                     // Lowered the quality value (better image)
+  HMS_CAM_RATE_SIZE_DOWN                        = 0x03,                     // Stepped to a smaller frame size
+  HMS_CAM_RATE_SIZE_UP                          = 0x04,                     // Stepped back to a larger frame size
+} HMS_CAM_RateDecision;
+
+typedef struct {
+  uint32_t targetBytesPerSecond;                                            // Bitrate budget, 0 = unused
+  uint32_t targetBytesPerFrame;                                             // Frame budget, 0 = unused
+  uint32_t maxLatencyUs;                                                    // Smoothed capture latency limit, 0 = unused
+  int      qualityBest;                                                     // Lowest quality value the controller uses
+  int      qualityWorst;                                                    // Highest quality value before resizing
+  int      qualityStep;                                                     // Quality change per decision
+  uint8_t  hysteresisPercent;                                               // Dead band around the target
+  uint16_t holdFrames;                                                      // Frames to wait after a change
+  bool     allowResize;                                                     // Step frame size when quality is exhausted
+  framesize_t minFrameSize;                                                 // Smallest frame size when resizing
+} HMS_CAM_RateConfigTypeDef;
+
+typedef struct {
+  int         quality;                                                      // Quality the controller runs with
+  framesize_t frameSize;                                                    // Frame size the controller runs with
+  uint32_t    bytesPerFrame;                                                // Smoothed frame length
+  uint32_t    bytesPerSecond;                                               // Smoothed payload rate
+  uint32_t    latencyUs;                                                    // Smoothed capture latency
+  uint32_t    load;                                                         // Measured / target in percent
+  uint32_t    qualityChanges;                                               // Quality decisions since enable
+  uint32_t    sizeChanges;                                                  // Frame size decisions since enable
+  uint32_t    overflowGuards;                                               // Frames close to the buffer size
+  HMS_CAM_RateDecision lastDecision;                                        // Most recent decision
+} HMS_CAM_RateStatsTypeDef;
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Rate controller                                               │
+  │       Fed once per captured frame by the capturing task. Smoothed   │
+  │       load above 1 + hysteresis raises the quality value, below     │
+  │       1 - hysteresis lowers it. When quality is exhausted the frame │
+  │       size steps along sizes with the aspect ratio of the ceiling   │
+  │       that fit the allocated buffers, only when allowResize is set. │
+  │       A frame within 1/8 of the buffer size forces a step at once.  │
+  │       Statistics are atomics, readable from any task.               │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+class HMS_CAM_RateControl {
+public:
+    static HMS_CAM_RateConfigTypeDef defaultConfig();
+
+    void configure(const HMS_CAM_RateConfigTypeDef &config);
+    void reset(int quality, framesize_t frameSize, framesize_t ceiling, size_t bufferBytes);
+
+    HMS_CAM_RateDecision update(size_t bytes, uint32_t latencyUs, int64_t nowUs);
+
+    int getQuality() const                                  { return _quality;        }
+    framesize_t getFrameSize() const                        { return _ladder[_level]; }
+    void getStats(HMS_CAM_RateStatsTypeDef &stats) const;
+
+private:
+    HMS_CAM_RateConfigTypeDef   _config         = defaultConfig();                          // Targets and limits
+    framesize_t                 _ladder[HMS_CAM_RATE_LADDER_MAX] = {};                      // Usable sizes, smallest first
+    size_t                      _ladderCount    = 0;                                        // Entries in _ladder
+    size_t                      _level          = 0;                                        // Current _ladder index
+    int                         _quality        = 0;                                        // Current quality value
+    size_t                      _bufferBytes    = 0;                                        // Driver buffer size, 0 = unknown
+    uint32_t                    _bytes          = 0;                                        // EWMA frame length
+    uint32_t                    _intervalUs     = 0;                                        // EWMA frame interval
+    uint32_t                    _latencyUs      = 0;                                        // EWMA capture latency
+    int64_t                     _lastUs         = 0;                                        // Time of the previous frame
+    uint32_t                    _hold           = 0;                                        // Frames left before the next change
+
+    std::atomic<int>            _statQuality{0};
+    std::atomic<int>            _statFrameSize{0};
+    std::atomic<uint32_t>       _statBytesPerFrame{0};
+    std::atomic<uint32_t>       _statBytesPerSecond{0};
+    std::atomic<uint32_t>       _statLatencyUs{0};
+    std::atomic<uint32_t>       _statLoad{0};
+    std::atomic<uint32_t>       _statQualityChanges{0};
+    std::atomic<uint32_t>       _statSizeChanges{0};
+    std::atomic<uint32_t>       _statOverflowGuards{0};
+    std::atomic<int>            _statDecision{HMS_CAM_RATE_HOLD};
+
+    uint32_t _load() const;
+    HMS_CAM_RateDecision _worsen(bool urgent);
+    HMS_CAM_RateDecision _improve(uint32_t load);
+    void _publish(HMS_CAM_RateDecision decision);
+};
+
+#endif // HMS_CAM_HAS_CAMERA_API
+
+#endif // HMS_CAM_RATE_H
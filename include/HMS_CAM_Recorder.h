@@ -0,0 +1,137 @@
+/*
+ ============================================================================================================================================
+ * File:        HMS_CAM_Recorder.h
+ * Author:      Hamas Saeed
+ * Version:     Rev_1.0.0
+ * Date:        Jan 28 2026
+ * Brief:       This file package provides an append-only indexed MJPEG/AVI recorder for SD card storage.
+ ============================================================================================================================================
+ * License:
+ * MIT License
+ *
+ * Copyright (c) 2025 Hamas Saeed
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For any inquiries, contact Hamas Saeed at hamasaeed@gmail.com
+ ============================================================================================================================================
+ */
+
+
+#ifndef HMS_CAM_RECORDER_H
+#define HMS_CAM_RECORDER_H
+
+#include "HMS_CAM_Config.h"
+
+#ifdef HMS_CAM_HAS_CAMERA_API
+
+#ifndef HMS_CAM_RECORDER_BUFFER
+  #define HMS_CAM_RECORDER_BUFFER               32768                       // Staging buffer, one write per fill (multiple of 512)
+#endif
+
+#ifndef HMS_CAM_RECORDER_MAX_BYTES
+  #define HMS_CAM_RECORDER_MAX_BYTES            0x7FFFFFFFu                 // AVI 1.0 limit most players accept, rotate files above
+#endif
+
+#define HMS_CAM_RECORDER_SECTOR                 512                         // Write alignment on the card
+#define HMS_CAM_RECORDER_HEADER_SIZE            2048                        // RIFF/AVI headers + JUNK, movi data starts here
+#define HMS_CAM_RECORDER_ENTRY_SIZE             16                          // One idx1 entry, also the sidecar record
+#define HMS_CAM_RECORDER_INDEX_SUFFIX           ".idx"                      // Sidecar index written while recording
+
+typedef struct {
+  uint32_t frames;                                                          // Frames appended
+  uint64_t bytes;                                                           // File bytes written, padding and index included
+  uint32_t writes;                                                          // write() calls on the data file
+  uint32_t syncs;                                                           // sync() calls, each pads to a sector
+  uint32_t maxWriteUs;                                                      // Slowest single write
+  uint32_t maxFrame;                                                        // Largest frame appended
+} HMS_CAM_RecorderStatsTypeDef;
+
+typedef struct {
+  const uint8_t *base;                                                      // Whole file, usually memory mapped
+  size_t   length;                                                          // File length
+  size_t   movi;                                                            // File offset of the 'movi' fourcc
+  size_t   index;                                                           // File offset of the first idx1 entry
+  uint32_t frames;                                                          // idx1 entries
+  uint16_t width;
+  uint16_t height;
+  uint32_t usPerFrame;                                                      // Average frame interval from the header
+} HMS_CAM_RecordingTypeDef;
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Indexed MJPEG/AVI recorder                                    │
+  │       Frames are packed as '00dc' chunks into a staging buffer and  │
+  │       written one full buffer at a time, so every write after the   │
+  │       header starts on a sector boundary. The file can be           │
+  │       preallocated in begin(), which lets FAT allocate the cluster  │
+  │       chain once instead of on every write; end() cuts it back to   │
+  │       its real length.                                              │
+  │       The index goes to a sidecar file (path + ".idx") in 512-byte  │
+  │       batches while recording. end() copies it into a trailing idx1 │
+  │       chunk and patches the headers into a standard AVI. After a    │
+  │       power loss the data and the sidecar are both intact.          │
+  │       sync() pads the buffer with a JUNK chunk to the next sector   │
+  │       before writing it out, later writes stay aligned.             │
+  │       open() and frameAt() read a finished file in place: frame n is│
+  │       found through idx1 entry n without scanning the data.         │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+class HMS_CAM_Recorder {
+public:
+    HMS_CAM_Recorder() = default;
+    ~HMS_CAM_Recorder()                                     { end();                  }
+
+    HMS_CAM_Recorder(const HMS_CAM_Recorder&)               = delete;
+    HMS_CAM_Recorder& operator=(const HMS_CAM_Recorder&)    = delete;
+
+    HMS_CAM_StatusTypeDef begin(const char *path, uint64_t preallocateBytes = 0, size_t bufferBytes = HMS_CAM_RECORDER_BUFFER);
+    HMS_CAM_StatusTypeDef append(const HMS_CAM_FrameBufferTypeDef &frame);                  // JPEG only, NO_MEM when the file is full
+    HMS_CAM_StatusTypeDef sync();                                                           // Data + index on the card now
+    HMS_CAM_StatusTypeDef end();                                                            // idx1, headers, truncate, close
+
+    bool isOpen() const                                     { return _fd >= 0;        }
+    void getStats(HMS_CAM_RecorderStatsTypeDef &stats) const { stats = _stats;        }
+
+    static HMS_CAM_StatusTypeDef open(const uint8_t *data, size_t length, HMS_CAM_RecordingTypeDef &recording);
+    static HMS_CAM_StatusTypeDef frameAt(const HMS_CAM_RecordingTypeDef &recording, uint32_t index,
+                                         const uint8_t *&data, size_t &length);             // O(1) through idx1
+
+private:
+    int                         _fd             = -1;                                       // Data file
+    int                         _indexFd        = -1;                                       // Sidecar index
+    char                        *_indexPath     = NULL;                                     // Sidecar path, removed by end()
+    uint8_t                     *_buffer        = NULL;                                     // Data staging buffer
+    size_t                      _bufferBytes    = 0;                                        // Staging capacity
+    size_t                      _used           = 0;                                        // Bytes staged
+    uint8_t                     _index[HMS_CAM_RECORDER_SECTOR];                            // Index staging, 32 entries
+    size_t                      _indexUsed      = 0;                                        // Index bytes staged
+    uint64_t                    _position       = 0;                                        // File offset of _buffer[0]
+    uint64_t                    _preallocated   = 0;                                        // Bytes reserved by begin()
+    uint16_t                    _width          = 0;                                        // From the first frame
+    uint16_t                    _height         = 0;
+    int64_t                     _firstUs        = 0;                                        // Timestamp of the first frame
+    int64_t                     _lastUs         = 0;                                        // Timestamp of the newest frame
+    HMS_CAM_RecorderStatsTypeDef _stats         = {};                                       // Counters since begin()
+
+    HMS_CAM_StatusTypeDef _stage(const uint8_t *data, size_t length);                       // Copy into _buffer, write when full
+    HMS_CAM_StatusTypeDef _writeBuffer();                                                   // Write the staged bytes
+    HMS_CAM_StatusTypeDef _writeIndex();                                                    // Write the staged index entries
+    HMS_CAM_StatusTypeDef _finishIndex();                                                   // Sidecar -> idx1
+    HMS_CAM_StatusTypeDef _writeHeader(uint64_t fileLength, uint64_t moviBytes);            // RIFF/AVI headers
+    void _close();
+};
+
+#endif // HMS_CAM_HAS_CAMERA_API
+
+#endif // HMS_CAM_RECORDER_H
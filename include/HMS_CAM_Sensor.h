@@ -0,0 +1,203 @@
+/*
+ ============================================================================================================================================
+ * File:        HMS_CAM_Sensor.h
+ * Author:      Hamas Saeed
+ * Version:     Rev_1.0.0
+ * Date:        Jan 28 2026
+ * Brief:       This file package provides table-driven sensor settings that skip writes the sensor already holds.
+ ============================================================================================================================================
+ * License:
+ * MIT License
+ *
+ * Copyright (c) 2025 Hamas Saeed
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For any inquiries, contact Hamas Saeed at hamasaeed@gmail.com
+ ============================================================================================================================================
+ */
+
+#ifndef HMS_CAM_SENSOR_H
+#define HMS_CAM_SENSOR_H
+
+#include "HMS_CAM_Config.h"
+
+#ifdef HMS_CAM_PLATFORM_DESKTOP
+    #include "HMS_CAM_Sim.h"
+#endif
+
+#ifdef HMS_CAM_HAS_CAMERA_API
+
+typedef enum {
+  HMS_CAM_SENSOR_BRIGHTNESS                     = 0x00,                     // -2 to 2
+  HMS_CAM_SENSOR_CONTRAST                       = 0x01,                     // -2 to 2
+  HMS_CAM_SENSOR_SATURATION                     = 0x02,                     // -2 to 2
+  HMS_CAM_SENSOR_SHARPNESS                      = 0x03,                     // -2 to 2
+  HMS_CAM_SENSOR_DENOISE                        = 0x04,
+  HMS_CAM_SENSOR_SPECIAL_EFFECT                 = 0x05,                     // 0 = no effect
+  HMS_CAM_SENSOR_WHITEBAL                       = 0x06,                     // AWB on/off
+  HMS_CAM_SENSOR_AWB_GAIN                       = 0x07,
+  HMS_CAM_SENSOR_WB_MODE                        = 0x08,                     // 0 = auto
+  HMS_CAM_SENSOR_EXPOSURE_CTRL                  = 0x09,                     // AEC on/off
+  HMS_CAM_SENSOR_AEC2                           = 0x0A,                     // DSP night mode AEC
+  HMS_CAM_SENSOR_AE_LEVEL                       = 0x0B,                     // -2 to 2
+  HMS_CAM_SENSOR_AEC_VALUE                      = 0x0C,                     // Manual exposure, 0 to 1200
+  HMS_CAM_SENSOR_GAIN_CTRL                      = 0x0D,                     // AGC on/off
+  HMS_CAM_SENSOR_AGC_GAIN                       = 0x0E,                     // Manual gain, 0 to 30
+  HMS_CAM_SENSOR_GAINCEILING                    = 0x0F,                     // gainceiling_t
+  HMS_CAM_SENSOR_BPC                            = 0x10,                     // Black pixel correction
+  HMS_CAM_SENSOR_WPC                            = 0x11,                     // White pixel correction
+  HMS_CAM_SENSOR_RAW_GMA                        = 0x12,                     // Gamma
+  HMS_CAM_SENSOR_LENC                           = 0x13,                     // Lens correction
+  HMS_CAM_SENSOR_HMIRROR                        = 0x14,
+  HMS_CAM_SENSOR_VFLIP                          = 0x15,
+  HMS_CAM_SENSOR_DCW                            = 0x16,                     // Downsize
+  HMS_CAM_SENSOR_COLORBAR                       = 0x17,                     // Test pattern
+  HMS_CAM_SENSOR_SETTING_COUNT
+} HMS_CAM_SensorSetting;
+
+typedef struct {
+  uint8_t setting;                                                          // HMS_CAM_SensorSetting
+  int16_t value;
+} HMS_CAM_SensorEntryTypeDef;
+
+typedef struct {
+  const char *name;                                                         // For logs
+  const HMS_CAM_SensorEntryTypeDef *entries;                                // Applied in order
+  uint8_t count;
+} HMS_CAM_SensorProfileTypeDef;
+
+typedef struct {
+  uint16_t written;                                                         // Setter calls issued (one SCCB transaction or more each)
+  uint16_t skipped;                                                         // Already at the requested value
+  uint16_t unsupported;                                                     // Setter missing on this sensor
+  uint16_t failed;                                                          // Setter returned an error
+  uint32_t durationUs;                                                      // Time spent applying the profile
+} HMS_CAM_SensorApplyTypeDef;
+
+#ifndef HMS_CAM_SENSOR_MAX_DRIVERS
+  #define HMS_CAM_SENSOR_MAX_DRIVERS            4                           // Drivers added with registerDriver()
+#endif
+
+typedef struct {
+  framesize_t maxFrameSize;                                                 // Largest output read from this mode
+  uint8_t fps;                                                              // Frame rate at the driver reference XCLK
+  bool windowed;                                                            // Subsampled or binned readout
+  int rawMode;                                                              // Driver mode enum for HMS_CAM_SENSOR_WINDOW_MODE
+} HMS_CAM_SensorModeTypeDef;
+
+typedef struct {
+  uint32_t xclkHz;                                                          // Lowest XCLK this entry applies to
+  uint8_t bypass;                                                           // set_pll() arguments in sensor_t order
+  uint8_t mul;
+  uint8_t sys;
+  uint8_t root;
+  uint8_t pre;
+  uint8_t seld5;
+  uint8_t pclken;
+  uint8_t pclk;
+} HMS_CAM_SensorClockTypeDef;
+
+typedef enum {
+  HMS_CAM_SENSOR_WINDOW_NONE                    = 0x00,                     // No raw windowing
+  HMS_CAM_SENSOR_WINDOW_MODE                    = 0x01,                     // startX is a mode rawMode, offsets in mode pixels
+  HMS_CAM_SENSOR_WINDOW_ARRAY                   = 0x02,                     // Window registers on array coordinates
+} HMS_CAM_SensorWindowing;
+
+typedef struct {
+  uint16_t marginX;                                                         // endX - startX beyond the window width
+  uint16_t marginY;                                                         // endY - startY beyond the window height
+  uint16_t offsetX;                                                         // ISP offset into the window
+  uint16_t offsetY;
+  uint16_t hts;                                                             // Line length in pixel clocks
+  uint16_t vblank;                                                          // VTS lines beyond endY - startY
+} HMS_CAM_SensorWindowRegsTypeDef;
+
+typedef struct {
+  uint16_t x;                                                               // Left edge on the sensor array
+  uint16_t y;                                                               // Top edge on the sensor array
+  uint16_t width;                                                           // Window read from the array
+  uint16_t height;
+  uint16_t outWidth;                                                        // Scaled output, at most the window size
+  uint16_t outHeight;
+} HMS_CAM_SensorWindowTypeDef;
+
+typedef struct {
+  HMS_CAM_ModuleType module;
+  uint16_t pid;                                                             // sensor->id.PID
+  const char *name;                                                         // For logs
+  uint32_t refXclkHz;                                                       // XCLK the mode frame rates are quoted at
+  uint32_t maxXclkHz;                                                       // Highest XCLK the module accepts
+  bool jpeg;                                                                // On-chip JPEG encoder
+  uint8_t jpegQualityMin;                                                   // Lower values overflow the encoder output
+  const HMS_CAM_SensorModeTypeDef *modes;                                   // Readout modes, smallest first
+  uint8_t modeCount;
+  const HMS_CAM_SensorClockTypeDef *clocks;                                 // High frame rate PLL, highest XCLK first
+  uint8_t clockCount;
+  const HMS_CAM_SensorProfileTypeDef *profile;                              // Replaces defaultProfile()
+  const HMS_CAM_SensorProfileTypeDef *highFps;                              // Applied on top for a frame rate floor
+  HMS_CAM_SensorWindowing windowing;                                        // How set_res_raw() arguments are read
+  HMS_CAM_SensorWindowRegsTypeDef windowRegs;                               // For HMS_CAM_SENSOR_WINDOW_ARRAY
+} HMS_CAM_SensorDriverTypeDef;
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Sensor profiles                                               │
+  │       A profile is a constant table of (setting, value) pairs.      │
+  │       apply() compares every entry with the value the driver cached │
+  │       in sensor->status after its own init and only calls the       │
+  │       setters that change something, so a sensor fresh out of reset │
+  │       costs one SCCB transaction per deviation from the driver      │
+  │       defaults. Pass force = true when the cached status cannot be  │
+  │       trusted.                                                      │
+  │                                                                     │
+  │       Sensor drivers are found by PID. A driver carries the tuned   │
+  │       profile of its module, the readout modes with their nominal   │
+  │       frame rates and the PLL settings for high frame rates.        │
+  │       Drivers added with registerDriver() take precedence over the  │
+  │       built-in OV2640, OV3660, OV5640 and OV7670 tables.            │
+  │                                                                     │
+  │       setWindow() reads an ROI from the array through set_res_raw() │
+  │       and scales it to the output size in the sensor ISP. The window│
+  │       is aligned to 4 pixels and the output to 16x8 JPEG MCUs.      │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+class HMS_CAM_Sensor {
+public:
+    static const HMS_CAM_SensorProfileTypeDef& defaultProfile();
+
+    static HMS_CAM_StatusTypeDef apply(sensor_t *sensor, const HMS_CAM_SensorProfileTypeDef &profile, bool force,
+                                       HMS_CAM_SensorApplyTypeDef &report);
+
+    static bool isSupported(const sensor_t *sensor, HMS_CAM_SensorSetting setting);
+    static int read(const sensor_t *sensor, HMS_CAM_SensorSetting setting);                 // Cached value, no SCCB traffic
+    static int write(sensor_t *sensor, HMS_CAM_SensorSetting setting, int value);           // 0 on success, like the setters
+
+    static const char* settingName(HMS_CAM_SensorSetting setting);
+
+    static HMS_CAM_StatusTypeDef registerDriver(const HMS_CAM_SensorDriverTypeDef *driver);
+    static const HMS_CAM_SensorDriverTypeDef* findDriver(uint16_t pid);
+    static const HMS_CAM_SensorDriverTypeDef* findDriver(HMS_CAM_ModuleType module);
+    static const HMS_CAM_SensorDriverTypeDef* detect(const sensor_t *sensor);               // NULL for unknown sensors
+
+    static const HMS_CAM_SensorModeTypeDef& modeFor(const HMS_CAM_SensorDriverTypeDef &driver, framesize_t size);
+    static uint32_t frameTimeUs(const HMS_CAM_SensorDriverTypeDef &driver, framesize_t size, uint32_t xclkHz);
+    static framesize_t maxFrameSizeFor(const HMS_CAM_SensorDriverTypeDef &driver, uint8_t fps, uint32_t xclkHz);
+    static HMS_CAM_StatusTypeDef applyClock(sensor_t *sensor, const HMS_CAM_SensorDriverTypeDef &driver, uint32_t xclkHz);
+    static HMS_CAM_StatusTypeDef setWindow(sensor_t *sensor, const HMS_CAM_SensorDriverTypeDef &driver,
+                                           HMS_CAM_SensorWindowTypeDef &window);                // Aligns window in place
+};
+
+#endif // HMS_CAM_HAS_CAMERA_API
+
+#endif // HMS_CAM_SENSOR_H
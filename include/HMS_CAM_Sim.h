@@ -0,0 +1,405 @@
+/*
+ ============================================================================================================================================
+ * File:        HMS_CAM_Sim.h
+ * Author:      Hamas Saeed
+ * Version:     Rev_1.0.0
+ * Date:        Jan 28 2026
+ * Brief:       This file package provides a simulated camera sensor for desktop (host) builds.
+ ============================================================================================================================================
+ * License:
+ * MIT License
+ *
+ * Copyright (c) 2025 Hamas Saeed
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For any inquiries, contact Hamas Saeed at hamasaeed@gmail.com
+ ============================================================================================================================================
+ */
+
+#ifndef HMS_CAM_SIM_H
+#define HMS_CAM_SIM_H
+
+#include "HMS_CAM_Config.h"
+
+#ifdef HMS_CAM_PLATFORM_DESKTOP
+
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+#include <chrono>
+
+#if defined(_WIN32)
+  #include <winsock2.h>                                                     // struct timeval
+#else
+  #include <sys/time.h>
+#endif
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: esp32-camera compatible types for host builds                 │
+  │       Layout and naming follow esp32-camera (sensor.h, esp_camera.h)│
+  │       so the platform independent driver code compiles unchanged.   │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+
+#define OV2640_PID                              0x26
+#define OV3660_PID                              0x3660
+#define OV5640_PID                              0x5640
+#define OV7670_PID                              0x76
+
+typedef enum {
+  PIXFORMAT_RGB565,                                                         // 2BPP/RGB565 (big endian, as delivered by the DVP)
+  PIXFORMAT_YUV422,                                                         // 2BPP/YUV422 (Y0 U Y1 V)
+  PIXFORMAT_YUV420,                                                         // 1.5BPP/YUV420
+  PIXFORMAT_GRAYSCALE,                                                      // 1BPP/GRAYSCALE
+  PIXFORMAT_JPEG,                                                           // JPEG/COMPRESSED
+  PIXFORMAT_RGB888,                                                         // 3BPP/RGB888
+  PIXFORMAT_RAW,                                                            // RAW
+  PIXFORMAT_RGB444,                                                         // 3BP2P/RGB444
+  PIXFORMAT_RGB555,                                                         // 3BP2P/RGB555
+} pixformat_t;
+
+typedef enum {
+  FRAMESIZE_96X96,                                                          // 96x96
+  FRAMESIZE_QQVGA,                                                          // 160x120
+  FRAMESIZE_128X128,                                                        // 128x128
+  FRAMESIZE_QCIF,                                                           // 176x144
+  FRAMESIZE_HQVGA,                                                          // 240x176
+  FRAMESIZE_240X240,                                                        // 240x240
+  FRAMESIZE_QVGA,                                                           // 320x240
+  FRAMESIZE_320X320,                                                        // 320x320
+  FRAMESIZE_CIF,                                                            // 400x296
+  FRAMESIZE_HVGA,                                                           // 480x320
+  FRAMESIZE_VGA,                                                            // 640x480
+  FRAMESIZE_SVGA,                                                           // 800x600
+  FRAMESIZE_XGA,                                                            // 1024x768
+  FRAMESIZE_HD,                                                             // 1280x720
+  FRAMESIZE_SXGA,                                                           // 1280x1024
+  FRAMESIZE_UXGA,                                                           // 1600x1200
+  FRAMESIZE_FHD,                                                            // 1920x1080
+  FRAMESIZE_P_HD,                                                           // 720x1280
+  FRAMESIZE_P_3MP,                                                          // 864x1536
+  FRAMESIZE_QXGA,                                                           // 2048x1536
+  FRAMESIZE_QHD,                                                            // 2560x1440
+  FRAMESIZE_WQXGA,                                                          // 2560x1600
+  FRAMESIZE_P_FHD,                                                          // 1080x1920
+  FRAMESIZE_QSXGA,                                                          // 2560x1920
+  FRAMESIZE_5MP,                                                            // 2592x1944
+  FRAMESIZE_INVALID
+} framesize_t;
+
+typedef enum {
+  ASPECT_RATIO_4X3,
+  ASPECT_RATIO_3X2,
+  ASPECT_RATIO_16X10,
+  ASPECT_RATIO_5X3,
+  ASPECT_RATIO_16X9,
+  ASPECT_RATIO_21X9,
+  ASPECT_RATIO_5X4,
+  ASPECT_RATIO_1X1,
+  ASPECT_RATIO_9X16
+} aspect_ratio_t;
+
+typedef enum {
+  GAINCEILING_2X,
+  GAINCEILING_4X,
+  GAINCEILING_8X,
+  GAINCEILING_16X,
+  GAINCEILING_32X,
+  GAINCEILING_64X,
+  GAINCEILING_128X,
+} gainceiling_t;
+
+typedef enum {
+  OV2640_MODE_UXGA,                                                         // Full array readout
+  OV2640_MODE_SVGA,                                                         // 1/2 subsampled
+  OV2640_MODE_CIF,                                                          // 1/4 subsampled
+  OV2640_MODE_MAX
+} ov2640_sensor_mode_t;
+
+typedef enum {
+  CAMERA_GRAB_WHEN_EMPTY,                                                   // Fill buffers when they are empty
+  CAMERA_GRAB_LATEST                                                        // Always return the latest frame
+} camera_grab_mode_t;
+
+typedef enum {
+  CAMERA_FB_IN_PSRAM,                                                       // Frame buffer is placed in external PSRAM
+  CAMERA_FB_IN_DRAM                                                         // Frame buffer is placed in internal DRAM
+} camera_fb_location_t;
+
+typedef struct {
+  const uint16_t width;
+  const uint16_t height;
+  const aspect_ratio_t aspect_ratio;
+} resolution_info_t;
+
+extern const resolution_info_t resolution[];
+
+typedef struct {
+  uint8_t MIDH;
+  uint8_t MIDL;
+  uint16_t PID;
+  uint8_t VER;
+} sensor_id_t;
+
+typedef struct {
+  framesize_t framesize;
+  bool scale;
+  bool binning;
+  uint8_t quality;
+  int8_t brightness;
+  int8_t contrast;
+  int8_t saturation;
+  int8_t sharpness;
+  uint8_t denoise;
+  uint8_t special_effect;
+  uint8_t wb_mode;
+  uint8_t awb;
+  uint8_t awb_gain;
+  uint8_t aec;
+  uint8_t aec2;
+  int8_t ae_level;
+  uint16_t aec_value;
+  uint8_t agc;
+  uint8_t agc_gain;
+  uint8_t gainceiling;
+  uint8_t bpc;
+  uint8_t wpc;
+  uint8_t raw_gma;
+  uint8_t lenc;
+  uint8_t hmirror;
+  uint8_t vflip;
+  uint8_t dcw;
+  uint8_t colorbar;
+} camera_status_t;
+
+typedef struct _sensor sensor_t;
+typedef struct _sensor {
+  sensor_id_t id;
+  uint8_t slv_addr;
+  pixformat_t pixformat;
+  camera_status_t status;
+  int xclk_freq_hz;
+
+  int  (*init_status)       (sensor_t *sensor);
+  int  (*reset)             (sensor_t *sensor);
+  int  (*set_pixformat)     (sensor_t *sensor, pixformat_t pixformat);
+  int  (*set_framesize)     (sensor_t *sensor, framesize_t framesize);
+  int  (*set_contrast)      (sensor_t *sensor, int level);
+  int  (*set_brightness)    (sensor_t *sensor, int level);
+  int  (*set_saturation)    (sensor_t *sensor, int level);
+  int  (*set_sharpness)     (sensor_t *sensor, int level);
+  int  (*set_denoise)       (sensor_t *sensor, int level);
+  int  (*set_gainceiling)   (sensor_t *sensor, gainceiling_t gainceiling);
+  int  (*set_quality)       (sensor_t *sensor, int quality);
+  int  (*set_colorbar)      (sensor_t *sensor, int enable);
+  int  (*set_whitebal)      (sensor_t *sensor, int enable);
+  int  (*set_gain_ctrl)     (sensor_t *sensor, int enable);
+  int  (*set_exposure_ctrl) (sensor_t *sensor, int enable);
+  int  (*set_hmirror)       (sensor_t *sensor, int enable);
+  int  (*set_vflip)         (sensor_t *sensor, int enable);
+  int  (*set_aec2)          (sensor_t *sensor, int enable);
+  int  (*set_awb_gain)      (sensor_t *sensor, int enable);
+  int  (*set_agc_gain)      (sensor_t *sensor, int gain);
+  int  (*set_aec_value)     (sensor_t *sensor, int gain);
+  int  (*set_special_effect)(sensor_t *sensor, int effect);
+  int  (*set_wb_mode)       (sensor_t *sensor, int mode);
+  int  (*set_ae_level)      (sensor_t *sensor, int level);
+  int  (*set_dcw)           (sensor_t *sensor, int enable);
+  int  (*set_bpc)           (sensor_t *sensor, int enable);
+  int  (*set_wpc)           (sensor_t *sensor, int enable);
+  int  (*set_raw_gma)       (sensor_t *sensor, int enable);
+  int  (*set_lenc)          (sensor_t *sensor, int enable);
+  int  (*get_reg)           (sensor_t *sensor, int reg, int mask);
+  int  (*set_reg)           (sensor_t *sensor, int reg, int mask, int value);
+  int  (*set_res_raw)       (sensor_t *sensor, int startX, int startY, int endX, int endY, int offsetX, int offsetY,
+                             int totalX, int totalY, int outputX, int outputY, bool scale, bool binning);
+  int  (*set_pll)           (sensor_t *sensor, int bypass, int mul, int sys, int root, int pre, int seld5, int pclken, int pclk);
+  int  (*set_xclk)          (sensor_t *sensor, int timer, int xclk);
+
+  void *priv;                                                               // Simulator back-pointer (host builds only)
+} sensor_t;
+
+typedef struct {
+  uint8_t *buf;                                                             // Pointer to the pixel data
+  size_t len;                                                               // Length of the buffer in bytes
+  size_t width;                                                             // Width of the buffer in pixels
+  size_t height;                                                            // Height of the buffer in pixels
+  pixformat_t format;                                                       // Format of the pixel data
+  struct timeval timestamp;                                                 // Timestamp since boot of the first DMA buffer of the frame
+} camera_fb_t;
+
+typedef struct {
+  int xclk_freq_hz;                                                         // Simulated XCLK frequency
+  pixformat_t pixel_format;                                                 // Output pixel format
+  framesize_t frame_size;                                                   // Output frame size
+  int jpeg_quality;                                                         // JPEG quality (0-63), lower means better quality
+  size_t fb_count;                                                          // Number of frame buffers
+  camera_fb_location_t fb_location;                                         // Region charged in the simulated heap
+  camera_grab_mode_t grab_mode;                                             // Ignored by the simulator
+} camera_config_t;
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Simulated sensor                                              │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+
+typedef enum {
+  HMS_CAM_SIM_PATTERN                           = 0x00,                     // Generated test pattern
+  HMS_CAM_SIM_DIRECTORY                         = 0x01,                     // Replay recorded frames from a directory
+  HMS_CAM_SIM_RAW_FILE                          = 0x02,                     // Replay a raw capture file through mmap
+  HMS_CAM_SIM_RECORDING                         = 0x03,                     // Replay an HMS_CAM_Recorder AVI through mmap
+} HMS_CAM_SimSourceType;
+
+typedef enum {
+  HMS_CAM_SIM_COLOR_BARS                        = 0x00,                     // Static vertical color bars
+  HMS_CAM_SIM_GRADIENT                          = 0x01,                     // Static diagonal gradient
+  HMS_CAM_SIM_MOVING_BOX                        = 0x02,                     // Box moving over a gradient
+  HMS_CAM_SIM_NOISE                             = 0x03,                     // Uniform noise (worst case for JPEG)
+} HMS_CAM_SimPattern;
+
+typedef enum {
+  HMS_CAM_SIM_FAULT_NONE                        = 0x00,                     // Deliver frames unchanged
+  HMS_CAM_SIM_FAULT_TRUNCATE                    = 0x01,                     // Cut the frame in half, EOI is lost
+  HMS_CAM_SIM_FAULT_PADDING                     = 0x02,                     // Zero bytes after EOI, like a DMA overrun
+  HMS_CAM_SIM_FAULT_NO_SOI                      = 0x03,                     // Corrupt the start marker
+  HMS_CAM_SIM_FAULT_STALL                       = 0x04,                     // Hold the frame back, like a sensor losing sync
+} HMS_CAM_SimFault;
+
+class HMS_CAM_SimSensor {
+public:
+    HMS_CAM_SimSensor();
+    ~HMS_CAM_SimSensor();
+
+    HMS_CAM_SimSensor(const HMS_CAM_SimSensor&)             = delete;
+    HMS_CAM_SimSensor& operator=(const HMS_CAM_SimSensor&)  = delete;
+
+    HMS_CAM_StatusTypeDef init(const camera_config_t *config);
+    HMS_CAM_StatusTypeDef deinit();
+
+    camera_fb_t* fbGet(int64_t deadlineUs = HMS_CAM_NO_DEADLINE);                           // NULL at the deadline, frame stays due
+    void fbReturn(camera_fb_t *fb);
+    sensor_t* sensorGet()                                   { return _running ? &_sensor : nullptr; }
+
+    void setSource(HMS_CAM_SimSourceType source)            { _source = source;       }
+    void setPattern(HMS_CAM_SimPattern pattern)             { _pattern = pattern;     }
+    void setPath(const char *path)                          { _path = path ? path : ""; }
+    void setFrameRate(float fps)                            { _fps = fps;             }
+    void setJitter(uint32_t jitterUs)                       { _jitterUs = jitterUs;   }
+    void setLoop(bool loop)                                 { _loop = loop;           }
+    void setCopyFrames(bool copy)                           { _copyFrames = copy;     }
+    void setSeed(uint32_t seed)                             { _rng.seed(seed);        }
+    void setFault(HMS_CAM_SimFault fault, uint32_t everyN, size_t padding = 512);           // Corrupt every N-th frame
+    void setStallTime(uint32_t ms)                          { _stallMs = ms;          }    // Delay added by FAULT_STALL
+    void setSettleFrames(uint32_t frames)                   { _settleCount = frames;  }    // AEC ramp after init (pattern source)
+    void setSCCBDelay(uint32_t us)                          { _sccbUs = us;           }    // Cost of one emulated setter call
+    void setModule(HMS_CAM_ModuleType module)               { _module = module;       }    // PID, PLL support and frame timing
+    void setMemory(const HMS_CAM_MemoryTypeDef &memory)     { _memory = memory;       }    // Heap the frame buffers come from
+    void getMemory(HMS_CAM_MemoryTypeDef &memory) const     { memory = _memory;       }
+
+    uint32_t getSCCBWrites() const                          { return _sccbWrites.load(); }
+    uint32_t getFrameTimeUs() const;                                                        // Pacing period, 0 when unpaced
+
+    HMS_CAM_StatusTypeDef seek(size_t frame);                                               // Next frame delivered, O(1)
+    size_t getFrameCount() const                            { return _frames.size();  }
+    bool isRunning() const                                  { return _running;        }
+
+private:
+    struct Frame {
+        const uint8_t   *data;
+        size_t          len;
+        uint16_t        width;
+        uint16_t        height;
+    };
+
+    struct Window {
+        uint16_t        x;
+        uint16_t        y;
+        uint16_t        width;
+        uint16_t        height;
+        uint16_t        outWidth;                                                           // 0 when no window is set
+        uint16_t        outHeight;
+    };
+
+    struct Slot {
+        camera_fb_t     fb;
+        bool            inUse;
+        std::vector<uint8_t> copy;
+    };
+
+    HMS_CAM_SimSourceType       _source         = HMS_CAM_SIM_PATTERN;                      // Frame source
+    HMS_CAM_SimPattern          _pattern        = HMS_CAM_SIM_MOVING_BOX;                   // Pattern for HMS_CAM_SIM_PATTERN
+    std::string                 _path;                                                      // Directory, raw capture or recording
+    float                       _fps            = 0.0f;                                     // Frame rate, 0 means unpaced
+    uint32_t                    _jitterUs       = 0;                                        // Uniform +/- jitter per frame
+    bool                        _loop           = true;                                     // Restart when the source ends
+    bool                        _copyFrames     = false;                                    // Copy into per-slot buffers (emulates DMA)
+    bool                        _running        = false;                                    // Between init() and deinit()
+    HMS_CAM_SimFault            _fault          = HMS_CAM_SIM_FAULT_NONE;                   // Injected frame fault
+    uint32_t                    _faultEvery     = 0;                                        // Fault every N-th frame
+    size_t                      _faultPadding   = 0;                                        // Bytes appended by FAULT_PADDING
+    uint32_t                    _faultCounter   = 0;                                        // Frames since setFault()
+    uint32_t                    _stallMs        = 250;                                      // Delay added by FAULT_STALL
+    uint32_t                    _settleCount    = 0;                                        // Ramp frames delivered after init()
+    uint32_t                    _settleLeft     = 0;                                        // Ramp frames still to deliver
+    uint32_t                    _sccbUs         = 0;                                        // Delay per setter call
+    std::atomic<uint32_t>       _sccbWrites{0};                                             // Setter calls since init()
+    HMS_CAM_ModuleType          _module         = HMS_CAM_MODULE_UNKNOWN;                   // Emulated module, unknown = OV2640 PID, unpaced
+    HMS_CAM_MemoryTypeDef       _memory         = { SIZE_MAX / 4, SIZE_MAX / 4, SIZE_MAX / 4, SIZE_MAX / 4 }; // Unlimited until setMemory()
+
+    camera_config_t             _config         = {};                                       // Active configuration
+    sensor_t                    _sensor         = {};                                       // Emulated sensor control block
+    std::vector<Slot>           _slots;                                                     // fb_count frame buffers
+    std::vector<Frame>          _frames;                                                    // Frames of the active source
+    std::vector<std::vector<uint8_t>> _storage;                                             // Backing store for generated/loaded frames
+    std::vector<Frame>          _settleFrames;                                              // Darkened copies of frame 0, dim to bright
+    std::vector<std::vector<uint8_t>> _retired;                                             // Stores still referenced by leased slots
+    size_t                      _cursor         = 0;                                        // Next frame to deliver
+    Window                      _window         = {};                                       // set_res_raw() crop on the array
+
+    void                        *_map           = nullptr;                                  // mmap base of a raw capture file or recording
+    size_t                      _mapLength      = 0;                                        // mmap length
+    std::vector<uint8_t>        _fileData;                                                  // Raw capture file where mmap is unavailable
+
+    std::mutex                  _lock;                                                      // Guards slots and cursor
+    std::mt19937                _rng;                                                       // Jitter / noise generator
+    std::chrono::steady_clock::time_point _nextDue;                                         // Pacing deadline of the next frame
+    std::chrono::steady_clock::time_point _due;                                             // Delivery time of the pending frame
+    bool                        _duePending     = false;                                    // _due drawn, frame not delivered yet
+
+    HMS_CAM_StatusTypeDef _loadSource();
+    HMS_CAM_StatusTypeDef _loadPattern();
+    HMS_CAM_StatusTypeDef _loadDirectory();
+    HMS_CAM_StatusTypeDef _loadRawFile();
+    HMS_CAM_StatusTypeDef _loadRecording();
+    HMS_CAM_StatusTypeDef _mapFile();                                                       // _path into _map, once per source
+    void _releaseSource();
+    bool _pace(std::unique_lock<std::mutex> &lock, int64_t deadlineUs);                     // Holds _lock except while sleeping
+    void _setupSensor();
+
+    static int _sensorSetPixformat(sensor_t *sensor, pixformat_t pixformat);
+    static int _sensorSetFramesize(sensor_t *sensor, framesize_t framesize);
+    static int _sensorSetQuality(sensor_t *sensor, int quality);
+    static int _sensorSetResRaw(sensor_t *sensor, int startX, int startY, int endX, int endY, int offsetX, int offsetY,
+                                int totalX, int totalY, int outputX, int outputY, bool scale, bool binning);
+
+    friend void simSCCB(sensor_t *sensor);
+};
+
+#endif // HMS_CAM_PLATFORM_DESKTOP
+
+#endif // HMS_CAM_SIM_H
@@ -0,0 +1,103 @@
+/*
+ ============================================================================================================================================
+ * File:        HMS_CAM_Stats.h
+ * Author:      Hamas Saeed
+ * Version:     Rev_1.0.0
+ * Date:        Jan 28 2026
+ * Brief:       This file package provides lock-free capture statistics (counters, latency histograms, snapshots).
+ ============================================================================================================================================
+ * License:
+ * MIT License
+ *
+ * Copyright (c) 2025 Hamas Saeed
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For any inquiries, contact Hamas Saeed at hamasaeed@gmail.com
+ ============================================================================================================================================
+ */
+
+#ifndef HMS_CAM_STATS_H
+#define HMS_CAM_STATS_H
+
+#include "HMS_CAM_Config.h"
+#include "HMS_CAM_JPEG.h"
+
+#include <atomic>
+
+#define HMS_CAM_STATS_BUCKETS                   24                          // log2 buckets: [0], [1], [2,4), ... [2^22, inf) us
+#define HMS_CAM_STATS_MAGIC                     0x54534348                  // "HCST" little endian
+#define HMS_CAM_STATS_VERSION                   3
+
+typedef struct {
+  uint32_t frames;                                                          // Valid frames handed out
+  uint64_t bytes;                                                           // Payload bytes handed out
+  uint32_t fbGetFailures;                                                   // fb_get returned no buffer
+  uint32_t invalidFrames;                                                   // Frames rejected by validation
+  uint32_t trimmedFrames;                                                   // Frames with bytes after EOI
+  uint32_t trimmedBytes;                                                    // Bytes cut after EOI
+  uint32_t retries;                                                         // Extra fetch attempts in the retry loop
+  uint32_t droppedFrames;                                                   // Frames dropped by subscriber policies
+  uint32_t busyRejections;                                                  // Captures refused because all buffers were held
+  uint32_t timeouts;                                                        // Deadline captures that returned HMS_CAM_TIMEOUT
+  uint32_t lastSequence;                                                    // Sequence number of the newest frame
+  uint32_t elapsedMs;                                                       // First to last frame since reset
+  float    fps;                                                             // Average frame rate since reset
+  float    recentFps;                                                       // Exponentially smoothed frame rate
+  float    bytesPerSecond;                                                  // Average payload rate since reset
+  uint32_t fbWaitUs[HMS_CAM_STATS_BUCKETS];                                 // Histogram of time spent in fb_get
+  uint32_t latencyUs[HMS_CAM_STATS_BUCKETS];                                // Histogram of sensor timestamp to hand-off
+  uint32_t jpegErrors[HMS_CAM_JPEG_RESULT_COUNT];                           // Rejections per HMS_CAM_JPEGResult
+} HMS_CAM_StatsTypeDef;
+
+class HMS_CAM_Stats {
+public:
+    void reset();
+    void snapshot(HMS_CAM_StatsTypeDef &out) const;
+
+    void recordFrame(size_t bytes, uint32_t waitUs, uint32_t latencyUs, uint32_t sequence, int64_t nowUs);
+    void recordFbGetFailure()                               { _fbGetFailures.fetch_add(1, std::memory_order_relaxed);  }
+    void recordInvalid(HMS_CAM_JPEGResult result);
+    void recordTrim(size_t bytes);
+    void recordRetry()                                      { _retries.fetch_add(1, std::memory_order_relaxed);        }
+    void recordBusy()                                       { _busyRejections.fetch_add(1, std::memory_order_relaxed); }
+    void recordTimeout()                                    { _timeouts.fetch_add(1, std::memory_order_relaxed);       }
+
+    static uint32_t percentile(const uint32_t *histogram, float p);
+    static size_t toJSON(const HMS_CAM_StatsTypeDef &stats, char *buf, size_t len);
+    static size_t toBinary(const HMS_CAM_StatsTypeDef &stats, uint8_t *buf, size_t len);
+
+private:
+    std::atomic<uint32_t>       _frames{0};                                                 // Valid frames
+    std::atomic<uint32_t>       _bytes{0};                                                  // Payload bytes (low 32 bits)
+    std::atomic<uint32_t>       _bytesWraps{0};                                             // Payload bytes (high 32 bits)
+    std::atomic<uint32_t>       _fbGetFailures{0};                                          // fb_get failures
+    std::atomic<uint32_t>       _invalidFrames{0};                                          // Validation failures
+    std::atomic<uint32_t>       _trimmedFrames{0};                                          // Frames trimmed after EOI
+    std::atomic<uint32_t>       _trimmedBytes{0};                                           // Bytes trimmed after EOI
+    std::atomic<uint32_t>       _retries{0};                                                // Retry loop iterations
+    std::atomic<uint32_t>       _busyRejections{0};                                         // HMS_CAM_BUSY returns
+    std::atomic<uint32_t>       _timeouts{0};                                               // HMS_CAM_TIMEOUT returns
+    std::atomic<uint32_t>       _lastSequence{0};                                           // Newest sequence number
+    std::atomic<uint32_t>       _firstMs{0};                                                // Time of the first frame (ms)
+    std::atomic<uint32_t>       _lastMs{0};                                                 // Time of the newest frame (ms)
+    std::atomic<uint32_t>       _lastUs{0};                                                 // Time of the newest frame (us, wraps)
+    std::atomic<uint32_t>       _intervalUs{0};                                             // Smoothed frame interval
+    std::atomic<uint32_t>       _fbWait[HMS_CAM_STATS_BUCKETS] = {};                        // fb_get wait histogram
+    std::atomic<uint32_t>       _latency[HMS_CAM_STATS_BUCKETS] = {};                       // Capture latency histogram
+    std::atomic<uint32_t>       _jpegErrors[HMS_CAM_JPEG_RESULT_COUNT] = {};                // Validation failures by reason
+
+    static int _bucket(uint32_t us);
+};
+
+#endif // HMS_CAM_STATS_H
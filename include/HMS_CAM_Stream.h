@@ -0,0 +1,138 @@
+/*
+ ============================================================================================================================================
+ * File:        HMS_CAM_Stream.h
+ * Author:      Hamas Saeed
+ * Version:     Rev_1.0.0
+ * Date:        Jan 28 2026
+ * Brief:       This file package provides zero-copy multipart/x-mixed-replace (MJPEG) streaming with sink back-pressure.
+ ============================================================================================================================================
+ * License:
+ * MIT License
+ *
+ * Copyright (c) 2025 Hamas Saeed
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For any inquiries, contact Hamas Saeed at hamasaeed@gmail.com
+ ============================================================================================================================================
+ */
+
+#ifndef HMS_CAM_STREAM_H
+#define HMS_CAM_STREAM_H
+
+#include "HMS_CAM_Config.h"
+
+#ifdef HMS_CAM_HAS_CAMERA_API
+
+#include "HMS_CAM_Engine.h"
+
+#ifndef HMS_CAM_STREAM_BOUNDARY
+  #define HMS_CAM_STREAM_BOUNDARY               "hmscamframe"               // Multipart boundary token
+#endif
+
+#ifndef HMS_CAM_STREAM_STALL_MS
+  #define HMS_CAM_STREAM_STALL_MS               3000                        // Sink blocked this long on one frame = dead client
+#endif
+
+#define HMS_CAM_STREAM_BOUNDARY_MAX             70                          // RFC 2046 boundary length limit
+#define HMS_CAM_STREAM_PART_HEADER_MAX          (HMS_CAM_STREAM_BOUNDARY_MAX + 128)
+#define HMS_CAM_STREAM_IOV_COUNT                3                           // Part header, JPEG payload, trailer
+
+typedef struct {
+  const uint8_t *base;                                                      // Start of the chunk
+  size_t length;                                                            // Bytes in the chunk
+} HMS_CAM_IOVecTypeDef;
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Sink callback                                                 │
+  │       Writes as much of `iov[0..count)` as it can without blocking  │
+  │       for long and returns the bytes taken, 0 when it would block,  │
+  │       or a negative value when the connection is gone.              │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+typedef int32_t (*HMS_CAM_StreamSink)(const HMS_CAM_IOVecTypeDef *iov, size_t count, void *context);
+
+typedef struct {
+  uint32_t framesSent;                                                      // Frames written completely
+  uint32_t framesSkipped;                                                   // Frames not sent (pacing or sink still busy)
+  uint32_t stalls;                                                          // Sink calls that would have blocked
+  uint64_t bytesSent;                                                       // Bytes accepted by the sink
+} HMS_CAM_StreamStatsTypeDef;
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: MJPEG multipart stream                                        │
+  │       Each frame goes out as three chunks: part header, a pointer   │
+  │       into the driver buffer, CRLF. The JPEG payload is never       │
+  │       copied. Frames come from a LATEST subscriber, so while the    │
+  │       sink is busy newer frames replace older ones and the capture  │
+  │       task never waits for a slow client. Call pump() from the      │
+  │       connection's task, one HMS_CAM_Stream per client.             │
+  │       HMS_CAM_ERROR means the sink failed or stalled for longer     │
+  │       than the stall timeout: close the connection.                 │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+class HMS_CAM_Stream {
+public:
+    HMS_CAM_Stream() = default;
+    ~HMS_CAM_Stream()                                       { end();                  }
+
+    HMS_CAM_Stream(const HMS_CAM_Stream&)                   = delete;
+    HMS_CAM_Stream& operator=(const HMS_CAM_Stream&)        = delete;
+
+    HMS_CAM_StatusTypeDef begin(HMS_CAM &camera, HMS_CAM_StreamSink sink, void *context);
+    HMS_CAM_StatusTypeDef begin(HMS_CAM_StreamSink sink, void *context);                    // write() only, no subscriber
+    void end();
+
+    HMS_CAM_StatusTypeDef pump(uint32_t timeoutMs = 0);                                     // OK sent, BUSY pending/skipped, TIMEOUT no frame
+    HMS_CAM_StatusTypeDef write(const HMS_CAM_FrameBufferTypeDef &frame);                   // Caller keeps the buffer until !isPending()
+    HMS_CAM_StatusTypeDef flush();                                                          // Continue a pending frame
+
+    void setBoundary(const char *boundary);
+    void setMaxFrameRate(float fps)                         { _intervalUs = fps > 0.0f ? (int64_t)(1000000.0f / fps) : 0; }
+    void setStallTimeout(uint32_t ms)                       { _stallMs = ms;          }
+
+    bool isPending() const                                  { return _pending;        }
+    size_t getContentType(char *buf, size_t len) const;                                     // "multipart/x-mixed-replace;boundary=..."
+    size_t getHTTPHeader(char *buf, size_t len) const;                                      // Full response header for raw sockets
+    void getStats(HMS_CAM_StreamStatsTypeDef &stats) const;
+
+    #if defined(HMS_CAM_PLATFORM_DESKTOP) && !defined(_WIN32)
+        static int32_t fdSink(const HMS_CAM_IOVecTypeDef *iov, size_t count, void *context);    // context = (void*)(intptr_t)fd
+    #endif
+
+private:
+    HMS_CAM_StreamSink          _sink           = NULL;                                     // Output callback
+    void                        *_context       = NULL;                                     // Passed to the sink
+    HMS_CAM                     *_camera        = NULL;                                     // Source for pump()
+    HMS_CAM_Subscriber          *_subscriber    = NULL;                                     // LATEST subscriber of the capture task
+    HMS_CAM_FrameView           _view;                                                      // Frame being sent by pump()
+    char                        _boundary[HMS_CAM_STREAM_BOUNDARY_MAX + 1] = HMS_CAM_STREAM_BOUNDARY;
+    char                        _header[HMS_CAM_STREAM_PART_HEADER_MAX];                    // Part header of the pending frame
+    HMS_CAM_IOVecTypeDef        _iov[HMS_CAM_STREAM_IOV_COUNT] = {};                        // Remaining chunks of the pending frame
+    size_t                      _iovIndex       = 0;                                        // First chunk with data left
+    bool                        _pending        = false;                                    // A frame is partly written
+    int64_t                     _intervalUs     = 0;                                        // Minimum frame spacing, 0 = unpaced
+    int64_t                     _nextUs         = 0;                                        // Earliest start of the next frame
+    int64_t                     _stallSinceUs   = 0;                                        // Start of the current stall, 0 = none
+    uint32_t                    _stallMs        = HMS_CAM_STREAM_STALL_MS;                  // Stall limit before giving up
+    HMS_CAM_StreamStatsTypeDef  _stats          = {};                                       // Counters since begin()
+
+    HMS_CAM_StatusTypeDef _prepare(const HMS_CAM_FrameBufferTypeDef &frame);                // Error when the header does not fit
+    void _finish();
+};
+
+#endif // HMS_CAM_HAS_CAMERA_API
+
+#endif // HMS_CAM_STREAM_H
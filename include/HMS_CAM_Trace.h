@@ -0,0 +1,148 @@
+/*
+ ============================================================================================================================================
+ * File:        HMS_CAM_Trace.h
+ * Author:      Hamas Saeed
+ * Version:     Rev_1.0.0
+ * Date:        Jan 28 2026
+ * Brief:       This file package provides a compile-time gated per-core binary trace ring for the capture hot path.
+ ============================================================================================================================================
+ * License:
+ * MIT License
+ *
+ * Copyright (c) 2025 Hamas Saeed
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * For any inquiries, contact Hamas Saeed at hamasaeed@gmail.com
+ ============================================================================================================================================
+ */
+
+
+#ifndef HMS_CAM_TRACE_H
+#define HMS_CAM_TRACE_H
+
+#include "HMS_CAM_Config.h"
+
+#ifdef HMS_CAM_HAS_CAMERA_API
+
+#if defined(CONFIG_HMS_CAM_TRACE_EVENTS)
+  #define HMS_CAM_TRACE_EVENTS                  CONFIG_HMS_CAM_TRACE_EVENTS
+#elif !defined(HMS_CAM_TRACE_EVENTS)
+  #define HMS_CAM_TRACE_EVENTS                  1024                        // Events per core ring, power of two
+#endif
+
+#ifndef HMS_CAM_TRACE_CORES
+  #if defined(HMS_CAM_PLATFORM_ESP_IDF)
+    #define HMS_CAM_TRACE_CORES                 portNUM_PROCESSORS          // One ring per core
+  #else
+    #define HMS_CAM_TRACE_CORES                 8                           // Host CPUs folded onto this many rings
+  #endif
+#endif
+
+#define HMS_CAM_TRACE_MAGIC                     0x52544348                  // "HCTR"
+#define HMS_CAM_TRACE_VERSION                   1
+
+typedef enum {
+  HMS_CAM_TRACE_INIT                            = 0x01,                     // Span: driver init (_initCamera)
+  HMS_CAM_TRACE_CONFIGURE                       = 0x02,                     // Span: sensor configuration
+  HMS_CAM_TRACE_APPLY                           = 0x03,                     // Span: live settings, end arg = status
+  HMS_CAM_TRACE_SETTLE                          = 0x04,                     // Span: exposure settle, end arg = frames
+  HMS_CAM_TRACE_FB_GET                          = 0x05,                     // Span: driver fetch, begin arg = retry, end arg = bytes
+  HMS_CAM_TRACE_VALIDATE                        = 0x06,                     // Span: JPEG check, end arg = HMS_CAM_JPEGResult
+  HMS_CAM_TRACE_TIMEOUT                         = 0x07,                     // Instant: capture deadline passed, arg = fetch still running
+  HMS_CAM_TRACE_LEASE                           = 0x08,                     // Instant: frame handed to the caller, arg = sequence
+  HMS_CAM_TRACE_PUBLISH                         = 0x09,                     // Instant: capture task published, arg = sequence
+  HMS_CAM_TRACE_RECEIVE                         = 0x0A,                     // Instant: subscriber took a frame, arg = sequence
+  HMS_CAM_TRACE_RETURN                          = 0x0B,                     // Span: frame buffer returned to the driver
+  HMS_CAM_TRACE_REFRESH                         = 0x0C,                     // Span: refresh(), end arg = path, or status << 8
+  HMS_CAM_TRACE_EVENT_COUNT
+} HMS_CAM_TraceEventType;
+
+typedef enum {
+  HMS_CAM_TRACE_BEGIN                           = 0x00,                     // Span opens on this thread
+  HMS_CAM_TRACE_END                             = 0x01,                     // Innermost open span closes
+  HMS_CAM_TRACE_INSTANT                         = 0x02,                     // Point event
+} HMS_CAM_TracePhase;
+
+typedef struct {
+  uint64_t ticks;                                                           // Counter of the recording core
+  uint32_t arg;                                                             // Event argument, see HMS_CAM_TraceEventType
+  uint16_t thread;                                                          // Recording thread, numbered on first use
+  uint8_t  event;                                                           // HMS_CAM_TraceEventType
+  uint8_t  phase;                                                           // HMS_CAM_TracePhase
+} HMS_CAM_TraceEventTypeDef;
+
+typedef struct {
+  uint32_t magic;                                                           // HMS_CAM_TRACE_MAGIC
+  uint16_t version;                                                         // HMS_CAM_TRACE_VERSION
+  uint16_t cores;                                                           // Core sections that follow
+  uint32_t ticksPerUs;                                                      // Counter rate
+  uint8_t  tickBits;                                                        // 32: counter wraps, unwrap per core
+  uint8_t  reserved[3];
+} HMS_CAM_TraceHeaderTypeDef;
+
+typedef struct {
+  uint64_t anchorTicks;                                                     // Counter of this core at dump time
+  int64_t  anchorUs;                                                        // HMS_CAM_Micros() at the same moment
+  uint32_t count;                                                           // Events that follow
+  uint32_t lost;                                                            // Events overwritten since clear()
+} HMS_CAM_TraceCoreTypeDef;
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Hot path trace ring                                           │
+  │       Each core owns a ring of fixed 16-byte events. record() claims│
+  │       a slot with one atomic add and stores the event, nothing is   │
+  │       formatted and nothing blocks, so tracing does not shift the   │
+  │       timing it is meant to show. The oldest events are overwritten.│
+  │       Timestamps are raw counter ticks of the recording core: CCOUNT│
+  │       on the ESP32 (32 bits, wraps every ~18 s at 240 MHz) and      │
+  │       nanoseconds of the monotonic clock on the host. dump() adds   │
+  │       one anchor per core, a tick value taken together with         │
+  │       HMS_CAM_Micros(), so every ring maps onto one time base.      │
+  │       Built with HMS_CAM_TRACE (or CONFIG_HMS_CAM_TRACE) only.      │
+  │       Without it HMS_CAM_TRACER() compiles to nothing.              │
+  │       tools/HMS_CAM_TraceExport.cpp turns a dump into               │
+  │       Chrome/Perfetto trace JSON.                                   │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+class HMS_CAM_Trace {
+public:
+    static void record(HMS_CAM_TraceEventType event, HMS_CAM_TracePhase phase, uint32_t arg = 0);
+    static void clear();                                                                    // Drop all events, reset lost counts
+
+    static size_t dumpSize();                                                               // Upper bound for dump()
+    static HMS_CAM_StatusTypeDef dump(uint8_t *out, size_t capacity, size_t &length);       // NO_MEM when out is too small
+    static HMS_CAM_StatusTypeDef dump(const char *path);
+
+    static const char* eventName(uint8_t event);
+};
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Dump layout, little endian                                    │
+  │       HMS_CAM_TraceHeaderTypeDef, then per core one                 │
+  │       HMS_CAM_TraceCoreTypeDef followed by its `count` events,      │
+  │       oldest first.                                                 │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+
+#if HMS_CAM_TRACE_ENABLED
+  #define HMS_CAM_TRACER(event, phase, arg)     HMS_CAM_Trace::record(event, phase, (uint32_t)(arg))
+#else
+  #define HMS_CAM_TRACER(event, phase, arg)     do {} while (0)
+#endif
+
+#endif // HMS_CAM_HAS_CAMERA_API
+
+#endif // HMS_CAM_TRACE_H
@@ -1,28 +1,46 @@
 #include "HMS_CAM.h"
 
 #if HMS_CAM_DEBUG_ENABLED
-    ChronoLogger *camLogger = nullptr;
+    #include <mutex>
+
+    ChronoLogger        *camLogger = nullptr;
+    static std::mutex   camLoggerLock;
+    static size_t       camLoggerUsers = 0;                                                 // Instances alive, the last deletes camLogger
 #endif
 
-HMS_CAM::HMS_CAM() {
+HMS_CAM::HMS_CAM() : HMS_CAM("HMS_CAM") {
+}
+
+HMS_CAM::HMS_CAM(const char *name) {
+    snprintf(_name, sizeof(_name), "%s", name && name[0] ? name : "HMS_CAM");
+
     #if HMS_CAM_DEBUG_ENABLED
-        if (!camLogger) {
-            camLogger = new ChronoLogger("HMS_CAM");
-            camLogger->setLevel(HMS_CAM_LOG_LEVEL);
+        camLogger = new ChronoLogger(_name);
+        camLogger->setLevel(HMS_CAM_LOG_LEVEL);
+
+        std::lock_guard<std::mutex> guard(camLoggerLock);
+        if (camLoggerUsers++ == 0) {
+            ::camLogger = new ChronoLogger("HMS_CAM");                                      // Modules without an instance
+            ::camLogger->setLevel(HMS_CAM_LOG_LEVEL);
         }
     #endif
-    // Constructor implementation
 }
 
 HMS_CAM::~HMS_CAM() {
-    #ifdef HMS_CAM_PLATFORM_ESP_IDF
+    #ifdef HMS_CAM_HAS_CAMERA_API
+        _stopEngine();
+        _cancelFetch();
         returnFrameBuffer();
     #endif
 
     #if HMS_CAM_DEBUG_ENABLED
-        if (camLogger) {
-            delete camLogger;
-            camLogger = nullptr;
+        delete camLogger;
+        camLogger = nullptr;
+
+        std::lock_guard<std::mutex> guard(camLoggerLock);
+        if (--camLoggerUsers == 0) {
+            delete ::camLogger;
+            ::camLogger = nullptr;
         }
     #endif
 }
@@ -30,31 +48,84 @@ HMS_CAM::~HMS_CAM() {
 HMS_CAM_StatusTypeDef HMS_CAM::begin() {
     HMS_CAM_LOGGER(info, "Initializing HMS CAM...");
 
+    _bootReport   = {};
+    int64_t start = HMS_CAM_Micros();
+    int64_t lap   = start;
+
+    HMS_CAM_TRACER(HMS_CAM_TRACE_INIT, HMS_CAM_TRACE_BEGIN, 0);
     HMS_CAM_StatusTypeDef status = _initCamera();
+    HMS_CAM_TRACER(HMS_CAM_TRACE_INIT, HMS_CAM_TRACE_END, status);
     if (status != HMS_CAM_OK) {
         HMS_CAM_LOGGER(error, "Camera initialization failed");
         return status;
     }
+    _bootReport.initUs = (uint32_t)(HMS_CAM_Micros() - lap);
+    lap += _bootReport.initUs;
 
+    HMS_CAM_TRACER(HMS_CAM_TRACE_CONFIGURE, HMS_CAM_TRACE_BEGIN, 0);
     status = _configureSensor();
+    HMS_CAM_TRACER(HMS_CAM_TRACE_CONFIGURE, HMS_CAM_TRACE_END, status);
     if (status != HMS_CAM_OK) {
         HMS_CAM_LOGGER(error, "Sensor configuration failed");
         return status;
     }
+    _bootReport.configureUs = (uint32_t)(HMS_CAM_Micros() - lap);
+    lap += _bootReport.configureUs;
+
+    #ifdef HMS_CAM_HAS_CAMERA_API
+        HMS_CAM_TRACER(HMS_CAM_TRACE_APPLY, HMS_CAM_TRACE_BEGIN, 0);
+        status = _applyLiveSettings();                                                      // Buffers may be sized for _maxFrameSize
+        HMS_CAM_TRACER(HMS_CAM_TRACE_APPLY, HMS_CAM_TRACE_END, status);
+        if (status != HMS_CAM_OK) {
+            HMS_CAM_LOGGER(error, "Failed to apply frame settings");
+            return status;
+        }
+        _bootReport.applyUs = (uint32_t)(HMS_CAM_Micros() - lap);
+        lap += _bootReport.applyUs;
+
+        HMS_CAM_TRACER(HMS_CAM_TRACE_SETTLE, HMS_CAM_TRACE_BEGIN, 0);
+        _settleExposure();                                                                  // Replaces a fixed 500 ms delay
+        HMS_CAM_TRACER(HMS_CAM_TRACE_SETTLE, HMS_CAM_TRACE_END, _bootReport.settleFrames);
+        _bootReport.settleUs = (uint32_t)(HMS_CAM_Micros() - lap);
+        lap += _bootReport.settleUs;
+    #endif
 
     HMS_CAM_LOGGER(info, "HMS CAM initialized successfully");
     _initialized = true;
+
+    #ifdef HMS_CAM_HAS_CAMERA_API
+        if (_taskEnabled) {
+            status = _startEngine();
+            if (status != HMS_CAM_OK) {
+                return status;
+            }
+        }
+        _bootReport.engineUs = (uint32_t)(HMS_CAM_Micros() - lap);
+    #endif
+
+    _bootReport.totalUs = (uint32_t)(HMS_CAM_Micros() - start);
+    HMS_CAM_LOGGER(debug, "Boot: init %u us, configure %u us, settle %u us (%u frames), total %u us",
+                   (unsigned)_bootReport.initUs, (unsigned)_bootReport.configureUs, (unsigned)_bootReport.settleUs,
+                   (unsigned)_bootReport.settleFrames, (unsigned)_bootReport.totalUs);
     return HMS_CAM_OK;
 }
 
 HMS_CAM_StatusTypeDef HMS_CAM::stop() {
     HMS_CAM_LOGGER(info, "Stopping HMS CAM...");
-    #ifdef HMS_CAM_PLATFORM_ESP_IDF
+    #ifdef HMS_CAM_HAS_CAMERA_API
+        _stopEngine();
+        _cancelFetch();
         returnFrameBuffer();
-        esp_err_t err = esp_camera_deinit();
-        if (err != ESP_OK) {
-            HMS_CAM_LOGGER(error, "Camera de-initialization failed: %s", esp_err_to_name(err));
-            return HMS_CAM_ERROR;
+        if (_leases.load() != 0) {
+            HMS_CAM_LOGGER(warn, "Cannot stop, %u frame leases still in flight", (unsigned)_leases.load());
+            return HMS_CAM_BUSY;
+        }
+        _shared.reset();
+        _sharedCount = 0;
+
+        HMS_CAM_StatusTypeDef status = _deinitCamera();
+        if (status != HMS_CAM_OK) {
+            return status;
         }
     #endif
     _initialized = false;
@@ -67,14 +138,864 @@ HMS_CAM_StatusTypeDef HMS_CAM::refresh() {
         return HMS_CAM_ERROR;
     }
 
+    HMS_CAM_TRACER(HMS_CAM_TRACE_REFRESH, HMS_CAM_TRACE_BEGIN, 0);
+    int64_t start = HMS_CAM_Micros();
+    HMS_CAM_StatusTypeDef status;
+
+    #ifdef HMS_CAM_HAS_CAMERA_API
+        if (_canRefreshLive()) {
+            bool changed = _frameSize != _active.frameSize || _pixelFormat != _active.pixelFormat ||
+                           _jpegQuality != _active.jpegQuality;
+
+            status = _applyLiveSettings();
+            if (status == HMS_CAM_OK) {
+                _refreshReport.path       = changed ? HMS_CAM_REFRESH_LIVE : HMS_CAM_REFRESH_NONE;
+                _refreshReport.durationUs = (uint32_t)(HMS_CAM_Micros() - start);
+                HMS_CAM_LOGGER(info, "Camera settings applied live in %u us", (unsigned)_refreshReport.durationUs);
+                HMS_CAM_TRACER(HMS_CAM_TRACE_REFRESH, HMS_CAM_TRACE_END, _refreshReport.path);
+                return HMS_CAM_OK;
+            }
+            HMS_CAM_LOGGER(warn, "Live settings change failed, falling back to re-initialization");
+        }
+
+        bool engine = _taskRunning.load();
+        _stopEngine();
+        _cancelFetch();
+        returnFrameBuffer();
+        if (_leases.load() != 0) {
+            HMS_CAM_LOGGER(warn, "Cannot refresh, %u frame leases still in flight", (unsigned)_leases.load());
+            if (engine) _startEngine();
+            HMS_CAM_TRACER(HMS_CAM_TRACE_REFRESH, HMS_CAM_TRACE_END, HMS_CAM_BUSY << 8);
+            return HMS_CAM_BUSY;
+        }
+    #endif
+
     HMS_CAM_LOGGER(info, "Refreshing camera settings...");
 
-    HMS_CAM_StatusTypeDef status = _refreshSettings();
+    status = _refreshSettings();
     if (status != HMS_CAM_OK) {
         HMS_CAM_LOGGER(error, "Failed to refresh camera settings");
+        HMS_CAM_TRACER(HMS_CAM_TRACE_REFRESH, HMS_CAM_TRACE_END, status << 8);
         return status;
     }
 
-    HMS_CAM_LOGGER(info, "Camera settings refreshed successfully");
+    #ifdef HMS_CAM_HAS_CAMERA_API
+        if (engine) {
+            status = _startEngine();
+            if (status != HMS_CAM_OK) {
+                HMS_CAM_TRACER(HMS_CAM_TRACE_REFRESH, HMS_CAM_TRACE_END, status << 8);
+                return status;
+            }
+        }
+    #endif
+
+    _refreshReport.path       = HMS_CAM_REFRESH_REINIT;
+    _refreshReport.durationUs = (uint32_t)(HMS_CAM_Micros() - start);
+    HMS_CAM_LOGGER(info, "Camera settings refreshed successfully in %u us", (unsigned)_refreshReport.durationUs);
+    HMS_CAM_TRACER(HMS_CAM_TRACE_REFRESH, HMS_CAM_TRACE_END, _refreshReport.path);
+    return HMS_CAM_OK;
+}
+
+void HMS_CAM::getStats(HMS_CAM_StatsTypeDef &stats) const {
+    _stats.snapshot(stats);
+    #ifdef HMS_CAM_HAS_CAMERA_API
+        for (const HMS_CAM_Subscriber &sub : _subscribers) {
+            stats.droppedFrames += sub.getDropped();
+        }
+    #endif
+}
+
+#ifdef HMS_CAM_HAS_CAMERA_API
+
+void HMS_CAM::returnFrameBuffer() {
+    if (_fb != NULL) {
+        _releaseLease(_fb);
+        _fb = NULL;
+    }
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM::flush() {
+    returnFrameBuffer();
+    return HMS_CAM_OK;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM::_configureSensor() {
+    sensor_t * s = _sensorGet();
+    if (s != NULL) {
+        _sensorDriver = HMS_CAM_Sensor::detect(s);
+        const HMS_CAM_SensorProfileTypeDef *profile = _sensorProfile;
+        if (profile == NULL) {
+            profile = _sensorDriver && _sensorDriver->profile ? _sensorDriver->profile : &HMS_CAM_Sensor::defaultProfile();
+        }
+
+        HMS_CAM_SensorApplyTypeDef report;
+        HMS_CAM_Sensor::apply(s, *profile, false, report);                                  // Skips values the sensor already holds
+        _bootReport.sensorWritten = report.written;
+        _bootReport.sensorSkipped = report.skipped;
+
+        if (_sensorDriver == NULL) {
+            HMS_CAM_LOGGER(info, "Unknown sensor PID 0x%04x, using the default profile", (unsigned)s->id.PID);
+        } else {
+            HMS_CAM_LOGGER(info, "Detected %s sensor", _sensorDriver->name);
+            if ((uint32_t)s->xclk_freq_hz > _sensorDriver->maxXclkHz && s->set_xclk != NULL) {
+                HMS_CAM_LOGGER(warn, "XCLK %d Hz is above the %s limit, lowering to %u Hz", s->xclk_freq_hz,
+                               _sensorDriver->name, (unsigned)_sensorDriver->maxXclkHz);
+                s->set_xclk(s, 0, _sensorDriver->maxXclkHz / 1000000);                      // LEDC_TIMER_0, as in _initCamera
+            }
+            if (_minFrameRate && _sensorDriver->highFps) {
+                HMS_CAM_Sensor::apply(s, *_sensorDriver->highFps, false, report);
+                _bootReport.sensorWritten += report.written;
+                _bootReport.sensorSkipped += report.skipped;
+            }
+            _applySensorClock();
+        }
+
+        HMS_CAM_LOGGER(debug, "Camera sensor configured");
+        return HMS_CAM_OK;
+    }
+    return HMS_CAM_ERROR;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM::_refreshSettings() {
+    HMS_CAM_LOGGER(info, "Refreshing camera settings...");
+
+    _initialized = false;
+    returnFrameBuffer();
+    _deinitCamera();
+
+    HMS_CAM_TRACER(HMS_CAM_TRACE_INIT, HMS_CAM_TRACE_BEGIN, 0);
+    HMS_CAM_StatusTypeDef status = _initCamera();
+    HMS_CAM_TRACER(HMS_CAM_TRACE_INIT, HMS_CAM_TRACE_END, status);
+    if (status != HMS_CAM_OK) {
+        HMS_CAM_LOGGER(error, "Camera re-initialization failed");
+        return status;
+    }
+
+    status = _configureSensor();                                                            // Re-init resets sensor tuning
+    if (status == HMS_CAM_OK) {
+        status = _applyLiveSettings();
+    }
+    if (status != HMS_CAM_OK) {
+        HMS_CAM_LOGGER(error, "Sensor re-configuration failed");
+        return status;
+    }
+    HMS_CAM_TRACER(HMS_CAM_TRACE_SETTLE, HMS_CAM_TRACE_BEGIN, 0);
+    _settleExposure();
+    HMS_CAM_TRACER(HMS_CAM_TRACE_SETTLE, HMS_CAM_TRACE_END, _bootReport.settleFrames);
+
+    HMS_CAM_LOGGER(info, "Camera re-initialized successfully");
+    _initialized = true;
+    return HMS_CAM_OK;
+
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM::captureFrame(HMS_CAM_FrameBufferTypeDef &frame) {
+    if(!_initialized) {
+        HMS_CAM_LOGGER(error, "Camera not initialized. Call begin() first.");
+        return HMS_CAM_ERROR;
+    }
+
+    frame = {};
+
+    returnFrameBuffer();
+    if (!_reserveBuffer()) {
+        HMS_CAM_LOGGER(warn, "All %u frame buffers are leased", (unsigned)_active.fbCount);
+        _stats.recordBusy();
+        return HMS_CAM_BUSY;
+    }
+
+    _fb = _acquireFrame(frame);
+    if (!_fb) {
+        _leases.fetch_sub(1);
+        HMS_CAM_LOGGER(error, "Failed to capture valid frame after retries");
+        return HMS_CAM_ERROR;
+    }
+
+    HMS_CAM_TRACER(HMS_CAM_TRACE_LEASE, HMS_CAM_TRACE_INSTANT, frame.sequence);
+    HMS_CAM_LOGGER(debug, "Frame captured: %ux%u, size: %u bytes", frame.width, frame.height, frame.length);
+    return HMS_CAM_OK;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM::captureFrame(HMS_CAM_FrameLease &lease) {
+    lease.release();
+
+    if(!_initialized) {
+        HMS_CAM_LOGGER(error, "Camera not initialized. Call begin() first.");
+        return HMS_CAM_ERROR;
+    }
+
+    if (!_reserveBuffer()) {
+        HMS_CAM_LOGGER(warn, "All %u frame buffers are leased", (unsigned)_active.fbCount);
+        _stats.recordBusy();
+        return HMS_CAM_BUSY;
+    }
+
+    camera_fb_t *fb = _acquireFrame(lease._frame);
+    if (!fb) {
+        _leases.fetch_sub(1);
+        HMS_CAM_LOGGER(error, "Failed to capture valid frame after retries");
+        return HMS_CAM_ERROR;
+    }
+
+    lease._owner            = this;
+    lease._fb               = fb;
+
+    HMS_CAM_TRACER(HMS_CAM_TRACE_LEASE, HMS_CAM_TRACE_INSTANT, lease._frame.sequence);
+    HMS_CAM_LOGGER(debug, "Frame leased: %ux%u, size: %u bytes", lease._frame.width, lease._frame.height, lease._frame.length);
     return HMS_CAM_OK;
 }
+
+HMS_CAM_StatusTypeDef HMS_CAM::captureFrame(HMS_CAM_FrameLease &lease, uint32_t timeoutMs) {
+    return captureFrameUntil(lease, HMS_CAM_Micros() + (int64_t)timeoutMs * 1000);
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM::captureFrameUntil(HMS_CAM_FrameLease &lease, int64_t deadlineUs) {
+    lease.release();
+
+    if(!_initialized) {
+        HMS_CAM_LOGGER(error, "Camera not initialized. Call begin() first.");
+        return HMS_CAM_ERROR;
+    }
+    return _captureUntil(lease, deadlineUs);
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM::captureFrameAsync(HMS_CAM_CaptureCallback callback, void *context, uint32_t timeoutMs) {
+    if (!_initialized || !callback) {
+        return HMS_CAM_ERROR;
+    }
+
+    uint8_t idle = 0;
+    if (!_requestState.compare_exchange_strong(idle, 1)) {
+        _stats.recordBusy();
+        return HMS_CAM_BUSY;                                                                // One request in flight
+    }
+    _requestCallback = callback;
+    _requestContext  = context;
+    _requestDeadline = HMS_CAM_Micros() + (int64_t)timeoutMs * 1000;
+    _requestState.store(2);
+    _taskWake.give();
+
+    HMS_CAM_StatusTypeDef status = _startEngine();                                          // No-op when already running
+    if (status != HMS_CAM_OK) {
+        _requestState.store(0);
+    }
+    return status;
+}
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Bounded capture                                               │
+  │       Only one deadline capture runs at a time, a second caller gets│
+  │       HMS_CAM_BUSY instead of queueing behind it. When the deadline │
+  │       passes while the driver is still inside fb_get, the buffer    │
+  │       reservation stays with that fetch and the next call picks up  │
+  │       its frame.                                                    │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+HMS_CAM_StatusTypeDef HMS_CAM::_captureUntil(HMS_CAM_FrameLease &lease, int64_t deadlineUs) {
+    if (_timedBusy.exchange(true)) {
+        _stats.recordBusy();
+        return HMS_CAM_BUSY;
+    }
+
+    if (!_fetchCarried.exchange(false) && !_reserveBuffer()) {
+        _timedBusy.store(false);
+        _stats.recordBusy();
+        return HMS_CAM_BUSY;
+    }
+
+    HMS_CAM_StatusTypeDef status;
+    bool pending    = false;
+    camera_fb_t *fb = _acquireFrame(lease._frame, deadlineUs, &status, &pending);
+    if (!fb) {
+        if (pending) {
+            _fetchCarried.store(true);                                                      // The late frame still needs its buffer
+        } else {
+            _leases.fetch_sub(1);
+        }
+        lease._frame = {};
+        _timedBusy.store(false);
+        if (status == HMS_CAM_TIMEOUT) {
+            _stats.recordTimeout();
+            return HMS_CAM_TIMEOUT;
+        }
+        HMS_CAM_LOGGER(error, "Failed to capture valid frame after retries");
+        return HMS_CAM_ERROR;
+    }
+    _timedBusy.store(false);
+
+    lease._owner            = this;
+    lease._fb               = fb;
+    HMS_CAM_TRACER(HMS_CAM_TRACE_LEASE, HMS_CAM_TRACE_INSTANT, lease._frame.sequence);
+    return HMS_CAM_OK;
+}
+
+void HMS_CAM::_serveRequest() {
+    HMS_CAM_CaptureCallback callback = _requestCallback;
+    void    *context  = _requestContext;
+    int64_t deadline  = _requestDeadline;
+    _requestState.store(0);                                                                 // The callback may queue the next one
+
+    HMS_CAM_FrameLease lease;
+    HMS_CAM_StatusTypeDef status = _captureUntil(lease, deadline);
+    callback(status, lease, context);
+}
+
+void HMS_CAM::_cancelFetch() {
+    _fbCancel();
+    if (_fetchCarried.exchange(false)) {
+        _leases.fetch_sub(1);
+        _taskWake.give();
+    }
+}
+
+size_t HMS_CAM::_frameBufferBytes(framesize_t size, pixformat_t format) {
+    return HMS_CAM_Planner::bufferBytes(size, format);
+}
+
+size_t HMS_CAM::_frameBufferBytes(size_t width, size_t height, pixformat_t format) {
+    return HMS_CAM_Planner::bufferBytes(width, height, format);
+}
+
+framesize_t HMS_CAM::_coveringFrameSize(size_t width, size_t height) {
+    framesize_t best = FRAMESIZE_INVALID;
+    size_t      area = SIZE_MAX;
+    for (int i = 0; i < FRAMESIZE_INVALID; i++) {
+        const resolution_info_t &r = resolution[i];
+        if (r.width >= width && r.height >= height && (size_t)r.width * r.height < area) {
+            area = (size_t)r.width * r.height;
+            best = (framesize_t)i;
+        }
+    }
+    return best;
+}
+
+framesize_t HMS_CAM::_allocFrameSize() const {
+    framesize_t size = _frameSize;
+    if (_roiActive) {
+        framesize_t cover = _coveringFrameSize(_roi.outWidth, _roi.outHeight);              // clearROI() must still fit _frameSize
+        if (cover < FRAMESIZE_INVALID &&
+            (size_t)resolution[cover].width * resolution[cover].height > (size_t)resolution[size].width * resolution[size].height) {
+            size = cover;
+        }
+    }
+    if (_maxFrameSize >= FRAMESIZE_INVALID) {
+        return size;
+    }
+    size_t requested = (size_t)resolution[size].width * resolution[size].height;
+    size_t maximum   = (size_t)resolution[_maxFrameSize].width * resolution[_maxFrameSize].height;
+    return maximum > requested ? _maxFrameSize : size;
+}
+
+void HMS_CAM::_recordActiveConfig(const camera_config_t &config) {
+    _active.frameSize   = config.frame_size;
+    _active.pixelFormat = config.pixel_format;
+    _active.jpegQuality = config.jpeg_quality;
+    _active.fbCount     = config.fb_count;
+    _active.fbBytes     = _frameBufferBytes(config.frame_size, config.pixel_format);
+    _active.fbLocation  = config.fb_location;
+    _active.grabMode    = config.grab_mode;
+    _active.frequencyHz = config.xclk_freq_hz;
+    _roiApplied         = false;                                                            // Init resets the sensor window
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM::_initPlanned(camera_config_t &config) {
+    HMS_CAM_PlanRequestTypeDef request = {};
+    request.frameSize    = config.frame_size;
+    request.pixelFormat  = config.pixel_format;
+    request.jpegQuality  = config.jpeg_quality;
+    request.fbCount      = config.fb_count;
+    request.fbLocation   = config.fb_location;
+    request.minFrameSize = _minFrameSize;
+
+    HMS_CAM_MemoryTypeDef memory;
+    _memoryProbe(memory);
+    HMS_CAM_StatusTypeDef status = HMS_CAM_Planner::plan(request, memory, _plan);
+    _bootReport.initAttempts = 0;
+    while (status == HMS_CAM_OK) {
+        config.frame_size  = _plan.frameSize;
+        config.fb_count    = _plan.fbCount;
+        config.fb_location = _plan.fbLocation;
+        _bootReport.initAttempts++;
+
+        status = _driverInit(config);
+        if (status != HMS_CAM_NO_MEM || _bootReport.initAttempts >= HMS_CAM_PLAN_MAX_ATTEMPTS) {
+            break;
+        }
+        HMS_CAM_LOGGER(warn, "Driver init failed at plan step %u (%ux%u, %u x %u B in %s), trying the next step",
+                       _plan.step, resolution[_plan.frameSize].width, resolution[_plan.frameSize].height,
+                       (unsigned)_plan.fbCount, (unsigned)_plan.fbBytes, HMS_CAM_Planner::regionName(_plan.fbLocation));
+        _memoryProbe(memory);                                                               // The failed init freed what it got
+        status = HMS_CAM_Planner::plan(request, memory, _plan, (uint16_t)(_plan.step + 1));
+    }
+    if (status != HMS_CAM_OK) {
+        _plan = {};
+        return status;
+    }
+
+    if (_plan.degraded) {
+        HMS_CAM_LOGGER(warn, "Frame buffers degraded to %ux%u, %u x %u B in %s (asked for %ux%u, %u in %s)",
+                       resolution[_plan.frameSize].width, resolution[_plan.frameSize].height, (unsigned)_plan.fbCount,
+                       (unsigned)_plan.fbBytes, HMS_CAM_Planner::regionName(_plan.fbLocation),
+                       resolution[request.frameSize].width, resolution[request.frameSize].height, (unsigned)request.fbCount,
+                       HMS_CAM_Planner::regionName(request.fbLocation));
+    }
+    if (_plan.worstBytes > _plan.fbBytes) {
+        HMS_CAM_LOGGER(warn, "JPEG quality %d can exceed the %u B buffers (up to %u B), frames may be truncated",
+                       config.jpeg_quality, (unsigned)_plan.fbBytes, (unsigned)_plan.worstBytes);
+    }
+
+    _recordActiveConfig(config);
+    _active.fbCountWanted    = request.fbCount;
+    _active.fbLocationWanted = request.fbLocation;
+    return HMS_CAM_OK;
+}
+
+bool HMS_CAM::_canRefreshLive() const {
+    if (_fbCount != _active.fbCountWanted || _fbLocation != _active.fbLocationWanted ||
+        _grabMode != _active.grabMode || _frequencyHz != _active.frequencyHz) {
+        return false;                                                                       // Buffer layout / clock changes need init
+    }
+    if ((_pixelFormat == PIXFORMAT_JPEG) != (_active.pixelFormat == PIXFORMAT_JPEG)) {
+        return false;                                                                       // JPEG <-> raw switches the DMA mode
+    }
+    if (_roiActive) {
+        return _frameBufferBytes(_roi.outWidth, _roi.outHeight, _pixelFormat) <= _active.fbBytes;
+    }
+    return _frameBufferBytes(_frameSize, _pixelFormat) <= _active.fbBytes;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM::_applyLiveSettings() {
+    std::lock_guard<std::mutex> guard(_stageLock);                                          // Rate control also drives the sensor
+    sensor_t *s = _sensorGet();
+    if (s == NULL) {
+        return HMS_CAM_ERROR;
+    }
+
+    framesize_t capped = _cappedFrameSize(_frameSize, (uint32_t)s->xclk_freq_hz);
+    if (capped != _frameSize) {
+        HMS_CAM_LOGGER(info, "Frame size %d capped to %d for %u fps on %s", (int)_frameSize, (int)capped,
+                       (unsigned)_minFrameRate, _sensorDriver->name);
+        _frameSize = capped;
+    }
+    if (_sensorDriver && _pixelFormat == PIXFORMAT_JPEG && _jpegQuality < _sensorDriver->jpegQualityMin) {
+        HMS_CAM_LOGGER(warn, "JPEG quality %d is below the %s minimum, using %u", _jpegQuality, _sensorDriver->name,
+                       (unsigned)_sensorDriver->jpegQualityMin);
+        _jpegQuality = _sensorDriver->jpegQualityMin;
+    }
+
+    if (_pixelFormat != _active.pixelFormat) {
+        if (s->set_pixformat(s, _pixelFormat) != 0) return HMS_CAM_ERROR;
+        _active.pixelFormat = _pixelFormat;
+    }
+    if (_frameSize != _active.frameSize && !_roiActive) {                                   // The ROI owns the sensor window
+        if (_frameBufferBytes(_frameSize, _pixelFormat) > _active.fbBytes) {
+            HMS_CAM_LOGGER(warn, "Frame size %d does not fit the allocated buffers, keeping %d", (int)_frameSize, (int)_active.frameSize);
+        } else {
+            if (s->set_framesize(s, _frameSize) != 0) return HMS_CAM_ERROR;
+            _active.frameSize = _frameSize;
+            _applySensorClock();                                                            // set_framesize may reprogram the PLL
+        }
+    }
+    if (_pixelFormat == PIXFORMAT_JPEG && _jpegQuality != _active.jpegQuality) {
+        if (s->set_quality(s, _jpegQuality) != 0) return HMS_CAM_ERROR;
+        _active.jpegQuality = _jpegQuality;
+    }
+
+    if (_roiActive && !_roiApplied) {
+        if (_sensorDriver == NULL || HMS_CAM_Sensor::setWindow(s, *_sensorDriver, _roi) != HMS_CAM_OK) {
+            HMS_CAM_LOGGER(warn, "ROI not supported by this sensor, using the full frame");
+            _roiActive = false;
+        } else {
+            _roiApplied = true;
+        }
+    }
+
+    _rate.reset(_active.jpegQuality, _active.frameSize, _frameSize, _active.fbBytes);       // Controller restarts from the user settings
+    return HMS_CAM_OK;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM::setROI(uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+                                      uint16_t outWidth, uint16_t outHeight) {
+    HMS_CAM_SensorWindowTypeDef roi = { x, y, width, height, outWidth ? outWidth : width, outHeight ? outHeight : height };
+    if (!_initialized) {
+        _roi        = roi;                                                                  // Applied and sized by begin()
+        _roiActive  = true;
+        _roiApplied = false;
+        return HMS_CAM_OK;
+    }
+
+    if (_frameBufferBytes(roi.outWidth, roi.outHeight, _active.pixelFormat) > _active.fbBytes) {
+        HMS_CAM_LOGGER(warn, "ROI output %ux%u does not fit the allocated buffers", roi.outWidth, roi.outHeight);
+        return HMS_CAM_NO_MEM;
+    }
+    sensor_t *s = _sensorGet();
+    if (s == NULL || _sensorDriver == NULL) {
+        return HMS_CAM_ERROR;
+    }
+    HMS_CAM_StatusTypeDef status = HMS_CAM_Sensor::setWindow(s, *_sensorDriver, roi);       // No re-init, next frame uses it
+    if (status != HMS_CAM_OK) {
+        return status;
+    }
+    _roi        = roi;
+    _roiActive  = true;
+    _roiApplied = true;
+    HMS_CAM_LOGGER(debug, "ROI %ux%u+%u+%u -> %ux%u", _roi.width, _roi.height, _roi.x, _roi.y, _roi.outWidth, _roi.outHeight);
+    return HMS_CAM_OK;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM::clearROI() {
+    if (!_roiActive) {
+        return HMS_CAM_OK;
+    }
+    _roiActive  = false;
+    _roiApplied = false;
+    if (!_initialized) {
+        return HMS_CAM_OK;
+    }
+
+    sensor_t *s = _sensorGet();
+    framesize_t size = _frameBufferBytes(_frameSize, _active.pixelFormat) <= _active.fbBytes ? _frameSize : _active.frameSize;
+    if (s == NULL || s->set_framesize(s, size) != 0) {                                      // Rewrites the sensor window
+        return HMS_CAM_ERROR;
+    }
+    _active.frameSize = size;
+    _applySensorClock();
+    return HMS_CAM_OK;
+}
+
+static int settleMeanLuma(const camera_fb_t *fb, HMS_CAM_JPEGWorkspaceTypeDef *work, uint8_t *blocks, size_t capacity) {
+    if (fb->format == PIXFORMAT_JPEG) {
+        uint16_t blocksX, blocksY;
+        if (!work || HMS_CAM_JPEG::dcLuma(fb->buf, fb->len, blocks, capacity, blocksX, blocksY, *work) != HMS_CAM_OK) {
+            return -1;
+        }
+        size_t   count = (size_t)blocksX * blocksY;
+        uint32_t sum   = 0;
+        for (size_t i = 0; i < count; i++) {
+            sum += blocks[i];
+        }
+        return count ? (int)(sum / count) : -1;
+    }
+
+    size_t bytesPerPixel;
+    switch (fb->format) {
+        case PIXFORMAT_GRAYSCALE:   bytesPerPixel = 1;  break;
+        case PIXFORMAT_YUV422:
+        case PIXFORMAT_RGB565:      bytesPerPixel = 2;  break;
+        case PIXFORMAT_RGB888:      bytesPerPixel = 3;  break;
+        default:                    return -1;
+    }
+    size_t pixels = fb->len / bytesPerPixel;
+    size_t step   = pixels > 4096 ? pixels / 4096 : 1;                                      // A few thousand samples are plenty
+    uint64_t sum  = 0;
+    size_t count  = 0;
+    for (size_t i = 0; i < pixels; i += step, count++) {
+        const uint8_t *p = fb->buf + i * bytesPerPixel;
+        if (fb->format == PIXFORMAT_RGB565) {
+            uint32_t r = p[0] >> 3;                                                         // Big endian RGB565
+            uint32_t g = ((p[0] & 0x07) << 3) | (p[1] >> 5);
+            uint32_t b = p[1] & 0x1F;
+            sum += (r * 633 + g * 607 + b * 238) >> 8;
+        } else if (fb->format == PIXFORMAT_RGB888) {
+            sum += (p[2] * 77 + p[1] * 150 + p[0] * 29) >> 8;                               // BGR byte order
+        } else {
+            sum += p[0];                                                                    // Gray or Y of YUYV
+        }
+    }
+    return count ? (int)(sum / count) : -1;
+}
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Auto exposure needs a few frames after init. Instead of a     │
+  │       fixed delay, frames are pulled until the mean luma stops      │
+  │       moving or the timeout expires. Formats without a cheap luma   │
+  │       estimate return right away.                                   │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+void HMS_CAM::_settleExposure() {
+    _bootReport.settleFrames = 0;
+    _bootReport.settled      = false;
+
+    sensor_t *s = _sensorGet();
+    if (_settleTimeoutMs == 0 || s == NULL || (!s->status.aec && !s->status.agc && !s->status.awb)) {
+        return;                                                                             // Nothing to wait for
+    }
+
+    HMS_CAM_JPEGWorkspaceTypeDef *work = NULL;                                              // Decoder tables, then the DC map
+    uint8_t *blocks   = NULL;
+    size_t   capacity = 0;
+    if (_active.pixelFormat == PIXFORMAT_JPEG) {
+        capacity = ((resolution[_active.frameSize].width + 7) / 8) * ((resolution[_active.frameSize].height + 7) / 8);
+        work     = (HMS_CAM_JPEGWorkspaceTypeDef *)malloc(sizeof(*work) + capacity);
+        if (!work) {
+            return;
+        }
+        blocks   = (uint8_t *)(work + 1);
+    }
+
+    int64_t  deadline = HMS_CAM_Micros() + (int64_t)_settleTimeoutMs * 1000;
+    int      previous = -1;
+    uint32_t stable   = 0;
+    while (HMS_CAM_Micros() < deadline) {
+        camera_fb_t *fb = _fbGet();
+        if (!fb) {
+            break;
+        }
+        int luma = settleMeanLuma(fb, work, blocks, capacity);
+        _fbReturn(fb);
+        if (luma < 0) {
+            break;
+        }
+
+        if (_bootReport.settleFrames < UINT8_MAX) {
+            _bootReport.settleFrames++;
+        }
+        int step = previous < 0 ? INT32_MAX : (luma > previous ? luma - previous : previous - luma);
+        stable   = step <= HMS_CAM_SETTLE_TOLERANCE ? stable + 1 : 0;
+        previous = luma;
+        if (stable >= HMS_CAM_SETTLE_FRAMES) {
+            _bootReport.settled = true;
+            break;
+        }
+    }
+    free(work);
+
+    HMS_CAM_LOGGER(debug, "Exposure %s after %u frames (mean luma %d)", _bootReport.settled ? "settled" : "not settled",
+                   (unsigned)_bootReport.settleFrames, previous);
+}
+
+void HMS_CAM::_applySensorClock() {
+    sensor_t *s = _sensorGet();
+    if (_minFrameRate == 0 || _sensorDriver == NULL || s == NULL) {
+        return;
+    }
+    if (HMS_CAM_Sensor::applyClock(s, *_sensorDriver, (uint32_t)s->xclk_freq_hz) == HMS_CAM_OK) {
+        HMS_CAM_LOGGER(debug, "%s PLL set for %u fps", _sensorDriver->name, (unsigned)_minFrameRate);
+    }
+}
+
+framesize_t HMS_CAM::_cappedFrameSize(framesize_t size, uint32_t xclkHz) const {
+    if (_minFrameRate == 0 || _sensorDriver == NULL) {
+        return size;
+    }
+
+    framesize_t cap = HMS_CAM_Sensor::maxFrameSizeFor(*_sensorDriver, _minFrameRate, xclkHz);
+    if (cap == FRAMESIZE_INVALID) {
+        cap = _sensorDriver->modes[0].maxFrameSize;                                         // Fastest mode, still below the floor
+    }
+    framesize_t best = FRAMESIZE_INVALID;
+    uint32_t    area = 0;
+    for (int i = 0; i < FRAMESIZE_INVALID; i++) {                                           // Largest size inside both windows
+        const resolution_info_t &r = resolution[i];
+        if (r.width > resolution[size].width || r.height > resolution[size].height ||
+            r.width > resolution[cap].width  || r.height > resolution[cap].height) {
+            continue;
+        }
+        if ((uint32_t)r.width * r.height > area) {
+            area = (uint32_t)r.width * r.height;
+            best = (framesize_t)i;
+        }
+    }
+    return best == FRAMESIZE_INVALID ? size : best;
+}
+
+void HMS_CAM::setMotionDetector(HMS_CAM_Motion *motion, bool gate) {
+    std::lock_guard<std::mutex> guard(_stageLock);
+    _motion     = motion;
+    _motionGate = gate;
+}
+
+void HMS_CAM::setRateControl(const HMS_CAM_RateConfigTypeDef &config, bool enable) {
+    std::lock_guard<std::mutex> guard(_stageLock);
+    _rate.configure(config);
+    _rate.reset(_active.jpegQuality, _active.frameSize, _frameSize, _active.fbBytes);
+    _rateEnabled = enable;
+}
+
+void HMS_CAM::_applyRateControl(size_t bytes, uint32_t latencyUs, int64_t nowUs) {
+    HMS_CAM_RateDecision decision = _rate.update(bytes, latencyUs, nowUs);
+    if (decision == HMS_CAM_RATE_HOLD) {
+        return;
+    }
+
+    sensor_t *s = _sensorGet();
+    if (s == NULL) {
+        return;
+    }
+
+    if (decision == HMS_CAM_RATE_QUALITY_DOWN || decision == HMS_CAM_RATE_QUALITY_UP) {
+        if (s->set_quality(s, _rate.getQuality()) != 0) {
+            HMS_CAM_LOGGER(warn, "Rate control: set_quality(%d) failed", _rate.getQuality());
+            return;
+        }
+        _active.jpegQuality = _rate.getQuality();
+    } else {
+        if (_roiActive) {
+            return;                                                                         // Frame size steps would drop the ROI
+        }
+        if (s->set_framesize(s, _rate.getFrameSize()) != 0) {
+            HMS_CAM_LOGGER(warn, "Rate control: set_framesize(%d) failed", (int)_rate.getFrameSize());
+            return;
+        }
+        _active.frameSize = _rate.getFrameSize();
+        _applySensorClock();
+    }
+    HMS_CAM_LOGGER(debug, "Rate control: quality %d, frame size %d", _active.jpegQuality, (int)_active.frameSize);
+}
+
+bool HMS_CAM::_reserveBuffer() {
+    if (_leases.fetch_add(1) >= _active.fbCount) {                                         // Reserve before fb_get, never block in it
+        _leases.fetch_sub(1);
+        return false;
+    }
+    return true;
+}
+
+static bool captureBackoff(uint32_t ms, int64_t deadlineUs) {
+    if (deadlineUs != HMS_CAM_NO_DEADLINE && HMS_CAM_Micros() + (int64_t)ms * 1000 >= deadlineUs) {
+        return false;                                                                       // No time left for another attempt
+    }
+    HMS_CAM_Delay(ms);
+    return true;
+}
+
+camera_fb_t* HMS_CAM::_acquireFrame(HMS_CAM_FrameBufferTypeDef &frame, int64_t deadlineUs,
+                                    HMS_CAM_StatusTypeDef *status, bool *pending) {
+    bool timed = deadlineUs != HMS_CAM_NO_DEADLINE;
+    HMS_CAM_StatusTypeDef unused;
+    bool idle;
+    status  = status ? status : &unused;
+    pending = pending ? pending : &idle;
+    *status  = HMS_CAM_ERROR;
+    *pending = false;
+
+    // Retry loop for valid frame capture
+    for (int retry = 0; retry < HMS_CAM_CAPTURE_RETRIES; retry++) {
+        if (retry > 0) {
+            _stats.recordRetry();
+        }
+
+        bool inFlight     = false;
+        bool last         = retry == HMS_CAM_CAPTURE_RETRIES - 1;                           // No backoff once retries are spent
+        int64_t start     = HMS_CAM_Micros();
+        HMS_CAM_TRACER(HMS_CAM_TRACE_FB_GET, HMS_CAM_TRACE_BEGIN, retry);
+        camera_fb_t *fb   = timed ? _fbGetUntil(deadlineUs, inFlight) : _fbGet();
+        int64_t now       = HMS_CAM_Micros();
+        HMS_CAM_TRACER(HMS_CAM_TRACE_FB_GET, HMS_CAM_TRACE_END, fb ? fb->len : 0);
+        if (!fb) {
+            if (inFlight || (timed && now >= deadlineUs)) {
+                HMS_CAM_TRACER(HMS_CAM_TRACE_TIMEOUT, HMS_CAM_TRACE_INSTANT, inFlight);
+                *status  = HMS_CAM_TIMEOUT;                                                 // Deadline, not a driver failure
+                *pending = inFlight;
+                return NULL;
+            }
+            HMS_CAM_LOGGER(warn, "Failed to capture frame, retry %d...", retry + 1);
+            _stats.recordFbGetFailure();
+            if (!last && !captureBackoff(HMS_CAM_FB_RETRY_MS, deadlineUs)) {
+                HMS_CAM_TRACER(HMS_CAM_TRACE_TIMEOUT, HMS_CAM_TRACE_INSTANT, 0);
+                *status = HMS_CAM_TIMEOUT;
+                return NULL;
+            }
+            continue;
+        }
+
+        if (_roiActive) {
+            fb->width  = _roi.outWidth;                                                     // The driver reports the init mode
+            fb->height = _roi.outHeight;
+        }
+
+        // Validate JPEG frames: SOI, EOI tail scan and optionally SOF dimensions
+        if (fb->format == PIXFORMAT_JPEG) {                                                 // Requested format may not be applied yet
+            HMS_CAM_JPEGInfoTypeDef info;
+            HMS_CAM_TRACER(HMS_CAM_TRACE_VALIDATE, HMS_CAM_TRACE_BEGIN, fb->len);
+            HMS_CAM_JPEGResult result = HMS_CAM_JPEG::check(fb->buf, fb->len, _jpegCheck, info, fb->width, fb->height);
+            HMS_CAM_TRACER(HMS_CAM_TRACE_VALIDATE, HMS_CAM_TRACE_END, result);
+            if (result != HMS_CAM_JPEG_VALID) {
+                HMS_CAM_LOGGER(warn, "Invalid JPEG frame (%s), retry %d...", HMS_CAM_JPEG::resultName(result), retry + 1);
+                _stats.recordInvalid(result);
+                _fbReturn(fb);
+                if (!last && !captureBackoff(HMS_CAM_RETRY_BACKOFF_MS << retry, deadlineUs)) {  // Give the sensor a frame period
+                    HMS_CAM_TRACER(HMS_CAM_TRACE_TIMEOUT, HMS_CAM_TRACE_INSTANT, 0);
+                    *status = HMS_CAM_TIMEOUT;
+                    return NULL;
+                }
+                continue;
+            }
+            if (info.trimmed) {
+                fb->len = info.length;                                                      // Drop padding after EOI
+                _stats.recordTrim(info.trimmed);
+            }
+        }
+
+        // If we reach here, we have a valid frame or we're not in JPEG mode
+        int64_t sensorUs    = (int64_t)fb->timestamp.tv_sec * 1000000 + fb->timestamp.tv_usec;
+        int64_t latency     = (sensorUs > 0 && sensorUs <= now) ? now - sensorUs : 0;
+
+        frame.buf           = fb->buf;
+        frame.length        = fb->len;
+        frame.width         = fb->width;
+        frame.height        = fb->height;
+        frame.timestampUs   = sensorUs;
+        frame.sequence      = _sequence.fetch_add(1, std::memory_order_relaxed);
+        frame.motion        = 0;
+
+        _stats.recordFrame(fb->len, (uint32_t)(now - start), (uint32_t)latency, frame.sequence, now);
+        {
+            std::lock_guard<std::mutex> guard(_stageLock);                                  // Direct captures run beside the task
+            if (_motion) {
+                HMS_CAM_MotionResultTypeDef motion;
+                if (_motion->process(frame, fb->format, motion) == HMS_CAM_OK) {
+                    frame.motion = motion.sceneReset ? 1000 : motion.score;                // New background: treat as changed
+                }
+            }
+            if (_rateEnabled && fb->format == PIXFORMAT_JPEG) {
+                _applyRateControl(fb->len, (uint32_t)latency, now);
+            }
+        }
+        *status = HMS_CAM_OK;
+        return fb;
+    }
+
+    return NULL;
+}
+
+void HMS_CAM::_releaseLease(camera_fb_t *fb) {
+    HMS_CAM_TRACER(HMS_CAM_TRACE_RETURN, HMS_CAM_TRACE_BEGIN, 0);
+    _fbReturn(fb);
+    HMS_CAM_TRACER(HMS_CAM_TRACE_RETURN, HMS_CAM_TRACE_END, 0);
+    _leases.fetch_sub(1);
+    _taskWake.give();                                                                       // Capture task may wait for a buffer
+}
+
+HMS_CAM_FrameLease::HMS_CAM_FrameLease(HMS_CAM_FrameLease &&other) noexcept
+    : _owner(other._owner), _fb(other._fb), _frame(other._frame) {
+    other._owner = NULL;
+    other._fb    = NULL;
+    other._frame = {};
+}
+
+HMS_CAM_FrameLease& HMS_CAM_FrameLease::operator=(HMS_CAM_FrameLease &&other) noexcept {
+    if (this != &other) {
+        release();
+        _owner       = other._owner;
+        _fb          = other._fb;
+        _frame       = other._frame;
+        other._owner = NULL;
+        other._fb    = NULL;
+        other._frame = {};
+    }
+    return *this;
+}
+
+void HMS_CAM_FrameLease::release() {
+    if (_fb != NULL && _owner != NULL) {
+        _owner->_releaseLease(_fb);
+    }
+    _owner = NULL;
+    _fb    = NULL;
+    _frame = {};
+}
+
+#endif // HMS_CAM_HAS_CAMERA_API
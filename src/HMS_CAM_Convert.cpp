@@ -0,0 +1,573 @@
+#include "HMS_CAM_Convert.h"
+
+#include <string.h>
+#include <stdlib.h>
+
+#if defined(HMS_CAM_PLATFORM_ESP_IDF)
+    #include "esp_heap_caps.h"
+#endif
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Kernel backend selection                                      │
+  │       SSE2 (x86-64 baseline), NEON (AArch64 / ARMv7 + NEON), SWAR   │
+  │       32-bit word tricks on Xtensa. Define HMS_CAM_CONVERT_SCALAR   │
+  │       to build the scalar reference only.                           │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+#if defined(HMS_CAM_CONVERT_SCALAR)
+    // Scalar reference only
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define HMS_CAM_CONVERT_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define HMS_CAM_CONVERT_NEON
+#elif defined(__XTENSA__) || defined(HMS_CAM_CONVERT_FORCE_SWAR)
+    #define HMS_CAM_CONVERT_SWAR
+#endif
+
+bool HMS_CAM_Convert::_accelerated = true;
+
+static inline uint8_t convertExpand5(uint32_t v)            { return (uint8_t)((v << 3) | (v >> 2)); }
+static inline uint8_t convertExpand6(uint32_t v)            { return (uint8_t)((v << 2) | (v >> 4)); }
+static inline uint8_t convertLuma(uint32_t r, uint32_t g, uint32_t b) {
+    return (uint8_t)((77 * r + 150 * g + 29 * b + 128) >> 8);                               // BT.601, 8-bit fixed point
+}
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Scalar reference kernels, `count` in pixels                   │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+static void convertSwapScalar(const uint8_t *src, uint8_t *dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        uint8_t hi = src[2 * i], lo = src[2 * i + 1];
+        dst[2 * i]     = lo;
+        dst[2 * i + 1] = hi;
+    }
+}
+
+static void convert565To888Scalar(const uint8_t *src, uint8_t *dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        uint32_t v = ((uint32_t)src[2 * i] << 8) | src[2 * i + 1];
+        dst[3 * i]     = convertExpand5(v >> 11);
+        dst[3 * i + 1] = convertExpand6((v >> 5) & 0x3F);
+        dst[3 * i + 2] = convertExpand5(v & 0x1F);
+    }
+}
+
+static void convert565ToGrayScalar(const uint8_t *src, uint8_t *dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        uint32_t v = ((uint32_t)src[2 * i] << 8) | src[2 * i + 1];
+        dst[i] = convertLuma(convertExpand5(v >> 11), convertExpand6((v >> 5) & 0x3F), convertExpand5(v & 0x1F));
+    }
+}
+
+static void convertYuvToGrayScalar(const uint8_t *src, uint8_t *dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = src[2 * i];                                                                // YUYV, luma on even bytes
+    }
+}
+
+static void convertDownscaleRowScalar(const uint8_t *src, size_t stride, uint8_t *dst, size_t outWidth,
+                                      size_t channels, size_t factor, HMS_CAM_ScaleMode mode) {
+    size_t first = 0, taps = factor;
+    if (mode == HMS_CAM_SCALE_BILINEAR) {
+        first = factor / 2 - 1;                                                             // Two taps around the block centre
+        taps  = 2;
+    }
+    uint32_t area = (uint32_t)(taps * taps);
+
+    for (size_t x = 0; x < outWidth; x++) {
+        for (size_t c = 0; c < channels; c++) {
+            uint32_t sum = 0;
+            for (size_t dy = 0; dy < taps; dy++) {
+                const uint8_t *row = src + (first + dy) * stride + (x * factor + first) * channels + c;
+                for (size_t dx = 0; dx < taps; dx++) {
+                    sum += row[dx * channels];
+                }
+            }
+            dst[x * channels + c] = (uint8_t)((sum + area / 2) / area);
+        }
+    }
+}
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Accelerated kernels, each handles a prefix and returns the    │
+  │       number of pixels done, the scalar kernel finishes the tail.   │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+#if defined(HMS_CAM_CONVERT_SSE2)
+
+static size_t convertSwapFast(const uint8_t *src, uint8_t *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + 2 * i));
+        _mm_storeu_si128((__m128i *)(dst + 2 * i), _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8)));
+    }
+    return i;
+}
+
+static inline void convertUnpack565(__m128i v, __m128i &r, __m128i &g, __m128i &b) {
+    v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));                          // Big endian to lanes
+    __m128i r5 = _mm_srli_epi16(v, 11);
+    __m128i g6 = _mm_and_si128(_mm_srli_epi16(v, 5), _mm_set1_epi16(0x3F));
+    __m128i b5 = _mm_and_si128(v, _mm_set1_epi16(0x1F));
+    r = _mm_or_si128(_mm_slli_epi16(r5, 3), _mm_srli_epi16(r5, 2));
+    g = _mm_or_si128(_mm_slli_epi16(g6, 2), _mm_srli_epi16(g6, 4));
+    b = _mm_or_si128(_mm_slli_epi16(b5, 3), _mm_srli_epi16(b5, 2));
+}
+
+static size_t convert565To888Fast(const uint8_t *src, uint8_t *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 9 <= count; i += 8) {                                                        // Keep one pixel for the scalar tail,
+        __m128i r, g, b;                                                                    // the 4-byte stores overrun by one byte
+        convertUnpack565(_mm_loadu_si128((const __m128i *)(src + 2 * i)), r, g, b);
+
+        __m128i rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+        uint32_t rgbx[8];
+        _mm_storeu_si128((__m128i *)&rgbx[0], _mm_unpacklo_epi16(rg, b));
+        _mm_storeu_si128((__m128i *)&rgbx[4], _mm_unpackhi_epi16(rg, b));
+        for (int p = 0; p < 8; p++) {
+            memcpy(dst + 3 * (i + p), &rgbx[p], 4);                                         // Little endian: R, G, B, (next R)
+        }
+    }
+    return i;
+}
+
+static size_t convert565ToGrayFast(const uint8_t *src, uint8_t *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i y[2];
+        for (int half = 0; half < 2; half++) {
+            __m128i r, g, b;
+            convertUnpack565(_mm_loadu_si128((const __m128i *)(src + 2 * i + 16 * half)), r, g, b);
+            __m128i sum = _mm_add_epi16(_mm_mullo_epi16(r, _mm_set1_epi16(77)), _mm_mullo_epi16(g, _mm_set1_epi16(150)));
+            sum = _mm_add_epi16(sum, _mm_mullo_epi16(b, _mm_set1_epi16(29)));
+            y[half] = _mm_srli_epi16(_mm_add_epi16(sum, _mm_set1_epi16(128)), 8);
+        }
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(y[0], y[1]));
+    }
+    return i;
+}
+
+static size_t convertYuvToGrayFast(const uint8_t *src, uint8_t *dst, size_t count) {
+    const __m128i mask = _mm_set1_epi16(0x00FF);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i a = _mm_and_si128(_mm_loadu_si128((const __m128i *)(src + 2 * i)), mask);
+        __m128i b = _mm_and_si128(_mm_loadu_si128((const __m128i *)(src + 2 * i + 16)), mask);
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(a, b));
+    }
+    return i;
+}
+
+static inline __m128i convertPairSum(const uint8_t *p) {
+    __m128i v = _mm_loadu_si128((const __m128i *)p);
+    return _mm_add_epi16(_mm_and_si128(v, _mm_set1_epi16(0x00FF)), _mm_srli_epi16(v, 8));
+}
+
+static size_t convertDownscaleGrayFast(const uint8_t *src, size_t stride, uint8_t *dst, size_t outWidth, size_t factor) {
+    size_t x = 0;
+    if (factor == 2) {
+        for (; x + 8 <= outWidth; x += 8) {
+            __m128i sum = _mm_add_epi16(convertPairSum(src + 2 * x), convertPairSum(src + stride + 2 * x));
+            sum = _mm_srli_epi16(_mm_add_epi16(sum, _mm_set1_epi16(2)), 2);
+            _mm_storel_epi64((__m128i *)(dst + x), _mm_packus_epi16(sum, sum));
+        }
+    } else if (factor == 4) {
+        for (; x + 4 <= outWidth; x += 4) {
+            __m128i sum = _mm_setzero_si128();
+            for (size_t dy = 0; dy < 4; dy++) {
+                sum = _mm_add_epi16(sum, convertPairSum(src + dy * stride + 4 * x));
+            }
+            __m128i quad = _mm_madd_epi16(sum, _mm_set1_epi16(1));                          // Adjacent pairs -> 4 x 16 samples
+            quad = _mm_srli_epi32(_mm_add_epi32(quad, _mm_set1_epi32(8)), 4);
+            quad = _mm_packs_epi32(quad, quad);
+            int32_t out = _mm_cvtsi128_si32(_mm_packus_epi16(quad, quad));
+            memcpy(dst + x, &out, 4);
+        }
+    }
+    return x;
+}
+
+#elif defined(HMS_CAM_CONVERT_NEON)
+
+static size_t convertSwapFast(const uint8_t *src, uint8_t *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        vst1q_u8(dst + 2 * i, vrev16q_u8(vld1q_u8(src + 2 * i)));
+    }
+    return i;
+}
+
+static inline void convertUnpack565(const uint8_t *p, uint16x8_t &r, uint16x8_t &g, uint16x8_t &b) {
+    uint16x8_t v  = vreinterpretq_u16_u8(vrev16q_u8(vld1q_u8(p)));                          // Big endian to lanes
+    uint16x8_t r5 = vshrq_n_u16(v, 11);
+    uint16x8_t g6 = vandq_u16(vshrq_n_u16(v, 5), vdupq_n_u16(0x3F));
+    uint16x8_t b5 = vandq_u16(v, vdupq_n_u16(0x1F));
+    r = vorrq_u16(vshlq_n_u16(r5, 3), vshrq_n_u16(r5, 2));
+    g = vorrq_u16(vshlq_n_u16(g6, 2), vshrq_n_u16(g6, 4));
+    b = vorrq_u16(vshlq_n_u16(b5, 3), vshrq_n_u16(b5, 2));
+}
+
+static size_t convert565To888Fast(const uint8_t *src, uint8_t *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        uint16x8_t r, g, b;
+        convertUnpack565(src + 2 * i, r, g, b);
+        uint8x8x3_t rgb = {{ vmovn_u16(r), vmovn_u16(g), vmovn_u16(b) }};
+        vst3_u8(dst + 3 * i, rgb);
+    }
+    return i;
+}
+
+static size_t convert565ToGrayFast(const uint8_t *src, uint8_t *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        uint16x8_t r, g, b;
+        convertUnpack565(src + 2 * i, r, g, b);
+        uint16x8_t sum = vmulq_n_u16(r, 77);
+        sum = vmlaq_n_u16(sum, g, 150);
+        sum = vmlaq_n_u16(sum, b, 29);
+        vst1_u8(dst + i, vshrn_n_u16(vaddq_u16(sum, vdupq_n_u16(128)), 8));
+    }
+    return i;
+}
+
+static size_t convertYuvToGrayFast(const uint8_t *src, uint8_t *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        vst1q_u8(dst + i, vld2q_u8(src + 2 * i).val[0]);
+    }
+    return i;
+}
+
+static size_t convertDownscaleGrayFast(const uint8_t *src, size_t stride, uint8_t *dst, size_t outWidth, size_t factor) {
+    size_t x = 0;
+    if (factor == 2) {
+        for (; x + 8 <= outWidth; x += 8) {
+            uint16x8_t sum = vaddq_u16(vpaddlq_u8(vld1q_u8(src + 2 * x)), vpaddlq_u8(vld1q_u8(src + stride + 2 * x)));
+            vst1_u8(dst + x, vrshrn_n_u16(sum, 2));
+        }
+    } else if (factor == 4) {
+        for (; x + 4 <= outWidth; x += 4) {
+            uint16x8_t sum = vdupq_n_u16(0);
+            for (size_t dy = 0; dy < 4; dy++) {
+                sum = vaddq_u16(sum, vpaddlq_u8(vld1q_u8(src + dy * stride + 4 * x)));
+            }
+            uint16x4_t quad = vrshrn_n_u32(vpaddlq_u16(sum), 4);
+            uint8x8_t  out  = vmovn_u16(vcombine_u16(quad, quad));
+            uint32_t   word = vget_lane_u32(vreinterpret_u32_u8(out), 0);
+            memcpy(dst + x, &word, 4);
+        }
+    }
+    return x;
+}
+
+#elif defined(HMS_CAM_CONVERT_SWAR)
+
+static size_t convertSwapFast(const uint8_t *src, uint8_t *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        uint32_t w;
+        memcpy(&w, src + 2 * i, 4);
+        w = ((w & 0x00FF00FFu) << 8) | ((w >> 8) & 0x00FF00FFu);                            // Swap both halves at once
+        memcpy(dst + 2 * i, &w, 4);
+    }
+    return i;
+}
+
+static size_t convert565To888Fast(const uint8_t *, uint8_t *, size_t) {
+    return 0;
+}
+
+static size_t convert565ToGrayFast(const uint8_t *, uint8_t *, size_t) {
+    return 0;
+}
+
+static size_t convertYuvToGrayFast(const uint8_t *src, uint8_t *dst, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        uint32_t a, b;
+        memcpy(&a, src + 2 * i, 4);
+        memcpy(&b, src + 2 * i + 4, 4);
+        uint32_t y = (a & 0xFFu) | ((a >> 8) & 0xFF00u) | ((b & 0xFFu) << 16) | ((b << 8) & 0xFF000000u);
+        memcpy(dst + i, &y, 4);                                                             // Little endian: Y0 Y1 Y2 Y3
+    }
+    return i;
+}
+
+static size_t convertDownscaleGrayFast(const uint8_t *src, size_t stride, uint8_t *dst, size_t outWidth, size_t factor) {
+    size_t x = 0;
+    if (factor == 2) {
+        for (; x + 2 <= outWidth; x += 2) {
+            uint32_t a, b;
+            memcpy(&a, src + 2 * x, 4);
+            memcpy(&b, src + stride + 2 * x, 4);
+            uint32_t sum = (a & 0x00FF00FFu) + ((a >> 8) & 0x00FF00FFu) +                   // Two 16-bit lanes per word
+                           (b & 0x00FF00FFu) + ((b >> 8) & 0x00FF00FFu) + 0x00020002u;
+            sum = (sum >> 2) & 0x00FF00FFu;
+            dst[x]     = (uint8_t)sum;
+            dst[x + 1] = (uint8_t)(sum >> 16);
+        }
+    }
+    return x;
+}
+
+#endif
+
+static inline size_t convertFast(size_t (*fast)(const uint8_t *, uint8_t *, size_t),
+                                 const uint8_t *src, uint8_t *dst, size_t count) {
+    #if defined(HMS_CAM_CONVERT_SSE2) || defined(HMS_CAM_CONVERT_NEON) || defined(HMS_CAM_CONVERT_SWAR)
+        return HMS_CAM_Convert::isAccelerated() ? fast(src, dst, count) : 0;
+    #else
+        (void)fast; (void)src; (void)dst; (void)count;
+        return 0;
+    #endif
+}
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Argument checks shared by all conversions                     │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+static HMS_CAM_StatusTypeDef convertPrepare(const HMS_CAM_FrameBufferTypeDef &src, HMS_CAM_FrameBufferTypeDef &dst,
+                                            size_t srcBpp, size_t width, size_t height, size_t dstBpp) {
+    if (!src.buf || !dst.buf || src.length < src.width * src.height * srcBpp) {
+        return HMS_CAM_ERROR;
+    }
+    if (dst.length < width * height * dstBpp) {
+        return HMS_CAM_NO_MEM;
+    }
+    return HMS_CAM_OK;
+}
+
+static void convertFinish(const HMS_CAM_FrameBufferTypeDef &src, HMS_CAM_FrameBufferTypeDef &dst,
+                          size_t width, size_t height, size_t bpp) {
+    dst.length      = width * height * bpp;
+    dst.width       = width;
+    dst.height      = height;
+    dst.timestampUs = src.timestampUs;
+    dst.sequence    = src.sequence;
+}
+
+#if defined(HMS_CAM_CONVERT_SSE2) || defined(HMS_CAM_CONVERT_NEON) || defined(HMS_CAM_CONVERT_SWAR)
+    #define HMS_CAM_CONVERT_FAST(fn)            fn##Fast
+#else
+    #define HMS_CAM_CONVERT_FAST(fn)            NULL
+#endif
+
+HMS_CAM_StatusTypeDef HMS_CAM_Convert::swapBytes(const HMS_CAM_FrameBufferTypeDef &src, HMS_CAM_FrameBufferTypeDef &dst) {
+    HMS_CAM_StatusTypeDef status = convertPrepare(src, dst, 2, src.width, src.height, 2);
+    if (status != HMS_CAM_OK) {
+        return status;
+    }
+
+    size_t count = src.width * src.height;
+    size_t done  = convertFast(HMS_CAM_CONVERT_FAST(convertSwap), src.buf, dst.buf, count);
+    convertSwapScalar(src.buf + 2 * done, dst.buf + 2 * done, count - done);
+    convertFinish(src, dst, src.width, src.height, 2);
+    return HMS_CAM_OK;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_Convert::rgb565ToRgb888(const HMS_CAM_FrameBufferTypeDef &src, HMS_CAM_FrameBufferTypeDef &dst) {
+    if (src.buf == dst.buf) {
+        return HMS_CAM_ERROR;                                                               // Output is larger than the input
+    }
+    HMS_CAM_StatusTypeDef status = convertPrepare(src, dst, 2, src.width, src.height, 3);
+    if (status != HMS_CAM_OK) {
+        return status;
+    }
+
+    size_t count = src.width * src.height;
+    size_t done  = convertFast(HMS_CAM_CONVERT_FAST(convert565To888), src.buf, dst.buf, count);
+    convert565To888Scalar(src.buf + 2 * done, dst.buf + 3 * done, count - done);
+    convertFinish(src, dst, src.width, src.height, 3);
+    return HMS_CAM_OK;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_Convert::rgb565ToGray(const HMS_CAM_FrameBufferTypeDef &src, HMS_CAM_FrameBufferTypeDef &dst) {
+    HMS_CAM_StatusTypeDef status = convertPrepare(src, dst, 2, src.width, src.height, 1);
+    if (status != HMS_CAM_OK) {
+        return status;
+    }
+
+    size_t count = src.width * src.height;
+    size_t done  = convertFast(HMS_CAM_CONVERT_FAST(convert565ToGray), src.buf, dst.buf, count);
+    convert565ToGrayScalar(src.buf + 2 * done, dst.buf + done, count - done);
+    convertFinish(src, dst, src.width, src.height, 1);
+    return HMS_CAM_OK;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_Convert::yuv422ToGray(const HMS_CAM_FrameBufferTypeDef &src, HMS_CAM_FrameBufferTypeDef &dst) {
+    HMS_CAM_StatusTypeDef status = convertPrepare(src, dst, 2, src.width, src.height, 1);
+    if (status != HMS_CAM_OK) {
+        return status;
+    }
+
+    size_t count = src.width * src.height;
+    size_t done  = convertFast(HMS_CAM_CONVERT_FAST(convertYuvToGray), src.buf, dst.buf, count);
+    convertYuvToGrayScalar(src.buf + 2 * done, dst.buf + done, count - done);
+    convertFinish(src, dst, src.width, src.height, 1);
+    return HMS_CAM_OK;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_Convert::downscale(const HMS_CAM_FrameBufferTypeDef &src, HMS_CAM_FrameBufferTypeDef &dst,
+                                                 size_t channels, size_t factor, HMS_CAM_ScaleMode mode) {
+    if (channels == 0 || channels > 4 || (factor != 2 && factor != 4)) {
+        return HMS_CAM_ERROR;
+    }
+    if (factor == 2) {
+        mode = HMS_CAM_SCALE_BOX;                                                           // Identical at 2x
+    }
+
+    size_t outWidth  = src.width / factor;
+    size_t outHeight = src.height / factor;
+    HMS_CAM_StatusTypeDef status = convertPrepare(src, dst, channels, outWidth, outHeight, channels);
+    if (status != HMS_CAM_OK) {
+        return status;
+    }
+
+    size_t stride = src.width * channels;
+    for (size_t y = 0; y < outHeight; y++) {
+        const uint8_t *in  = src.buf + y * factor * stride;
+        uint8_t       *out = dst.buf + y * outWidth * channels;
+        size_t done = 0;
+        #if defined(HMS_CAM_CONVERT_SSE2) || defined(HMS_CAM_CONVERT_NEON) || defined(HMS_CAM_CONVERT_SWAR)
+            if (_accelerated && channels == 1 && mode == HMS_CAM_SCALE_BOX) {
+                done = convertDownscaleGrayFast(in, stride, out, outWidth, factor);
+            }
+        #endif
+        convertDownscaleRowScalar(in + done * factor * channels, stride, out + done * channels,
+                                  outWidth - done, channels, factor, mode);
+    }
+
+    convertFinish(src, dst, outWidth, outHeight, channels);
+    return HMS_CAM_OK;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_Convert::crop(const HMS_CAM_FrameBufferTypeDef &src, HMS_CAM_FrameBufferTypeDef &dst,
+                                            size_t bytesPerPixel, size_t x, size_t y, size_t width, size_t height) {
+    if (!src.buf || bytesPerPixel == 0 || width == 0 || height == 0 ||
+        x + width > src.width || y + height > src.height || src.length < src.width * src.height * bytesPerPixel) {
+        return HMS_CAM_ERROR;
+    }
+
+    size_t stride = src.width * bytesPerPixel;
+    size_t row    = width * bytesPerPixel;
+    const uint8_t *first = src.buf + y * stride + x * bytesPerPixel;
+
+    if (dst.buf == NULL) {
+        if (width != src.width) {
+            return HMS_CAM_ERROR;                                                           // Views need contiguous rows
+        }
+        dst.buf = (uint8_t *)first;                                                         // Zero-copy band of full rows
+        convertFinish(src, dst, width, height, bytesPerPixel);
+        return HMS_CAM_OK;
+    }
+    if (dst.length < row * height) {
+        return HMS_CAM_NO_MEM;
+    }
+
+    for (size_t r = 0; r < height; r++) {
+        memmove(dst.buf + r * row, first + r * stride, row);                                // Overlap safe for in-place crops
+    }
+    convertFinish(src, dst, width, height, bytesPerPixel);
+    return HMS_CAM_OK;
+}
+
+const char* HMS_CAM_Convert::getBackend() {
+    #if defined(HMS_CAM_CONVERT_SSE2)
+        return _accelerated ? "SSE2" : "scalar";
+    #elif defined(HMS_CAM_CONVERT_NEON)
+        return _accelerated ? "NEON" : "scalar";
+    #elif defined(HMS_CAM_CONVERT_SWAR)
+        return _accelerated ? "SWAR" : "scalar";
+    #else
+        return "scalar";
+    #endif
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_BufferPool::begin(size_t count, size_t bytes) {
+    end();
+    if (count == 0 || count > HMS_CAM_POOL_MAX_BUFFERS || bytes == 0) {
+        return HMS_CAM_ERROR;
+    }
+
+    size_t stride = (bytes + HMS_CAM_POOL_ALIGNMENT - 1) & ~(size_t)(HMS_CAM_POOL_ALIGNMENT - 1);
+    size_t total  = stride * count + HMS_CAM_POOL_ALIGNMENT;
+
+    #if defined(HMS_CAM_PLATFORM_ESP_IDF)
+        _raw = heap_caps_malloc(total, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (!_raw) {
+            _raw = heap_caps_malloc(total, MALLOC_CAP_8BIT);
+        }
+    #else
+        _raw = malloc(total);
+    #endif
+    if (!_raw) {
+        return HMS_CAM_NO_MEM;
+    }
+
+    uintptr_t base = ((uintptr_t)_raw + HMS_CAM_POOL_ALIGNMENT - 1) & ~(uintptr_t)(HMS_CAM_POOL_ALIGNMENT - 1);
+    _memory = (uint8_t *)base;
+    _count  = count;
+    _bytes  = bytes;
+    _stride = stride;
+    _free.store(count == 32 ? 0xFFFFFFFFu : ((1u << count) - 1));
+    return HMS_CAM_OK;
+}
+
+void HMS_CAM_BufferPool::end() {
+    if (_raw) {
+        #if defined(HMS_CAM_PLATFORM_ESP_IDF)
+            heap_caps_free(_raw);
+        #else
+            free(_raw);
+        #endif
+    }
+    _raw    = NULL;
+    _memory = NULL;
+    _count  = 0;
+    _bytes  = 0;
+    _stride = 0;
+    _free.store(0);
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_BufferPool::acquire(HMS_CAM_FrameBufferTypeDef &frame) {
+    uint32_t mask = _free.load(std::memory_order_relaxed);
+    while (mask) {
+        uint32_t bit = mask & (~mask + 1);                                                  // Lowest free buffer
+        if (_free.compare_exchange_weak(mask, mask & ~bit, std::memory_order_acquire)) {
+            size_t index = 0;
+            while (!(bit & (1u << index))) index++;
+            frame        = {};
+            frame.buf    = _memory + index * _stride;
+            frame.length = _bytes;
+            return HMS_CAM_OK;
+        }
+    }
+    return HMS_CAM_BUSY;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_BufferPool::release(const HMS_CAM_FrameBufferTypeDef &frame) {
+    if (!_memory || frame.buf < _memory || frame.buf >= _memory + _count * _stride) {
+        return HMS_CAM_NOT_FOUND;
+    }
+    size_t index = (size_t)(frame.buf - _memory) / _stride;
+    if (frame.buf != _memory + index * _stride) {
+        return HMS_CAM_NOT_FOUND;
+    }
+    _free.fetch_or(1u << index, std::memory_order_release);
+    return HMS_CAM_OK;
+}
+
+size_t HMS_CAM_BufferPool::getAvailable() const {
+    uint32_t mask  = _free.load(std::memory_order_relaxed);
+    size_t   count = 0;
+    for (; mask; mask &= mask - 1) count++;
+    return count;
+}
@@ -0,0 +1,120 @@
+#include "HMS_CAM.h"
+
+#ifdef HMS_CAM_PLATFORM_DESKTOP
+
+#if defined(__linux__)
+    #include <pthread.h>
+#endif
+
+HMS_CAM_Signal::HMS_CAM_Signal() {
+}
+
+HMS_CAM_Signal::~HMS_CAM_Signal() {
+}
+
+void HMS_CAM_Signal::give() {
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _set = true;
+    }
+    _cond.notify_one();
+}
+
+bool HMS_CAM_Signal::wait(int64_t timeoutUs) {
+    std::unique_lock<std::mutex> guard(_lock);
+    if (!_cond.wait_for(guard, std::chrono::microseconds(timeoutUs), [this] { return _set; })) {
+        return false;
+    }
+    _set = false;
+    return true;
+}
+
+camera_fb_t* HMS_CAM::_fbGet() {
+    return _sim.fbGet();
+}
+
+camera_fb_t* HMS_CAM::_fbGetUntil(int64_t deadlineUs, bool &pending) {
+    pending = false;                                                                        // The simulator stops waiting itself
+    return _sim.fbGet(deadlineUs);
+}
+
+void HMS_CAM::_fbCancel() {
+}
+
+void HMS_CAM::_fbReturn(camera_fb_t *fb) {
+    _sim.fbReturn(fb);
+}
+
+sensor_t* HMS_CAM::_sensorGet() {
+    return _sim.sensorGet();
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM::_startCaptureTask() {
+    _taskAlive.store(true);
+    _taskThread = std::thread([this]() {
+        _captureTaskLoop();
+        _taskAlive.store(false);
+    });
+
+    #if defined(__linux__)
+        pthread_setname_np(_taskThread.native_handle(), _name);                             // Per camera in top / perf
+        if (_taskCore >= 0) {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(_taskCore, &cpus);
+            pthread_setaffinity_np(_taskThread.native_handle(), sizeof(cpus), &cpus);
+        }
+    #endif
+    return HMS_CAM_OK;
+}
+
+void HMS_CAM::_stopCaptureTask() {
+    if (_taskThread.joinable()) {
+        _taskThread.join();
+    }
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM::_initCamera() {
+    HMS_CAM_LOGGER(info, "Initializing simulated camera...");
+    int64_t start = HMS_CAM_Micros();
+    _verifyConnections();
+    _bootReport.verifyUs     = (uint32_t)(HMS_CAM_Micros() - start);
+    _bootReport.initAttempts = 1;
+
+    camera_config_t config;
+
+    config.xclk_freq_hz     = _frequencyHz;
+    config.pixel_format     = _pixelFormat;
+    config.frame_size       = _allocFrameSize();
+    config.jpeg_quality     = _jpegQuality;
+    config.fb_count         = _fbCount;
+    config.fb_location      = _fbLocation;
+    config.grab_mode        = _grabMode;
+
+    HMS_CAM_StatusTypeDef status = _initPlanned(config);
+
+    if (status != HMS_CAM_OK) {
+        HMS_CAM_LOGGER(error, "Simulated camera initialization failed: %d", (int)status);
+        return status;
+    }
+    return HMS_CAM_OK;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM::_driverInit(const camera_config_t &config) {
+    return _sim.init(&config);                                                              // NO_MEM from the simulated heap
+}
+
+void HMS_CAM::_memoryProbe(HMS_CAM_MemoryTypeDef &memory) {
+    _sim.getMemory(memory);
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM::_deinitCamera() {
+    return _sim.deinit();
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM::_verifyConnections() {
+    HMS_CAM_LOGGER(debug, "Simulated camera: no GPIO connections to verify");
+    return HMS_CAM_OK;
+}
+
+#endif // HMS_CAM_PLATFORM_DESKTOP
@@ -2,21 +2,141 @@
 
 #ifdef HMS_CAM_PLATFORM_ESP_IDF 
 
-void HMS_CAM::returnFrameBuffer() {
-    if (_fb != NULL) {
-        esp_camera_fb_return(_fb);
-        _fb = NULL;
+#include "esp_heap_caps.h"
+
+HMS_CAM_Signal::HMS_CAM_Signal() : _handle(xSemaphoreCreateBinaryStatic(&_storage)) {
+}
+
+HMS_CAM_Signal::~HMS_CAM_Signal() {
+    vSemaphoreDelete(_handle);
+}
+
+void HMS_CAM_Signal::give() {
+    xSemaphoreGive(_handle);
+}
+
+bool HMS_CAM_Signal::wait(int64_t timeoutUs) {
+    int64_t    tick  = (int64_t)portTICK_PERIOD_MS * 1000;                                  // Microseconds per tick
+    TickType_t ticks = timeoutUs > 0 ? (TickType_t)((timeoutUs + tick - 1) / tick) : 0;     // Rounded up like _fbGetUntil()
+    return xSemaphoreTake(_handle, ticks) == pdTRUE;
+}
+
+camera_fb_t* HMS_CAM::_fbGet() {
+    return esp_camera_fb_get();
+}
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: esp_camera_fb_get() has no timeout argument, a stalled sensor │
+  │       holds the caller for the driver's own multi-second wait. A    │
+  │       helper task does the blocking call and hands frames over a    │
+  │       one-entry queue, the caller only waits on the queue until its │
+  │       deadline. A fetch that misses the deadline keeps running and  │
+  │       its frame is returned by the next call.                       │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+camera_fb_t* HMS_CAM::_fbGetUntil(int64_t deadlineUs, bool &pending) {
+    pending = false;
+    if (_grabHandle == NULL) {
+        _grabQueue = xQueueCreate(1, sizeof(camera_fb_t*));
+        BaseType_t created = _grabQueue == NULL ? pdFAIL : xTaskCreatePinnedToCore(
+            [](void *arg) {
+                HMS_CAM *cam = static_cast<HMS_CAM*>(arg);
+                for (;;) {
+                    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+                    camera_fb_t *fb = esp_camera_fb_get();
+                    xQueueSend(cam->_grabQueue, &fb, portMAX_DELAY);                        // NULL too, it ends the fetch
+                }
+            },
+            "hms_cam_grab", HMS_CAM_GRAB_STACK_SIZE, this, _taskPriority, &_grabHandle,
+            _taskCore < 0 ? tskNO_AFFINITY : _taskCore
+        );
+        if (created != pdPASS) {
+            HMS_CAM_LOGGER(error, "Failed to start fb_get helper task");
+            _fbCancel();
+            return NULL;
+        }
+    }
+
+    if (!_grabInFlight) {
+        _grabInFlight = true;
+        xTaskNotifyGive(_grabHandle);
+    }
+
+    int64_t     tick  = (int64_t)portTICK_PERIOD_MS * 1000;                                 // Microseconds per tick
+    int64_t     left  = deadlineUs - HMS_CAM_Micros();
+    TickType_t  ticks = left > 0 ? (TickType_t)((left + tick - 1) / tick) : 0;              // Rounded up, a short wait still blocks
+    camera_fb_t *fb   = NULL;
+    if (xQueueReceive(_grabQueue, &fb, ticks) != pdTRUE) {
+        pending = true;
+        return NULL;
+    }
+    _grabInFlight = false;
+    return fb;
+}
+
+void HMS_CAM::_fbCancel() {
+    if (_grabInFlight) {
+        camera_fb_t *fb = NULL;
+        xQueueReceive(_grabQueue, &fb, portMAX_DELAY);                                      // Bounded by the driver timeout
+        if (fb) {
+            esp_camera_fb_return(fb);
+        }
+        _grabInFlight = false;
+    }
+    if (_grabHandle) {
+        vTaskDelete(_grabHandle);
+        _grabHandle = NULL;
+    }
+    if (_grabQueue) {
+        vQueueDelete(_grabQueue);
+        _grabQueue = NULL;
     }
 }
 
-HMS_CAM_StatusTypeDef HMS_CAM::flush() {
-    returnFrameBuffer();
+void HMS_CAM::_fbReturn(camera_fb_t *fb) {
+    esp_camera_fb_return(fb);
+}
+
+sensor_t* HMS_CAM::_sensorGet() {
+    return esp_camera_sensor_get();
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM::_startCaptureTask() {
+    _taskAlive.store(true);
+
+    BaseType_t created = xTaskCreatePinnedToCore(
+        [](void *arg) {
+            HMS_CAM *cam = static_cast<HMS_CAM*>(arg);
+            cam->_captureTaskLoop();
+            cam->_taskAlive.store(false);
+            vTaskDelete(NULL);
+        },
+        _name, HMS_CAM_TASK_STACK_SIZE, this, _taskPriority, &_taskHandle,
+        _taskCore < 0 ? tskNO_AFFINITY : _taskCore
+    );
+
+    if (created != pdPASS) {
+        _taskAlive.store(false);
+        _taskHandle = NULL;
+        return HMS_CAM_NO_MEM;
+    }
     return HMS_CAM_OK;
 }
 
+void HMS_CAM::_stopCaptureTask() {
+    while (_taskAlive.load()) {
+        HMS_CAM_Yield();                                                                    // Task deletes itself after its loop
+    }
+    _taskHandle = NULL;
+}
+
 HMS_CAM_StatusTypeDef HMS_CAM::_initCamera() {
     HMS_CAM_LOGGER(info, "Initializing camera...");
+    int64_t start = HMS_CAM_Micros();
     _verifyConnections();
+    _bootReport.verifyUs     = (uint32_t)(HMS_CAM_Micros() - start);
+    _bootReport.initAttempts = 1;
 
     camera_config_t config;
 
@@ -40,100 +160,70 @@ HMS_CAM_StatusTypeDef HMS_CAM::_initCamera() {
     config.pin_reset        = HMS_CAM_RESET_GPIO_NUM;
     config.xclk_freq_hz     = _frequencyHz;
     config.pixel_format     = _pixelFormat;
-    config.frame_size       = _frameSize;
+    config.frame_size       = _allocFrameSize();
     config.jpeg_quality     = _jpegQuality;
     config.fb_count         = _fbCount; 
     config.fb_location      = _fbLocation;
     config.grab_mode        = _grabMode;
 
-    esp_err_t err = esp_camera_init(&config);                                           // First attempt with current JPEG settings
-    
-    if (err != ESP_OK) {                                                                // If JPEG fails, try with smaller frame size first
-        HMS_CAM_LOGGER(warn, "Camera init failed with %s, trying QQVGA...", esp_err_to_name(err));
-        config.frame_size = FRAMESIZE_QQVGA;
-        err = esp_camera_init(&config);
-    }
-
-    if (err != ESP_OK) {
-        HMS_CAM_LOGGER(error, "Camera initialization failed: %s", esp_err_to_name(err));
-        return HMS_CAM_ERROR;
+    HMS_CAM_StatusTypeDef status = _initPlanned(config);                                    // Sizes, count and region from free memory
+    if (status != HMS_CAM_OK) {
+        HMS_CAM_LOGGER(error, "Camera initialization failed: %d", (int)status);
     }
-
-    return HMS_CAM_OK;
+    return status;
 }
 
-HMS_CAM_StatusTypeDef HMS_CAM::_configureSensor() {
-    sensor_t * s = esp_camera_sensor_get();
-    if (s != NULL) {
-        s->set_brightness(s, 0);                                                        // -2 to 2
-        s->set_contrast(s, 0);                                                          // -2 to 2
-        s->set_saturation(s, 0);                                                        // -2 to 2
-        s->set_special_effect(s, 0);                                                    // 0 - No Effect
-        s->set_whitebal(s, 1);                                                          // Enable white balance
-        s->set_awb_gain(s, 1);                                                          // Enable AWB gain
-        s->set_wb_mode(s, 0);                                                           // Auto white balance
-        s->set_exposure_ctrl(s, 1);                                                     // Enable exposure control
-        s->set_aec2(s, 0);                                                              // Disable AEC2
-        s->set_ae_level(s, 0);                                                          // Auto exposure level
-        s->set_aec_value(s, 300);                                                       // AEC value
-        s->set_gain_ctrl(s, 1);                                                         // Enable gain control
-        s->set_agc_gain(s, 0);                                                          // Auto gain
-        s->set_gainceiling(s, (gainceiling_t)0);                                        // Gain ceiling
-        s->set_bpc(s, 1);                                                               // Enable black pixel correct
-        s->set_wpc(s, 1);                                                               // Enable white pixel correct
-        s->set_raw_gma(s, 1);                                                           // Enable gamma
-        s->set_lenc(s, 1);                                                              // Enable lens correction
-        s->set_hmirror(s, 0);                                                           // No horizontal mirror
-        s->set_vflip(s, 0);                                                             // No vertical flip
-        s->set_dcw(s, 1);                                                               // Enable downsize
-        s->set_colorbar(s, 0);                                                          // Disable color bar
-
-        HMS_CAM_Delay(500);      
-        HMS_CAM_LOGGER(debug, "Camera sensor configured");
+HMS_CAM_StatusTypeDef HMS_CAM::_driverInit(const camera_config_t &config) {
+    esp_err_t err = esp_camera_init(&config);
+    if (err == ESP_OK) {
         return HMS_CAM_OK;
     }
-    return HMS_CAM_ERROR;
+    HMS_CAM_LOGGER(warn, "esp_camera_init failed with %s", esp_err_to_name(err));
+    switch (err) {
+        case ESP_ERR_NOT_FOUND:
+        case ESP_ERR_NOT_SUPPORTED:
+        case ESP_ERR_INVALID_ARG:
+        case ESP_ERR_CAMERA_NOT_DETECTED:
+        case ESP_ERR_CAMERA_NOT_SUPPORTED:
+        case ESP_ERR_CAMERA_FAILED_TO_SET_FRAME_SIZE:
+        case ESP_ERR_CAMERA_FAILED_TO_SET_OUT_FORMAT:
+            return HMS_CAM_ERROR;                                                           // Probe or mode failure, smaller buffers will not help
+        default:
+            return HMS_CAM_NO_MEM;                                                          // Allocation failures are not always ESP_ERR_NO_MEM
+    }
 }
 
-HMS_CAM_StatusTypeDef HMS_CAM::_refreshSettings() {
-    HMS_CAM_LOGGER(info, "Refreshing camera settings...");
-
-    _initialized = false;
-    esp_camera_deinit();
+void HMS_CAM::_memoryProbe(HMS_CAM_MemoryTypeDef &memory) {
+    memory.dramFree     = heap_caps_get_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    memory.dramLargest  = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    memory.psramFree    = heap_caps_get_free_size(MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);         // 0 without PSRAM
+    memory.psramLargest = heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+}
 
-    HMS_CAM_StatusTypeDef status = _initCamera();
-    if (status != HMS_CAM_OK) {
-        HMS_CAM_LOGGER(error, "Camera re-initialization failed");
-        return status;
-    } else {
-        HMS_CAM_LOGGER(info, "Camera re-initialized successfully");
-       _initialized = true;
+HMS_CAM_StatusTypeDef HMS_CAM::_deinitCamera() {
+    esp_err_t err = esp_camera_deinit();
+    if (err != ESP_OK) {
+        HMS_CAM_LOGGER(error, "Camera de-initialization failed: %s", esp_err_to_name(err));
+        return HMS_CAM_ERROR;
     }
-
     return HMS_CAM_OK;
-
 }
 
 HMS_CAM_StatusTypeDef HMS_CAM::_verifyConnections() {
     HMS_CAM_LOGGER(debug, "Verifying camera GPIO connections...");
     
-    gpio_set_direction((gpio_num_t)HMS_CAM_XCLK_GPIO_NUM, GPIO_MODE_OUTPUT);                    // Verify XCLK output
-    gpio_set_level((gpio_num_t)HMS_CAM_XCLK_GPIO_NUM, 1);
-
-    HMS_CAM_Delay(10);
-
-    gpio_set_level((gpio_num_t)HMS_CAM_XCLK_GPIO_NUM, 0);
-    
-    gpio_set_direction((gpio_num_t)HMS_CAM_SIOD_GPIO_NUM, GPIO_MODE_INPUT_OUTPUT_OD);           // Verify I2C lines
-    gpio_set_direction((gpio_num_t)HMS_CAM_SIOC_GPIO_NUM, GPIO_MODE_INPUT_OUTPUT_OD);
-    gpio_set_pull_mode((gpio_num_t)HMS_CAM_SIOD_GPIO_NUM, GPIO_PULLUP_ONLY);
-    gpio_set_pull_mode((gpio_num_t)HMS_CAM_SIOC_GPIO_NUM, GPIO_PULLUP_ONLY);
-    
-    HMS_CAM_LOGGER(
-        debug, "CAM SDA level: %d, CAM SCL level: %d", 
-        gpio_get_level((gpio_num_t)HMS_CAM_SIOD_GPIO_NUM),
-        gpio_get_level((gpio_num_t)HMS_CAM_SIOC_GPIO_NUM)
-    );
+    #if HMS_CAM_DEBUG_ENABLED                                                                   // Driver reconfigures these pins in init
+        gpio_set_direction((gpio_num_t)HMS_CAM_SIOD_GPIO_NUM, GPIO_MODE_INPUT_OUTPUT_OD);       // Verify I2C lines
+        gpio_set_direction((gpio_num_t)HMS_CAM_SIOC_GPIO_NUM, GPIO_MODE_INPUT_OUTPUT_OD);
+        gpio_set_pull_mode((gpio_num_t)HMS_CAM_SIOD_GPIO_NUM, GPIO_PULLUP_ONLY);
+        gpio_set_pull_mode((gpio_num_t)HMS_CAM_SIOC_GPIO_NUM, GPIO_PULLUP_ONLY);
+
+        HMS_CAM_LOGGER(
+            debug, "CAM SDA level: %d, CAM SCL level: %d", 
+            gpio_get_level((gpio_num_t)HMS_CAM_SIOD_GPIO_NUM),
+            gpio_get_level((gpio_num_t)HMS_CAM_SIOC_GPIO_NUM)
+        );
+    #endif
 
     gpio_config_t log_conf = {};
 
@@ -146,51 +236,4 @@ HMS_CAM_StatusTypeDef HMS_CAM::_verifyConnections() {
     return HMS_CAM_OK;
 }
 
-HMS_CAM_StatusTypeDef HMS_CAM::captureFrame(HMS_CAM_FrameBufferTypeDef &frame) {
-    if(!_initialized) {
-        HMS_CAM_LOGGER(error, "Camera not initialized. Call begin() first.");
-        return HMS_CAM_ERROR;
-    }
-
-    frame.buf    = nullptr;
-    frame.length = 0;
-    frame.width  = 0;
-    frame.height = 0;
-
-    // Retry loop for valid frame capture
-    for (int retry = 0; retry < 3; retry++) {
-        if(_fb) {
-            esp_camera_fb_return(_fb);
-            _fb = NULL;
-        }
-        
-        _fb = esp_camera_fb_get();
-        if (!_fb) {
-            HMS_CAM_LOGGER(warn, "Failed to capture frame, retry %d...", retry + 1);
-            HMS_CAM_Delay(50);
-            continue;
-        }
-
-        // Check for valid JPEG header if in JPEG mode
-        if (_pixelFormat == PIXFORMAT_JPEG) {
-            if (_fb->len < 100 || _fb->buf[0] != 0xFF || _fb->buf[1] != 0xD8) {
-                HMS_CAM_LOGGER(warn, "Invalid JPEG frame detected, retrying...");
-                continue;
-            }
-        }
-
-        // If we reach here, we have a valid frame or we're not in JPEG mode
-        frame.buf    = _fb->buf;
-        frame.length = _fb->len;
-        frame.width  = _fb->width;
-        frame.height = _fb->height;
-
-        HMS_CAM_LOGGER(debug, "Frame captured: %ux%u, size: %u bytes", frame.width, frame.height, frame.length);
-        return HMS_CAM_OK;
-    }
-
-    HMS_CAM_LOGGER(error, "Failed to capture valid frame after retries");
-    return HMS_CAM_ERROR;
-}
-
 #endif // HMS_CAM_PLATFORM_ESP_IDF
\ No newline at end of file
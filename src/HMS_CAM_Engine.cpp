@@ -0,0 +1,315 @@
+#include "HMS_CAM.h"
+
+#ifdef HMS_CAM_HAS_CAMERA_API
+
+#include <new>
+
+const HMS_CAM_FrameBufferTypeDef HMS_CAM_FrameView::_empty = {};
+
+void HMS_CAM_SharedFrame::release() {
+    if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        owner->_releaseShared(this);
+    }
+}
+
+HMS_CAM_FrameView::HMS_CAM_FrameView(const HMS_CAM_FrameView &other) : _shared(other._shared) {
+    if (_shared) _shared->retain();
+}
+
+HMS_CAM_FrameView::HMS_CAM_FrameView(HMS_CAM_FrameView &&other) noexcept : _shared(other._shared) {
+    other._shared = NULL;
+}
+
+HMS_CAM_FrameView& HMS_CAM_FrameView::operator=(const HMS_CAM_FrameView &other) {
+    if (this != &other) {
+        if (other._shared) other._shared->retain();
+        release();
+        _shared = other._shared;
+    }
+    return *this;
+}
+
+HMS_CAM_FrameView& HMS_CAM_FrameView::operator=(HMS_CAM_FrameView &&other) noexcept {
+    if (this != &other) {
+        release();
+        _shared       = other._shared;
+        other._shared = NULL;
+    }
+    return *this;
+}
+
+void HMS_CAM_FrameView::release() {
+    if (_shared) {
+        _shared->release();
+        _shared = NULL;
+    }
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_Subscriber::receive(HMS_CAM_FrameView &view, uint32_t timeoutMs) {
+    view.release();
+    if (!_active.load()) {
+        return HMS_CAM_ERROR;
+    }
+
+    int64_t deadline = HMS_CAM_Micros() + (int64_t)timeoutMs * 1000;
+    for (;;) {
+        HMS_CAM_SharedFrame *shared = _take();
+        if (shared) {
+            view._shared = shared;                                                          // Queue reference moves to the view
+            HMS_CAM_TRACER(HMS_CAM_TRACE_RECEIVE, HMS_CAM_TRACE_INSTANT, shared->frame.sequence);
+            _delivered.fetch_add(1, std::memory_order_relaxed);
+            return HMS_CAM_OK;
+        }
+        if (!_active.load()) {
+            return HMS_CAM_ERROR;                                                           // Unsubscribed while waiting
+        }
+        int64_t left = deadline - HMS_CAM_Micros();
+        if (left <= 0) {
+            return HMS_CAM_TIMEOUT;
+        }
+        _ready.wait(left);                                                                  // Woken by _publish()
+    }
+}
+
+bool HMS_CAM_Subscriber::_publish(HMS_CAM_SharedFrame *shared, const std::atomic<bool> &running) {
+    shared->retain();
+
+    if (_policy == HMS_CAM_DROP_LATEST) {
+        HMS_CAM_SharedFrame *old = _latest.exchange(shared, std::memory_order_acq_rel);
+        if (old) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            old->release();
+        }
+        _ready.give();
+        return true;
+    }
+
+    for (;;) {
+        uint32_t head = _head.load(std::memory_order_relaxed);
+        uint32_t tail = _tail.load(std::memory_order_acquire);
+        if (head - tail < HMS_CAM_SUBSCRIBER_DEPTH) {
+            _ring[head % HMS_CAM_SUBSCRIBER_DEPTH] = shared;
+            _head.store(head + 1, std::memory_order_release);
+            _ready.give();
+            return true;
+        }
+        if (!running.load() || !_active.load()) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            shared->release();
+            return false;
+        }
+        _space.wait((int64_t)HMS_CAM_SIGNAL_WAIT_MS * 1000);                                // Back-pressure: woken by _take()
+    }
+}
+
+HMS_CAM_SharedFrame* HMS_CAM_Subscriber::_take() {
+    if (_policy == HMS_CAM_DROP_LATEST) {
+        return _latest.exchange(NULL, std::memory_order_acq_rel);
+    }
+
+    uint32_t tail = _tail.load(std::memory_order_relaxed);
+    if (tail == _head.load(std::memory_order_acquire)) {
+        return NULL;
+    }
+    HMS_CAM_SharedFrame *shared = _ring[tail % HMS_CAM_SUBSCRIBER_DEPTH];
+    _tail.store(tail + 1, std::memory_order_release);
+    _space.give();
+    return shared;
+}
+
+bool HMS_CAM_Subscriber::_reclaim() {
+    if (_policy != HMS_CAM_DROP_LATEST || !_active.load()) {
+        return false;
+    }
+    HMS_CAM_SharedFrame *old = _latest.exchange(NULL, std::memory_order_acq_rel);
+    if (!old) {
+        return false;
+    }
+    _dropped.fetch_add(1, std::memory_order_relaxed);
+    old->release();
+    return true;
+}
+
+void HMS_CAM_Subscriber::_drain() {
+    while (HMS_CAM_SharedFrame *shared = _take()) {
+        shared->release();
+    }
+}
+
+HMS_CAM_Subscriber* HMS_CAM::subscribe(HMS_CAM_DropPolicy policy) {
+    for (HMS_CAM_Subscriber &sub : _subscribers) {
+        bool expected = false;
+        if (!sub._claimed.compare_exchange_strong(expected, true)) {
+            continue;
+        }
+        sub._policy = policy;
+        sub._latest.store(NULL);
+        sub._head.store(0);
+        sub._tail.store(0);
+        sub._delivered.store(0);
+        sub._dropped.store(0);
+        sub._active.store(true);
+        _taskWake.give();
+        HMS_CAM_LOGGER(debug, "Subscriber added (policy %d)", (int)policy);
+        return &sub;
+    }
+
+    HMS_CAM_LOGGER(warn, "No free subscriber slot (max %d)", HMS_CAM_MAX_SUBSCRIBERS);
+    return NULL;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM::unsubscribe(HMS_CAM_Subscriber *subscriber) {
+    if (subscriber < &_subscribers[0] || subscriber >= &_subscribers[HMS_CAM_MAX_SUBSCRIBERS]) {
+        return HMS_CAM_NOT_FOUND;
+    }
+
+    subscriber->_active.store(false);
+    subscriber->_space.give();                                                              // Release a blocked publish
+    subscriber->_ready.give();                                                              // and a blocked receive
+    while (subscriber->_busy.load()) {
+        HMS_CAM_Yield();                                                                    // Let an in-progress publish finish
+    }
+    subscriber->_drain();
+    subscriber->_claimed.store(false);
+    return HMS_CAM_OK;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM::_startEngine() {
+    if (_taskRunning.load()) {
+        return HMS_CAM_OK;
+    }
+
+    if (_sharedCount != _active.fbCount) {
+        if (_leases.load() != 0) {
+            return HMS_CAM_BUSY;                                                            // Old pool entries still referenced
+        }
+        _shared.reset(new (std::nothrow) HMS_CAM_SharedFrame[_active.fbCount]);
+        _sharedCount = _shared ? _active.fbCount : 0;
+        if (!_shared) {
+            HMS_CAM_LOGGER(error, "Failed to allocate shared frame pool");
+            return HMS_CAM_NO_MEM;
+        }
+    }
+
+    _taskRunning.store(true);
+    HMS_CAM_StatusTypeDef status = _startCaptureTask();
+    if (status != HMS_CAM_OK) {
+        _taskRunning.store(false);
+        HMS_CAM_LOGGER(error, "Failed to start capture task");
+        return status;
+    }
+
+    HMS_CAM_LOGGER(info, "Capture task started");
+    return HMS_CAM_OK;
+}
+
+void HMS_CAM::_stopEngine() {
+    if (!_taskRunning.exchange(false)) {
+        return;
+    }
+
+    _taskWake.give();
+    for (HMS_CAM_Subscriber &sub : _subscribers) {
+        sub._space.give();                                                                  // A BLOCK publish rechecks _taskRunning
+    }
+    _stopCaptureTask();
+    for (HMS_CAM_Subscriber &sub : _subscribers) {
+        sub._drain();
+    }
+    if (_requestState.load() == 2) {
+        HMS_CAM_FrameLease lease;
+        _requestState.store(0);
+        _requestCallback(HMS_CAM_ERROR, lease, _requestContext);                            // Never leave a request hanging
+    }
+    HMS_CAM_LOGGER(info, "Capture task stopped");
+}
+
+void HMS_CAM::_captureTaskLoop() {
+    while (_taskRunning.load()) {
+        if (_requestState.load() == 2) {
+            _serveRequest();                                                                // captureFrameAsync() goes first
+        }
+
+        bool subscribed = false;
+        for (HMS_CAM_Subscriber &sub : _subscribers) {
+            subscribed |= sub._active.load();
+        }
+        if (!subscribed) {
+            _taskWake.wait((int64_t)HMS_CAM_SIGNAL_WAIT_MS * 1000);                         // subscribe() or a request
+            continue;
+        }
+
+        if (!_reserveBuffer()) {
+            bool reclaimed = false;                                                         // Take back stale LATEST frames
+            for (HMS_CAM_Subscriber &sub : _subscribers) {
+                reclaimed |= sub._reclaim();
+            }
+            if (!reclaimed) {
+                _taskWake.wait((int64_t)HMS_CAM_SIGNAL_WAIT_MS * 1000);                     // A lease comes back
+            }
+            continue;
+        }
+
+        HMS_CAM_FrameBufferTypeDef frame = {};
+        camera_fb_t *fb = _acquireFrame(frame);
+        if (!fb) {
+            _leases.fetch_sub(1);
+            continue;
+        }
+
+        bool gated = false;
+        {
+            std::lock_guard<std::mutex> guard(_stageLock);                                  // setMotionDetector may swap _motion
+            if (_motion && _motionGate && frame.motion < _motion->getConfig().triggerPermille) {
+                int64_t now       = HMS_CAM_Micros();
+                int64_t keepAlive = (int64_t)_motion->getConfig().keepAliveMs * 1000;
+                if (!keepAlive || now - _lastPublishUs < keepAlive) {
+                    _motion->recordGated();                                                 // Static scene, nothing to publish
+                    gated = true;
+                }
+            }
+        }
+        if (gated) {
+            _releaseLease(fb);
+            continue;
+        }
+        _lastPublishUs = HMS_CAM_Micros();
+
+        HMS_CAM_SharedFrame *shared = NULL;
+        for (size_t i = 0; i < _sharedCount && !shared; i++) {
+            bool expected = false;
+            if (_shared[i].inUse.compare_exchange_strong(expected, true)) {
+                shared = &_shared[i];
+            }
+        }
+        if (!shared) {
+            _releaseLease(fb);                                                              // Cannot happen while budget holds
+            continue;
+        }
+
+        shared->owner           = this;
+        shared->fb              = fb;
+        shared->frame           = frame;
+        shared->refs.store(1);                                                              // Capture task reference
+
+        HMS_CAM_TRACER(HMS_CAM_TRACE_PUBLISH, HMS_CAM_TRACE_INSTANT, frame.sequence);
+        for (HMS_CAM_Subscriber &sub : _subscribers) {
+            sub._busy.store(true);
+            if (sub._active.load()) {
+                sub._publish(shared, _taskRunning);
+            }
+            sub._busy.store(false);
+        }
+        shared->release();
+    }
+}
+
+void HMS_CAM::_releaseShared(HMS_CAM_SharedFrame *shared) {
+    camera_fb_t *fb = shared->fb;
+    shared->fb      = NULL;
+    shared->frame   = {};
+    shared->inUse.store(false);
+    _releaseLease(fb);
+}
+
+#endif // HMS_CAM_HAS_CAMERA_API
@@ -0,0 +1,494 @@
+#include "HMS_CAM_JPEG.h"
+
+#include <string.h>
+
+static bool jpegHuffmanBuild(HMS_CAM_JPEGHuffmanTypeDef &table, const uint8_t *bits, const uint8_t *vals, size_t count) {
+    memset(table.lookup, 0, sizeof(table.lookup));
+    memcpy(table.values, vals, count);
+
+    int32_t code = 0;
+    size_t  k    = 0;
+    for (int len = 1; len <= 16; len++) {
+        table.valOffset[len] = (int32_t)k - code;
+        for (int i = 0; i < bits[len - 1]; i++, k++, code++) {
+            if (code >= (1 << len)) {
+                return false;                                                               // Over-subscribed table
+            }
+            if (len <= 8) {
+                int shift = 8 - len;
+                for (int fill = 0; fill < (1 << shift); fill++) {
+                    table.lookup[(code << shift) | fill] = (uint16_t)((len << 8) | vals[k]);
+                }
+            }
+        }
+        table.maxCode[len] = bits[len - 1] ? code - 1 : -1;
+        code <<= 1;
+    }
+    table.maxCode[17] = 0x7FFFFFFF;                                                         // Sentinel
+    table.present     = true;
+    return true;
+}
+
+class JpegBitReader {
+public:
+    JpegBitReader(const uint8_t *p, const uint8_t *end) : _p(p), _end(end) {}
+
+    uint32_t peek(int n)                                    { _fill(); return _acc >> (32 - n);  }
+    void skip(int n)                                        { _acc <<= n; _bits -= n;            }
+    uint32_t get(int n)                                     { uint32_t v = peek(n); skip(n); return v; }
+    bool overrun() const                                    { return _padding > 8;      }       // Ran past the entropy data
+
+    int decode(const HMS_CAM_JPEGHuffmanTypeDef &h) {
+        uint16_t fast = h.lookup[peek(8)];
+        if (fast) {
+            skip(fast >> 8);
+            return fast & 0xFF;
+        }
+        uint32_t bits = peek(16);
+        for (int len = 9; len <= 16; len++) {
+            int32_t code = (int32_t)(bits >> (16 - len));
+            if (code <= h.maxCode[len]) {
+                skip(len);
+                return h.values[h.valOffset[len] + code];
+            }
+        }
+        skip(16);
+        _padding = 64;                                                                      // Invalid code, treat as corrupt
+        return 0;
+    }
+
+    bool restart() {
+        _acc  = 0;                                                                          // Drop the partial byte
+        _bits = 0;
+        if (_marker && _p + 1 < _end && _p[0] == 0xFF && (_p[1] & 0xF8) == 0xD0) {
+            _p      += 2;
+            _marker  = false;
+            _padding = 0;
+            return true;
+        }
+        return false;
+    }
+
+private:
+    const uint8_t   *_p;
+    const uint8_t   *_end;
+    uint32_t        _acc        = 0;
+    int             _bits       = 0;
+    int             _padding    = 0;                                                        // Zero bytes fed past a marker or the end
+    bool            _marker     = false;
+
+    void _fill() {
+        while (_bits <= 24) {
+            uint32_t byte = 0;
+            if (!_marker && _p < _end) {
+                if (_p[0] != 0xFF) {
+                    byte = *_p++;
+                } else if (_p + 1 < _end && _p[1] == 0x00) {
+                    byte = 0xFF;                                                            // Stuffed byte
+                    _p  += 2;
+                } else {
+                    _marker = true;                                                         // RSTn / EOI: feed zeros
+                }
+            }
+            if (_marker || _p >= _end) {
+                _padding += byte == 0 ? 1 : 0;
+            }
+            _acc  |= byte << (24 - _bits);
+            _bits += 8;
+        }
+    }
+};
+
+static inline int jpegExtend(uint32_t v, int n) {
+    return (int)v < (1 << (n - 1)) ? (int)v - (1 << n) + 1 : (int)v;
+}
+
+HMS_CAM_JPEGResult HMS_CAM_JPEG::check(const uint8_t *buf, size_t len, HMS_CAM_JPEGCheck level,
+                                       HMS_CAM_JPEGInfoTypeDef &info, size_t width, size_t height) {
+    info         = {};
+    info.length  = len;
+
+    if (level == HMS_CAM_JPEG_NONE) {
+        return HMS_CAM_JPEG_VALID;
+    }
+    if (!buf || len < HMS_CAM_JPEG_MIN_LENGTH) {
+        return HMS_CAM_JPEG_TOO_SHORT;
+    }
+    if (buf[0] != 0xFF || buf[1] != 0xD8) {
+        return HMS_CAM_JPEG_NO_SOI;
+    }
+    if (level == HMS_CAM_JPEG_BASIC) {
+        return HMS_CAM_JPEG_VALID;
+    }
+
+    size_t end = findEOI(buf, len);
+    if (end == 0) {
+        return HMS_CAM_JPEG_NO_EOI;
+    }
+    info.length  = end;
+    info.trimmed = len - end;
+    if (level == HMS_CAM_JPEG_EOI) {
+        return HMS_CAM_JPEG_VALID;
+    }
+
+    if (!parseHeader(buf, end, info.width, info.height)) {
+        return HMS_CAM_JPEG_BAD_HEADER;
+    }
+    if ((width && info.width != width) || (height && info.height != height)) {
+        return HMS_CAM_JPEG_SIZE_MISMATCH;
+    }
+    return HMS_CAM_JPEG_VALID;
+}
+
+bool HMS_CAM_JPEG::parseHeader(const uint8_t *buf, size_t len, uint16_t &width, uint16_t &height) {
+    if (!buf || len < 4 || buf[0] != 0xFF || buf[1] != 0xD8) {
+        return false;
+    }
+
+    size_t i = 2;
+    for (int segment = 0; segment < HMS_CAM_JPEG_MAX_SEGMENTS && i + 4 <= len; segment++) {
+        if (buf[i] != 0xFF) {
+            return false;
+        }
+        uint8_t marker = buf[i + 1];
+        if (marker == 0xFF) {
+            i++;                                                                            // Fill byte
+            continue;
+        }
+        if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+            if (i + 9 > len) {
+                return false;
+            }
+            height = (uint16_t)((buf[i + 5] << 8) | buf[i + 6]);
+            width  = (uint16_t)((buf[i + 7] << 8) | buf[i + 8]);
+            return width != 0 && height != 0;
+        }
+        if (marker == 0xDA || marker == 0xD9) {
+            return false;                                                                   // Scan before frame header
+        }
+        i += 2 + ((buf[i + 2] << 8) | buf[i + 3]);
+    }
+    return false;
+}
+
+size_t HMS_CAM_JPEG::findEOI(const uint8_t *buf, size_t len, size_t window) {
+    if (!buf || len < 4) {
+        return 0;
+    }
+
+    // A two-byte marker always covers one of every second index, so half the bytes are tested
+    size_t stop = len > window ? len - window : 1;                                          // Bounded: last `window` bytes only
+    for (size_t i = len - 1; i >= stop; i -= 2) {
+        if (buf[i] == 0xFF && i + 1 < len && buf[i + 1] == 0xD9) {
+            return i + 2;
+        }
+        if (buf[i] == 0xD9 && buf[i - 1] == 0xFF) {
+            return i + 1;
+        }
+        if (i < stop + 2) {
+            break;
+        }
+    }
+    return 0;
+}
+
+size_t HMS_CAM_JPEG::findMarker(const uint8_t *buf, size_t len, size_t from, uint8_t marker) {
+    for (size_t i = from; i + 1 < len; i++) {
+        if (buf[i] == 0xFF && buf[i + 1] == marker) {
+            return i;
+        }
+    }
+    return len;
+}
+
+const char* HMS_CAM_JPEG::resultName(HMS_CAM_JPEGResult result) {
+    switch (result) {
+        case HMS_CAM_JPEG_VALID:            return "valid";
+        case HMS_CAM_JPEG_TOO_SHORT:        return "too_short";
+        case HMS_CAM_JPEG_NO_SOI:           return "no_soi";
+        case HMS_CAM_JPEG_NO_EOI:           return "no_eoi";
+        case HMS_CAM_JPEG_BAD_HEADER:       return "bad_header";
+        case HMS_CAM_JPEG_SIZE_MISMATCH:    return "size_mismatch";
+        default:                            return "unknown";
+    }
+}
+
+static HMS_CAM_StatusTypeDef jpegScanDC(const uint8_t *buf, size_t len, uint8_t *out, size_t capacity, size_t channels,
+                                        HMS_CAM_JPEGThumbnailTypeDef *thumb, uint16_t &blocksX, uint16_t &blocksY,
+                                        HMS_CAM_JPEGWorkspaceTypeDef &work) {
+    blocksX = blocksY = 0;
+    if (!buf || len < 4 || buf[0] != 0xFF || buf[1] != 0xD8) {
+        return HMS_CAM_ERROR;
+    }
+
+    HMS_CAM_JPEGHuffmanTypeDef *dcTables = work.dc, *acTables = work.ac;                    // Caller owned, too big for small stacks
+    uint16_t quant[4][64];                                                                  // Zigzag order, as stored in DQT
+    uint8_t  compId[4]      = {}, compH[4] = {}, compV[4] = {}, compQ[4] = {}, compDc[4] = {}, compAc[4] = {};
+    int      components     = 0;
+    uint16_t width          = 0, height = 0;
+    uint32_t restartInterval = 0;
+    for (int t = 0; t < 2; t++) {
+        dcTables[t].present = acTables[t].present = false;
+    }
+    for (int t = 0; t < 4; t++) {
+        for (int k = 0; k < 64; k++) quant[t][k] = 1;
+    }
+
+    size_t i = 2;
+    while (i + 4 <= len) {
+        if (buf[i] != 0xFF) {
+            return HMS_CAM_ERROR;
+        }
+        uint8_t marker = buf[i + 1];
+        if (marker == 0xFF) {
+            i++;
+            continue;
+        }
+        size_t segment = (size_t)((buf[i + 2] << 8) | buf[i + 3]);
+        size_t start   = i + 4, end = i + 2 + segment;
+        if (segment < 2 || end > len) {
+            return HMS_CAM_ERROR;
+        }
+
+        if (marker == 0xDB) {                                                               // DQT
+            for (size_t p = start; p < end; ) {
+                int precision = buf[p] >> 4, id = buf[p] & 0x03;
+                if (p + 1 + 64 * (precision ? 2 : 1) > end) {
+                    return HMS_CAM_ERROR;
+                }
+                for (int k = 0; k < 64; k++) {
+                    quant[id][k] = precision ? (uint16_t)((buf[p + 1 + 2 * k] << 8) | buf[p + 2 + 2 * k]) : buf[p + 1 + k];
+                }
+                p += 1 + 64 * (precision ? 2 : 1);
+            }
+        } else if (marker == 0xC4) {                                                        // DHT
+            for (size_t p = start; p + 17 <= end; ) {
+                int    cls = buf[p] >> 4, id = buf[p] & 0x0F;
+                size_t count = 0;
+                for (int b = 0; b < 16; b++) count += buf[p + 1 + b];
+                if (id > 1 || count > 256 || p + 17 + count > end) {
+                    return HMS_CAM_ERROR;
+                }
+                HMS_CAM_JPEGHuffmanTypeDef &table = cls ? acTables[id] : dcTables[id];
+                if (!jpegHuffmanBuild(table, &buf[p + 1], &buf[p + 17], count)) {
+                    return HMS_CAM_ERROR;
+                }
+                p += 17 + count;
+            }
+        } else if (marker == 0xC0 || marker == 0xC1) {                                      // SOF0 / SOF1, Huffman sequential
+            if (start + 6 > end || buf[start] != 8) {
+                return HMS_CAM_ERROR;
+            }
+            height     = (uint16_t)((buf[start + 1] << 8) | buf[start + 2]);
+            width      = (uint16_t)((buf[start + 3] << 8) | buf[start + 4]);
+            components = buf[start + 5];
+            if ((components != 1 && components != 3) || start + 6 + 3 * (size_t)components > end) {
+                return HMS_CAM_ERROR;
+            }
+            for (int c = 0; c < components; c++) {
+                compId[c] = buf[start + 6 + c * 3];
+                compH[c]  = buf[start + 7 + c * 3] >> 4;
+                compV[c]  = buf[start + 7 + c * 3] & 0x0F;
+                compQ[c]  = buf[start + 8 + c * 3] & 0x03;
+            }
+        } else if ((marker >= 0xC2 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC)) {
+            return HMS_CAM_ERROR;                                                           // Progressive, lossless, arithmetic
+        } else if (marker == 0xDD) {                                                        // DRI
+            if (start + 2 > end) {
+                return HMS_CAM_ERROR;
+            }
+            restartInterval = (uint32_t)((buf[start] << 8) | buf[start + 1]);
+        } else if (marker == 0xDA) {                                                        // SOS
+            if (start + 1 > end) {
+                return HMS_CAM_ERROR;
+            }
+            int scanComponents = buf[start];
+            if (!components || scanComponents != components) {
+                return HMS_CAM_ERROR;                                                       // Non-interleaved scans unsupported
+            }
+            if (start + 1 + 2 * (size_t)scanComponents + 3 > end) {
+                return HMS_CAM_ERROR;                                                       // Ss, Se, Ah/Al follow the table ids
+            }
+            for (int s = 0; s < scanComponents; s++) {
+                uint8_t id = buf[start + 1 + s * 2], tables = buf[start + 2 + s * 2];
+                if ((tables >> 4) > 1 || (tables & 0x0F) > 1) {
+                    return HMS_CAM_ERROR;                                                   // Baseline: tables 0 and 1
+                }
+                for (int c = 0; c < components; c++) {
+                    if (compId[c] == id) {
+                        compDc[c] = tables >> 4;
+                        compAc[c] = tables & 0x0F;
+                    }
+                }
+            }
+            i = end;
+            break;
+        } else if (marker == 0xD9) {
+            return HMS_CAM_ERROR;
+        }
+        i = end;
+    }
+    if (!width || !height || i >= len) {
+        return HMS_CAM_ERROR;
+    }
+    for (int c = 0; c < components; c++) {
+        if (!dcTables[compDc[c]].present || !acTables[compAc[c]].present || !compH[c] || !compV[c] ||
+            compH[c] > 4 || compV[c] > 4) {
+            return HMS_CAM_ERROR;                                                           // Sampling factors are 1..4
+        }
+    }
+
+    // Grayscale scans are non-interleaved: one block per MCU regardless of sampling
+    int    maxH      = 1, maxV = 1;
+    for (int c = 0; c < components && components > 1; c++) {
+        maxH = compH[c] > maxH ? compH[c] : maxH;
+        maxV = compV[c] > maxV ? compV[c] : maxV;
+    }
+    int    lumaH     = components > 1 ? compH[0] : 1;
+    int    lumaV     = components > 1 ? compV[0] : 1;
+    size_t mcusX     = (width + 8 * maxH - 1) / (8 * maxH);
+    size_t mcusY     = (height + 8 * maxV - 1) / (8 * maxV);
+    size_t outX      = (width + 7) / 8;
+    size_t outY      = (height + 7) / 8;
+    if (components > 1 && (lumaH != maxH || lumaV != maxV)) {
+        return HMS_CAM_ERROR;                                                               // Luma must carry the full resolution
+    }
+    if (out && outX * outY * channels > capacity) {
+        return HMS_CAM_NO_MEM;
+    }
+    bool chroma = channels == 3 && components == 3;
+    bool stats  = thumb != NULL;
+
+    JpegBitReader bits(buf + i, buf + len);
+    int      pred[4]    = {};
+    uint32_t mcuCount   = 0;
+    uint64_t lumaSum    = 0, acSum = 0;
+    uint32_t lumaCount  = 0;
+    uint8_t  lumaMin    = 255, lumaMax = 0;
+    for (size_t my = 0; my < mcusY; my++) {
+        for (size_t mx = 0; mx < mcusX; mx++) {
+            if (restartInterval && mcuCount && mcuCount % restartInterval == 0) {
+                if (!bits.restart()) {
+                    return HMS_CAM_ERROR;
+                }
+                memset(pred, 0, sizeof(pred));
+            }
+            mcuCount++;
+
+            int luma[16];                                                                   // Block means of this MCU, H x V <= 16
+            int chromaSum[3] = {};
+            for (int c = 0; c < components; c++) {
+                const HMS_CAM_JPEGHuffmanTypeDef &dc = dcTables[compDc[c]];
+                const HMS_CAM_JPEGHuffmanTypeDef &ac = acTables[compAc[c]];
+                const uint16_t    *q  = quant[compQ[c]];
+                bool accumulate = stats && c == 0;
+                int blocks = components > 1 ? compH[c] * compV[c] : 1;
+                for (int b = 0; b < blocks; b++) {
+                    int size = bits.decode(dc);
+                    if (size > 11) {
+                        return HMS_CAM_ERROR;
+                    }
+                    pred[c] += size ? jpegExtend(bits.get(size), size) : 0;
+
+                    for (int k = 1; k < 64; ) {                                             // Skip AC coefficients
+                        int rs = bits.decode(ac);
+                        int run = rs >> 4, bitsLen = rs & 0x0F;
+                        if (bitsLen) {
+                            uint32_t v = bits.get(bitsLen);
+                            if (accumulate && k + run < 64) {                               // |AC| for the sharpness estimate
+                                int coef = jpegExtend(v, bitsLen);
+                                acSum   += (uint32_t)(coef < 0 ? -coef : coef) * q[k + run];
+                            }
+                            k += run + 1;
+                        } else if (run == 15) {
+                            k += 16;
+                        } else {
+                            break;                                                          // EOB
+                        }
+                    }
+
+                    if (c > 0) {
+                        chromaSum[c] += (pred[c] * q[0]) / 8;                               // Centred on 0
+                        continue;
+                    }
+                    int mean = 128 + (pred[0] * q[0]) / 8;                                  // DC = 8 x block mean
+                    mean     = mean < 0 ? 0 : mean > 255 ? 255 : mean;
+                    luma[b]  = mean;
+
+                    size_t bx = mx * lumaH + (size_t)(b % lumaH);
+                    size_t by = my * lumaV + (size_t)(b / lumaH);
+                    if (bx >= outX || by >= outY) {
+                        luma[b] = -1;                                                       // Padding block past the edge
+                        continue;
+                    }
+                    if (stats) {
+                        lumaSum += (uint32_t)mean;
+                        lumaCount++;
+                        lumaMin = mean < lumaMin ? (uint8_t)mean : lumaMin;
+                        lumaMax = mean > lumaMax ? (uint8_t)mean : lumaMax;
+                        thumb->histogram[(mean * HMS_CAM_JPEG_HISTOGRAM_BINS) >> 8]++;
+                    }
+                    if (out && channels == 1) {
+                        out[by * outX + bx] = (uint8_t)mean;
+                    }
+                }
+            }
+
+            if (out && channels == 3) {                                                     // Color once the MCU's chroma is in
+                int blocks = components > 1 ? lumaH * lumaV : 1;
+                int cb     = chroma ? chromaSum[1] / (compH[1] * compV[1]) : 0;             // One chroma value per MCU
+                int cr     = chroma ? chromaSum[2] / (compH[2] * compV[2]) : 0;
+                for (int b = 0; b < blocks; b++) {
+                    if (luma[b] < 0) {
+                        continue;
+                    }
+                    int y  = luma[b];                                                       // BT.601 full range, 8.8 fixed point
+                    int r  = y + ((359 * cr) >> 8);
+                    int g  = y - ((88 * cb + 183 * cr) >> 8);
+                    int bl = y + ((454 * cb) >> 8);
+                    uint8_t *pixel = out + ((my * lumaV + (size_t)(b / lumaH)) * outX + mx * lumaH + (size_t)(b % lumaH)) * 3;
+                    pixel[0] = (uint8_t)(r  < 0 ? 0 : r  > 255 ? 255 : r);
+                    pixel[1] = (uint8_t)(g  < 0 ? 0 : g  > 255 ? 255 : g);
+                    pixel[2] = (uint8_t)(bl < 0 ? 0 : bl > 255 ? 255 : bl);
+                }
+            }
+            if (bits.overrun()) {
+                return HMS_CAM_ERROR;                                                       // Truncated entropy data
+            }
+        }
+    }
+
+    blocksX = (uint16_t)outX;
+    blocksY = (uint16_t)outY;
+    if (stats) {
+        thumb->blocksX   = blocksX;
+        thumb->blocksY   = blocksY;
+        thumb->channels  = (uint8_t)channels;
+        thumb->mean      = lumaCount ? (uint8_t)((lumaSum + lumaCount / 2) / lumaCount) : 0;
+        thumb->min       = lumaCount ? lumaMin : 0;
+        thumb->max       = lumaMax;
+        thumb->sharpness = lumaCount ? (uint32_t)(acSum / lumaCount) : 0;
+    }
+    return HMS_CAM_OK;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_JPEG::dcLuma(const uint8_t *buf, size_t len, uint8_t *out, size_t capacity,
+                                           uint16_t &blocksX, uint16_t &blocksY, HMS_CAM_JPEGWorkspaceTypeDef &work) {
+    if (!out) {
+        blocksX = blocksY = 0;
+        return HMS_CAM_NO_MEM;
+    }
+    return jpegScanDC(buf, len, out, capacity, 1, NULL, blocksX, blocksY, work);
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_JPEG::thumbnail(const uint8_t *buf, size_t len, uint8_t *out, size_t capacity,
+                                              HMS_CAM_JPEGThumbnailTypeDef &thumb, HMS_CAM_JPEGWorkspaceTypeDef &work,
+                                              bool color) {
+    thumb = {};
+    uint16_t blocksX, blocksY;
+    HMS_CAM_StatusTypeDef status = jpegScanDC(buf, len, out, capacity, color ? 3 : 1, &thumb, blocksX, blocksY, work);
+    if (status != HMS_CAM_OK) {
+        thumb = {};                                                                         // No partial histogram
+    }
+    return status;
+}
@@ -0,0 +1,272 @@
+#include "HMS_CAM_Motion.h"
+
+#ifdef HMS_CAM_HAS_CAMERA_API
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(HMS_CAM_PLATFORM_ESP_IDF)
+    #include "esp_heap_caps.h"
+#endif
+
+static inline uint32_t motionLuma565(const uint8_t *p) {
+    uint32_t r = p[0] >> 3;                                                                 // Big endian RGB565
+    uint32_t g = ((p[0] & 0x07) << 3) | (p[1] >> 5);
+    uint32_t b = p[1] & 0x1F;
+    return (r * 633 + g * 607 + b * 238) >> 8;                                              // BT.601 weights on 5/6 bit input
+}
+
+HMS_CAM_MotionConfigTypeDef HMS_CAM_Motion::defaultConfig() {
+    HMS_CAM_MotionConfigTypeDef config = {};
+    config.cellSize         = 16;
+    config.threshold        = 12;
+    config.triggerPermille  = 10;
+    config.resetPermille    = 800;
+    config.learnShift       = 4;
+    config.learnShiftMoving = 7;
+    config.earlyExit        = false;
+    config.keepAliveMs      = 5000;
+    return config;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_Motion::begin(size_t maxWidth, size_t maxHeight, const HMS_CAM_MotionConfigTypeDef &config) {
+    end();
+    if (!maxWidth || !maxHeight || (config.cellSize != 8 && config.cellSize != 16 && config.cellSize != 32)) {
+        return HMS_CAM_ERROR;
+    }
+
+    _config    = config;
+    _maxCells  = ((maxWidth + config.cellSize - 1) / config.cellSize) * ((maxHeight + config.cellSize - 1) / config.cellSize);
+    _maxBlocks = ((maxWidth + 7) / 8) * ((maxHeight + 7) / 8);
+    size_t total = sizeof(HMS_CAM_JPEGWorkspaceTypeDef) + _maxCells * sizeof(uint16_t) + _maxCells * 2 + _maxBlocks;
+
+    #if defined(HMS_CAM_PLATFORM_ESP_IDF)
+        _raw = heap_caps_malloc(total, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);              // Touched every frame, prefer DRAM
+        if (!_raw) {
+            _raw = heap_caps_malloc(total, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        }
+    #else
+        _raw = malloc(total);
+    #endif
+    if (!_raw) {
+        _maxCells = _maxBlocks = 0;
+        return HMS_CAM_NO_MEM;
+    }
+
+    _jpegWork   = (HMS_CAM_JPEGWorkspaceTypeDef *)_raw;
+    _background = (uint16_t *)(_jpegWork + 1);
+    _cells      = (uint8_t *)(_background + _maxCells);
+    _previous   = _cells + _maxCells;
+    _blocks     = _previous + _maxCells;
+    _seeded     = false;
+    _frames.store(0);
+    _motionFrames.store(0);
+    _gated.store(0);
+    _sceneResets.store(0);
+    _errors.store(0);
+    return HMS_CAM_OK;
+}
+
+void HMS_CAM_Motion::end() {
+    if (_raw) {
+        #if defined(HMS_CAM_PLATFORM_ESP_IDF)
+            heap_caps_free(_raw);
+        #else
+            free(_raw);
+        #endif
+    }
+    _raw        = NULL;
+    _jpegWork   = NULL;
+    _background = NULL;
+    _cells      = NULL;
+    _previous   = NULL;
+    _blocks     = NULL;
+    _maxCells   = 0;
+    _maxBlocks  = 0;
+    _cellsX     = 0;
+    _cellsY     = 0;
+    _seeded     = false;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_Motion::process(const HMS_CAM_FrameBufferTypeDef &frame, pixformat_t format,
+                                              HMS_CAM_MotionResultTypeDef &result) {
+    result = {};
+    if (!_raw) {
+        return HMS_CAM_ERROR;
+    }
+
+    size_t previousX = _cellsX, previousY = _cellsY;
+    HMS_CAM_StatusTypeDef status = _reduce(frame, format);
+    if (status != HMS_CAM_OK) {
+        _errors.fetch_add(1, std::memory_order_relaxed);
+        return status;
+    }
+    _frames.fetch_add(1, std::memory_order_relaxed);
+
+    if (!_seeded || _cellsX != previousX || _cellsY != previousY) {
+        _seed();                                                                            // First frame or new frame size
+        result.sceneReset = true;
+        return HMS_CAM_OK;
+    }
+
+    size_t   total    = _cellsX * _cellsY;
+    uint32_t trigger  = (uint32_t)((total * _config.triggerPermille + 999) / 1000);
+    uint32_t changed  = 0;
+    size_t   minX     = _cellsX, minY = _cellsY, maxX = 0, maxY = 0;
+    trigger = trigger ? trigger : 1;
+
+    for (size_t cy = 0; cy < _cellsY && !result.partial; cy++) {
+        const uint8_t *cells      = &_cells[cy * _cellsX];
+        uint8_t       *previous   = &_previous[cy * _cellsX];
+        uint16_t      *background = &_background[cy * _cellsX];
+        for (size_t cx = 0; cx < _cellsX; cx++) {
+            int32_t current = cells[cx];
+            int32_t model   = background[cx];
+            int32_t diff    = current - (model >> 8);
+            int32_t step    = current - previous[cx];
+            int     shift   = _config.learnShift;
+            previous[cx]    = (uint8_t)current;
+
+            if (diff > _config.threshold || -diff > _config.threshold) {
+                changed++;
+                minX  = cx < minX ? cx : minX;
+                maxX  = cx > maxX ? cx : maxX;
+                minY  = cy < minY ? cy : minY;
+                maxY  = cy;
+                if (step > _config.threshold || -step > _config.threshold) {
+                    shift = _config.learnShiftMoving;                                       // Keep moving objects out of the model
+                }
+            }
+            background[cx] = (uint16_t)(model + (((current << 8) - model) >> shift));
+
+            if (_config.earlyExit && changed >= trigger) {
+                result.partial = true;                                                      // Remaining cells learn next frame
+                break;
+            }
+        }
+    }
+
+    result.changedCells = changed;
+    result.score        = (uint16_t)((uint64_t)changed * 1000 / total);
+    result.motion       = result.score >= _config.triggerPermille && changed > 0;
+    if (changed) {
+        size_t cell     = _config.cellSize;
+        size_t right    = (maxX + 1) * cell < frame.width  ? (maxX + 1) * cell : frame.width;
+        size_t bottom   = (maxY + 1) * cell < frame.height ? (maxY + 1) * cell : frame.height;
+        result.x        = (uint16_t)(minX * cell);
+        result.y        = (uint16_t)(minY * cell);
+        result.width    = (uint16_t)(right  > result.x ? right  - result.x : 0);
+        result.height   = (uint16_t)(bottom > result.y ? bottom - result.y : 0);
+    }
+
+    if (!result.partial && result.score >= _config.resetPermille) {
+        _seed();                                                                            // Lighting change, start over
+        result.sceneReset = true;
+        _sceneResets.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (result.motion) {
+        _motionFrames.fetch_add(1, std::memory_order_relaxed);
+    }
+    return HMS_CAM_OK;
+}
+
+void HMS_CAM_Motion::getStats(HMS_CAM_MotionStatsTypeDef &stats) const {
+    stats.frames        = _frames.load(std::memory_order_relaxed);
+    stats.motionFrames  = _motionFrames.load(std::memory_order_relaxed);
+    stats.gatedFrames   = _gated.load(std::memory_order_relaxed);
+    stats.sceneResets   = _sceneResets.load(std::memory_order_relaxed);
+    stats.errors        = _errors.load(std::memory_order_relaxed);
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_Motion::_reduce(const HMS_CAM_FrameBufferTypeDef &frame, pixformat_t format) {
+    size_t cell = _config.cellSize;
+    if (!frame.buf || !frame.width || !frame.height) {
+        return HMS_CAM_ERROR;
+    }
+
+    if (format == PIXFORMAT_JPEG) {
+        uint16_t blocksX, blocksY;
+        HMS_CAM_StatusTypeDef status = HMS_CAM_JPEG::dcLuma(frame.buf, frame.length, _blocks, _maxBlocks, blocksX, blocksY,
+                                                            *_jpegWork);
+        if (status != HMS_CAM_OK) {
+            return status;
+        }
+
+        size_t factor = cell / 8;                                                           // 8x8 blocks per cell edge
+        size_t cellsX = (blocksX + factor - 1) / factor;
+        size_t cellsY = (blocksY + factor - 1) / factor;
+        if (cellsX * cellsY > _maxCells) {
+            return HMS_CAM_NO_MEM;
+        }
+        for (size_t cy = 0; cy < cellsY; cy++) {
+            size_t y1 = (cy + 1) * factor < blocksY ? (cy + 1) * factor : blocksY;
+            for (size_t cx = 0; cx < cellsX; cx++) {
+                size_t   x1  = (cx + 1) * factor < blocksX ? (cx + 1) * factor : blocksX;
+                uint32_t sum = 0, count = 0;
+                for (size_t by = cy * factor; by < y1; by++) {
+                    for (size_t bx = cx * factor; bx < x1; bx++, count++) {
+                        sum += _blocks[by * blocksX + bx];
+                    }
+                }
+                _cells[cy * cellsX + cx] = (uint8_t)(sum / count);
+            }
+        }
+        _cellsX = cellsX;
+        _cellsY = cellsY;
+        return HMS_CAM_OK;
+    }
+
+    size_t bytesPerPixel;
+    switch (format) {
+        case PIXFORMAT_GRAYSCALE:   bytesPerPixel = 1;  break;
+        case PIXFORMAT_YUV422:
+        case PIXFORMAT_RGB565:      bytesPerPixel = 2;  break;
+        default:                    return HMS_CAM_ERROR;
+    }
+    if (frame.length < frame.width * frame.height * bytesPerPixel) {
+        return HMS_CAM_ERROR;
+    }
+
+    size_t cellsX = (frame.width + cell - 1) / cell;
+    size_t cellsY = (frame.height + cell - 1) / cell;
+    if (cellsX * cellsY > _maxCells) {
+        return HMS_CAM_NO_MEM;
+    }
+
+    size_t stride = frame.width * bytesPerPixel;
+    for (size_t cy = 0; cy < cellsY; cy++) {
+        size_t y0 = cy * cell;
+        size_t y1 = y0 + cell < frame.height ? y0 + cell : frame.height;
+        for (size_t cx = 0; cx < cellsX; cx++) {
+            size_t   x0  = cx * cell;
+            size_t   x1  = x0 + cell < frame.width ? x0 + cell : frame.width;
+            uint32_t sum = 0;
+            for (size_t y = y0; y < y1; y++) {
+                const uint8_t *row = frame.buf + y * stride + x0 * bytesPerPixel;
+                size_t count = x1 - x0;
+                if (format == PIXFORMAT_GRAYSCALE) {
+                    for (size_t x = 0; x < count; x++) sum += row[x];
+                } else if (format == PIXFORMAT_YUV422) {
+                    for (size_t x = 0; x < count; x++) sum += row[x * 2];                   // Y of YUYV
+                } else {
+                    for (size_t x = 0; x < count; x++) sum += motionLuma565(row + x * 2);
+                }
+            }
+            _cells[cy * cellsX + cx] = (uint8_t)(sum / ((y1 - y0) * (x1 - x0)));
+        }
+    }
+    _cellsX = cellsX;
+    _cellsY = cellsY;
+    return HMS_CAM_OK;
+}
+
+void HMS_CAM_Motion::_seed() {
+    size_t total = _cellsX * _cellsY;
+    for (size_t i = 0; i < total; i++) {
+        _background[i] = (uint16_t)(_cells[i] << 8);
+    }
+    memcpy(_previous, _cells, total);
+    _seeded = true;
+}
+
+#endif // HMS_CAM_HAS_CAMERA_API
@@ -0,0 +1,115 @@
+#include "HMS_CAM_Planner.h"
+
+#ifdef HMS_CAM_HAS_CAMERA_API
+
+static size_t plannerArea(framesize_t size) {
+    return (size_t)resolution[size].width * resolution[size].height;
+}
+
+static size_t plannerLadder(framesize_t top, framesize_t floor, framesize_t *ladder) {
+    size_t minArea = floor < FRAMESIZE_INVALID ? plannerArea(floor) : 0;
+    size_t count   = 0;
+    for (int i = 0; i < FRAMESIZE_INVALID; i++) {
+        framesize_t size = (framesize_t)i;
+        size_t      area = plannerArea(size);
+        if (size != top && (area >= plannerArea(top) || area < minArea ||
+                            resolution[size].width * resolution[top].height != resolution[size].height * resolution[top].width)) {
+            continue;                                                                       // Larger, too small or other aspect
+        }
+        size_t pos = count++;
+        while (pos > 0 && plannerArea(ladder[pos - 1]) < area) {                            // Insertion sort, largest first
+            ladder[pos] = ladder[pos - 1];
+            pos--;
+        }
+        ladder[pos] = size;
+    }
+    return count;
+}
+
+size_t HMS_CAM_Planner::bufferBytes(size_t width, size_t height, pixformat_t format) {
+    size_t pixels = width * height;
+    switch (format) {
+        case PIXFORMAT_JPEG:        return pixels / 5;                                      // esp32-camera JPEG allocation
+        case PIXFORMAT_GRAYSCALE:   return pixels;
+        case PIXFORMAT_RGB888:      return pixels * 3;
+        case PIXFORMAT_YUV420:      return pixels * 3 / 2;
+        default:                    return pixels * 2;
+    }
+}
+
+size_t HMS_CAM_Planner::bufferBytes(framesize_t size, pixformat_t format) {
+    return bufferBytes(resolution[size].width, resolution[size].height, format);
+}
+
+size_t HMS_CAM_Planner::worstCaseBytes(framesize_t size, pixformat_t format, int jpegQuality) {
+    if (format != PIXFORMAT_JPEG) {
+        return bufferBytes(size, format);
+    }
+    size_t quality = jpegQuality < 2 ? 2 : jpegQuality > 63 ? 63 : (size_t)jpegQuality;
+    return plannerArea(size) * HMS_CAM_PLAN_JPEG_QUALITY_REF / (5 * quality) + HMS_CAM_PLAN_JPEG_HEADER;
+}
+
+const char* HMS_CAM_Planner::regionName(camera_fb_location_t location) {
+    return location == CAMERA_FB_IN_PSRAM ? "PSRAM" : "DRAM";
+}
+
+bool HMS_CAM_Planner::fits(const HMS_CAM_MemoryTypeDef &memory, camera_fb_location_t location, size_t bytes, size_t count) {
+    size_t dramReserved = HMS_CAM_PLAN_DMA_BYTES + HMS_CAM_PLAN_DRAM_RESERVE;
+    if (memory.dramFree < dramReserved) {
+        return false;                                                                       // No room for the DMA buffers
+    }
+    if (location == CAMERA_FB_IN_PSRAM) {
+        return bytes <= memory.psramLargest && bytes * count <= memory.psramFree;
+    }
+    return bytes <= memory.dramLargest && bytes * count <= memory.dramFree - dramReserved;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_Planner::plan(const HMS_CAM_PlanRequestTypeDef &request, const HMS_CAM_MemoryTypeDef &memory,
+                                            HMS_CAM_PlanTypeDef &plan, uint16_t fromStep) {
+    plan = {};
+    if (request.frameSize >= FRAMESIZE_INVALID) {
+        return HMS_CAM_ERROR;
+    }
+
+    framesize_t ladder[FRAMESIZE_INVALID];
+    size_t      sizes   = plannerLadder(request.frameSize, request.minFrameSize, ladder);
+    size_t      wanted  = request.fbCount ? request.fbCount : 1;
+    camera_fb_location_t regions[2] = {
+        request.fbLocation,
+        request.fbLocation == CAMERA_FB_IN_PSRAM ? CAMERA_FB_IN_DRAM : CAMERA_FB_IN_PSRAM
+    };
+
+    uint16_t step = 0;
+    for (size_t s = 0; s < sizes; s++) {
+        size_t bytes = bufferBytes(ladder[s], request.pixelFormat);
+        for (size_t count = wanted; count >= 1; count--) {
+            for (camera_fb_location_t region : regions) {
+                if (step++ < fromStep || !fits(memory, region, bytes, count)) {
+                    continue;
+                }
+                plan.frameSize  = ladder[s];
+                plan.fbCount    = count;
+                plan.fbLocation = region;
+                plan.fbBytes    = bytes;
+                plan.worstBytes = worstCaseBytes(ladder[s], request.pixelFormat, request.jpegQuality);
+                plan.step       = (uint16_t)(step - 1);
+                plan.degraded   = ladder[s] != request.frameSize || count != wanted || region != request.fbLocation;
+                return HMS_CAM_OK;
+            }
+        }
+    }
+
+    HMS_CAM_LOGGER(
+        error, "No frame buffer plan fits: %ux%u needs %u B x %u in %s, down to %ux%u at %u B x 1; "
+               "DRAM %u B free (largest %u B, %u B reserved), PSRAM %u B free (largest %u B)",
+        resolution[request.frameSize].width, resolution[request.frameSize].height,
+        (unsigned)bufferBytes(request.frameSize, request.pixelFormat), (unsigned)wanted, regionName(request.fbLocation),
+        resolution[ladder[sizes - 1]].width, resolution[ladder[sizes - 1]].height,
+        (unsigned)bufferBytes(ladder[sizes - 1], request.pixelFormat),
+        (unsigned)memory.dramFree, (unsigned)memory.dramLargest, (unsigned)(HMS_CAM_PLAN_DMA_BYTES + HMS_CAM_PLAN_DRAM_RESERVE),
+        (unsigned)memory.psramFree, (unsigned)memory.psramLargest
+    );
+    return HMS_CAM_NO_MEM;
+}
+
+#endif // HMS_CAM_HAS_CAMERA_API
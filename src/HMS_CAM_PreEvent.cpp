@@ -0,0 +1,347 @@
+#include "HMS_CAM.h"
+#include "HMS_CAM_PreEvent.h"
+
+#ifdef HMS_CAM_HAS_CAMERA_API
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(HMS_CAM_PLATFORM_ESP_IDF)
+    #include "esp_heap_caps.h"
+#endif
+
+#define PREEVENT_INDEX_BATCH    16                                                          // Index entries per sink call
+
+static void preEventPut32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;          p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);  p[3] = (uint8_t)(v >> 24);
+}
+
+static void preEventPut64(uint8_t *p, uint64_t v) {
+    preEventPut32(p, (uint32_t)v);
+    preEventPut32(p + 4, (uint32_t)(v >> 32));
+}
+
+static int32_t preEventFileSink(const HMS_CAM_IOVecTypeDef *iov, size_t count, void *context) {
+    FILE *file = (FILE *)context;
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (fwrite(iov[i].base, 1, iov[i].length, file) != iov[i].length) {
+            return -1;                                                                      // Card full or removed
+        }
+        total += iov[i].length;
+    }
+    return total > INT32_MAX ? INT32_MAX : (int32_t)total;
+}
+
+static void preEventFree(void *ptr) {
+    #if defined(HMS_CAM_PLATFORM_ESP_IDF)
+        heap_caps_free(ptr);
+    #else
+        free(ptr);
+    #endif
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_PreEvent::begin(HMS_CAM &camera, size_t arenaBytes, size_t maxFrames) {
+    HMS_CAM_StatusTypeDef status = begin(arenaBytes, maxFrames);
+    if (status != HMS_CAM_OK) {
+        return status;
+    }
+
+    _subscriber = camera.subscribe(HMS_CAM_DROP_LATEST);
+    if (!_subscriber) {
+        end();
+        return HMS_CAM_BUSY;
+    }
+    _camera = &camera;
+
+    if (!camera.isCaptureTaskRunning()) {
+        HMS_CAM_LOGGER(warn, "Capture task not running, pre-event recorder waits for frames");
+    }
+    return HMS_CAM_OK;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_PreEvent::begin(size_t arenaBytes, size_t maxFrames) {
+    end();
+    if (!arenaBytes || !maxFrames || arenaBytes > UINT32_MAX / 2) {                         // Flushed offsets stay 32 bit
+        return HMS_CAM_ERROR;
+    }
+
+    #if defined(HMS_CAM_PLATFORM_ESP_IDF)
+        _arena = (uint8_t *)heap_caps_malloc(arenaBytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (!_arena) {
+            _arena = (uint8_t *)heap_caps_malloc(arenaBytes, MALLOC_CAP_8BIT);
+        }
+        _index = (HMS_CAM_PreEventEntryTypeDef *)heap_caps_malloc(maxFrames * sizeof(HMS_CAM_PreEventEntryTypeDef),
+                                                                  MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (!_index) {
+            _index = (HMS_CAM_PreEventEntryTypeDef *)heap_caps_malloc(maxFrames * sizeof(HMS_CAM_PreEventEntryTypeDef),
+                                                                      MALLOC_CAP_8BIT);
+        }
+    #else
+        _arena = (uint8_t *)malloc(arenaBytes);
+        _index = (HMS_CAM_PreEventEntryTypeDef *)malloc(maxFrames * sizeof(HMS_CAM_PreEventEntryTypeDef));
+    #endif
+    if (!_arena || !_index) {
+        HMS_CAM_LOGGER(error, "Pre-event arena of %u bytes could not be allocated", (unsigned)arenaBytes);
+        end();
+        return HMS_CAM_NO_MEM;
+    }
+
+    _arenaBytes = arenaBytes;
+    _slots      = maxFrames;
+    _count      = 0;
+    _tailPos    = 0;
+    _headPos    = 0;
+    _ticket     = 0;
+    _stats      = {};
+    _pin.store(UINT64_MAX);
+    return HMS_CAM_OK;
+}
+
+void HMS_CAM_PreEvent::end() {
+    if (_camera && _subscriber) {
+        _camera->unsubscribe(_subscriber);
+    }
+    while (_flushing.load()) {
+        HMS_CAM_Yield();                                                                    // Flush on another task still reads the arena
+    }
+    if (_arena) {
+        preEventFree(_arena);
+    }
+    if (_index) {
+        preEventFree(_index);
+    }
+    _camera     = NULL;
+    _subscriber = NULL;
+    _arena      = NULL;
+    _index      = NULL;
+    _arenaBytes = 0;
+    _slots      = 0;
+    _count      = 0;
+}
+
+void HMS_CAM_PreEvent::clear() {
+    std::lock_guard<std::mutex> guard(_lock);
+    while (_evictOldest()) {
+    }
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_PreEvent::pump(uint32_t timeoutMs) {
+    if (!_subscriber) {
+        return HMS_CAM_ERROR;
+    }
+
+    HMS_CAM_FrameView view;
+    HMS_CAM_StatusTypeDef status = _subscriber->receive(view, timeoutMs);
+    if (status != HMS_CAM_OK) {
+        return status;
+    }
+    return append(view.frame());
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_PreEvent::append(const HMS_CAM_FrameBufferTypeDef &frame) {
+    if (!_arena || !frame.buf || !frame.length) {
+        return HMS_CAM_ERROR;
+    }
+
+    std::unique_lock<std::mutex> guard(_lock);
+    if (frame.length > _arenaBytes) {
+        _stats.dropped++;
+        return HMS_CAM_NO_MEM;
+    }
+
+    uint64_t start  = _headPos;
+    size_t   offset = (size_t)(start % _arenaBytes);
+    if (offset + frame.length > _arenaBytes) {
+        start  += _arenaBytes - offset;                                                     // Frames never straddle the end
+        offset  = 0;
+    }
+    uint64_t stop = start + frame.length;
+
+    while (_count && (_tailPos + _arenaBytes < stop || _count == _slots)) {
+        if (!_evictOldest()) {
+            _stats.dropped++;                                                               // Oldest frame is being flushed
+            return HMS_CAM_BUSY;
+        }
+    }
+    if (!_count) {
+        _tailPos = start;
+    }
+
+    guard.unlock();
+    memcpy(_arena + offset, frame.buf, frame.length);                                       // Region is unreachable by flush()
+    guard.lock();
+
+    HMS_CAM_PreEventEntryTypeDef &entry = _index[_ticket % _slots];
+    entry.offset      = (uint32_t)offset;
+    entry.length      = (uint32_t)frame.length;
+    entry.timestampUs = frame.timestampUs;
+    entry.sequence    = frame.sequence;
+    entry.width       = (uint16_t)frame.width;
+    entry.height      = (uint16_t)frame.height;
+
+    _count++;
+    _ticket++;
+    _headPos = stop;
+    _stats.bytes += (uint32_t)frame.length;
+    _stats.appended++;
+    return HMS_CAM_OK;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_PreEvent::flush(HMS_CAM_StreamSink sink, void *context, int64_t fromUs, int64_t toUs) {
+    if (!_arena || !sink) {
+        return HMS_CAM_ERROR;
+    }
+    if (_flushing.exchange(true)) {
+        return HMS_CAM_BUSY;
+    }
+
+    uint64_t first = 0, last = 0;
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        uint64_t oldest = _ticket - _count;
+        first = oldest;
+        while (first < _ticket && _index[first % _slots].timestampUs < fromUs) {
+            first++;
+        }
+        last = first;
+        while (last < _ticket && _index[last % _slots].timestampUs <= toUs) {
+            last++;
+        }
+        _pin.store(first);                                                                  // [first, last) stays in the arena
+    }
+
+    uint32_t count = (uint32_t)(last - first);
+    if (!count) {
+        _pin.store(UINT64_MAX);
+        _flushing.store(false);
+        return HMS_CAM_NOT_FOUND;
+    }
+
+    uint8_t  chunk[PREEVENT_INDEX_BATCH * HMS_CAM_PREEVENT_ENTRY_SIZE];
+    uint64_t written = 0;
+    memcpy(chunk, HMS_CAM_PREEVENT_MAGIC, 8);
+    preEventPut32(chunk + 8, count);
+    preEventPut32(chunk + 12, HMS_CAM_PREEVENT_ENTRY_SIZE);
+    HMS_CAM_StatusTypeDef status = _write(sink, context, chunk, HMS_CAM_PREEVENT_HEADER_SIZE);
+    written += HMS_CAM_PREEVENT_HEADER_SIZE;
+
+    uint64_t data = HMS_CAM_PREEVENT_HEADER_SIZE + (uint64_t)count * HMS_CAM_PREEVENT_ENTRY_SIZE;
+    for (uint64_t ticket = first; ticket < last && status == HMS_CAM_OK; ) {
+        size_t used = 0;
+        for (; ticket < last && used < sizeof(chunk); ticket++, used += HMS_CAM_PREEVENT_ENTRY_SIZE) {
+            const HMS_CAM_PreEventEntryTypeDef &entry = _index[ticket % _slots];
+            uint8_t *p = chunk + used;
+            preEventPut32(p, (uint32_t)data);
+            preEventPut32(p + 4, entry.length);
+            preEventPut64(p + 8, (uint64_t)entry.timestampUs);
+            preEventPut32(p + 16, entry.sequence);
+            p[20] = (uint8_t)entry.width;   p[21] = (uint8_t)(entry.width >> 8);
+            p[22] = (uint8_t)entry.height;  p[23] = (uint8_t)(entry.height >> 8);
+            data += entry.length;
+        }
+        status   = _write(sink, context, chunk, used);
+        written += used;
+    }
+
+    for (uint64_t ticket = first; ticket < last && status == HMS_CAM_OK; ticket++) {
+        const HMS_CAM_PreEventEntryTypeDef &entry = _index[ticket % _slots];
+        status   = _write(sink, context, _arena + entry.offset, entry.length);
+        written += entry.length;
+        _pin.store(ticket + 1);                                                             // Written frames may be evicted again
+    }
+
+    _pin.store(UINT64_MAX);
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        if (status == HMS_CAM_OK) {
+            _stats.flushes++;
+            _stats.flushedFrames += count;
+            _stats.flushedBytes  += written;
+        }
+    }
+    _flushing.store(false);
+    return status;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_PreEvent::flush(const char *path, int64_t fromUs, int64_t toUs) {
+    if (!path) {
+        return HMS_CAM_ERROR;
+    }
+
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        HMS_CAM_LOGGER(error, "Cannot open %s for the pre-event flush", path);
+        return HMS_CAM_ERROR;
+    }
+
+    HMS_CAM_StatusTypeDef status = flush(preEventFileSink, file, fromUs, toUs);
+    if (fclose(file) != 0 && status == HMS_CAM_OK) {
+        status = HMS_CAM_ERROR;
+    }
+    if (status != HMS_CAM_OK) {
+        remove(path);                                                                       // No partial event files
+    }
+    return status;
+}
+
+void HMS_CAM_PreEvent::getStats(HMS_CAM_PreEventStatsTypeDef &stats) const {
+    std::lock_guard<std::mutex> guard(_lock);
+    stats          = _stats;
+    stats.frames   = (uint32_t)_count;
+    stats.oldestUs = _count ? _index[(_ticket - _count) % _slots].timestampUs : 0;
+    stats.newestUs = _count ? _index[(_ticket - 1) % _slots].timestampUs : 0;
+}
+
+bool HMS_CAM_PreEvent::_evictOldest() {
+    if (!_count) {
+        return false;
+    }
+    uint64_t oldest = _ticket - _count;
+    if (oldest >= _pin.load()) {
+        return false;
+    }
+
+    const HMS_CAM_PreEventEntryTypeDef &entry = _index[oldest % _slots];
+    _stats.bytes -= entry.length;
+    _stats.evicted++;
+    _count--;
+    if (_count) {
+        uint32_t next = _index[(oldest + 1) % _slots].offset;                              // Live span < arena, distance is exact
+        _tailPos += (next + _arenaBytes - entry.offset) % _arenaBytes;
+    } else {
+        _tailPos = _headPos;
+    }
+    return true;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_PreEvent::_write(HMS_CAM_StreamSink sink, void *context, const uint8_t *data, size_t length) {
+    int64_t stallSinceUs = 0;
+    while (length) {
+        HMS_CAM_IOVecTypeDef iov = { data, length };
+        int32_t written = sink(&iov, 1, context);
+        if (written < 0) {
+            HMS_CAM_LOGGER(error, "Pre-event sink failed");
+            return HMS_CAM_ERROR;
+        }
+        if (written == 0) {
+            int64_t now = HMS_CAM_Micros();
+            if (!stallSinceUs) {
+                stallSinceUs = now;
+            } else if (now - stallSinceUs >= (int64_t)HMS_CAM_PREEVENT_STALL_MS * 1000) {
+                HMS_CAM_LOGGER(error, "Pre-event sink stalled for %u ms", (unsigned)HMS_CAM_PREEVENT_STALL_MS);
+                return HMS_CAM_TIMEOUT;
+            }
+            HMS_CAM_Yield();
+            continue;
+        }
+        stallSinceUs  = 0;
+        data         += written;
+        length       -= (size_t)written;
+    }
+    return HMS_CAM_OK;
+}
+
+#endif // HMS_CAM_HAS_CAMERA_API
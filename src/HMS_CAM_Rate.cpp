@@ -0,0 +1,182 @@
+#include "HMS_CAM_Rate.h"
+#include "HMS_CAM_Planner.h"
+
+#ifdef HMS_CAM_HAS_CAMERA_API
+
+static size_t rateArea(framesize_t size) {
+    return (size_t)resolution[size].width * resolution[size].height;
+}
+
+HMS_CAM_RateConfigTypeDef HMS_CAM_RateControl::defaultConfig() {
+    HMS_CAM_RateConfigTypeDef config = {};
+    config.qualityBest          = 10;
+    config.qualityWorst         = 40;
+    config.qualityStep          = 2;
+    config.hysteresisPercent    = 15;
+    config.holdFrames           = 8;                                                        // Sensors apply quality 1-2 frames late
+    config.allowResize          = false;
+    config.minFrameSize         = FRAMESIZE_QQVGA;
+    return config;
+}
+
+void HMS_CAM_RateControl::configure(const HMS_CAM_RateConfigTypeDef &config) {
+    _config = config;
+    if (_config.qualityBest < 0)                        _config.qualityBest  = 0;
+    if (_config.qualityWorst > 63)                      _config.qualityWorst = 63;
+    if (_config.qualityWorst < _config.qualityBest)     _config.qualityWorst = _config.qualityBest;
+    if (_config.qualityStep < 1)                        _config.qualityStep  = 1;
+    if (_config.hysteresisPercent > 50)                 _config.hysteresisPercent = 50;
+}
+
+void HMS_CAM_RateControl::reset(int quality, framesize_t frameSize, framesize_t ceiling, size_t bufferBytes) {
+    size_t ceilWidth  = resolution[ceiling].width;
+    size_t ceilHeight = resolution[ceiling].height;
+    size_t minArea    = _config.allowResize ? rateArea(_config.minFrameSize) : rateArea(frameSize);
+
+    _ladderCount = 0;
+    for (int i = 0; i < FRAMESIZE_INVALID; i++) {
+        framesize_t size = (framesize_t)i;
+        size_t      area = rateArea(size);
+        if (area > rateArea(ceiling) || area < minArea ||
+            resolution[size].width * ceilHeight != resolution[size].height * ceilWidth) {
+            continue;                                                                       // Larger, too small or other aspect
+        }
+        if (bufferBytes && HMS_CAM_Planner::bufferBytes(size, PIXFORMAT_JPEG) > bufferBytes) {
+            continue;                                                                       // Outgrows the allocated buffers
+        }
+        size_t pos = _ladderCount++;
+        while (pos > 0 && rateArea(_ladder[pos - 1]) > area) {                              // Insertion sort by area
+            _ladder[pos] = _ladder[pos - 1];
+            pos--;
+        }
+        _ladder[pos] = size;
+    }
+
+    _level = 0;
+    while (_level < _ladderCount && _ladder[_level] != frameSize) {
+        _level++;
+    }
+    if (_level == _ladderCount) {
+        _ladder[0]   = frameSize;                                                           // Off-ladder size, quality only
+        _ladderCount = 1;
+        _level       = 0;
+    }
+
+    _quality     = quality;
+    _bufferBytes = bufferBytes;
+    _bytes       = 0;
+    _intervalUs  = 0;
+    _latencyUs   = 0;
+    _lastUs      = 0;
+    _hold        = _config.holdFrames;
+    _statQualityChanges.store(0);
+    _statSizeChanges.store(0);
+    _statOverflowGuards.store(0);
+    _publish(HMS_CAM_RATE_HOLD);
+}
+
+HMS_CAM_RateDecision HMS_CAM_RateControl::update(size_t bytes, uint32_t latencyUs, int64_t nowUs) {
+    uint32_t length = (uint32_t)bytes;                                                      // EWMA, alpha = 1/8
+    _bytes      = _bytes ? _bytes - (_bytes >> 3) + (length >> 3) : length;
+    _latencyUs  = _latencyUs ? _latencyUs - (_latencyUs >> 3) + (latencyUs >> 3) : latencyUs;
+    if (_lastUs) {
+        uint32_t interval = (uint32_t)(nowUs - _lastUs);
+        _intervalUs = _intervalUs ? _intervalUs - (_intervalUs >> 3) + (interval >> 3) : interval;
+    }
+    _lastUs = nowUs;
+
+    bool urgent = _bufferBytes && bytes > _bufferBytes - _bufferBytes / 8;                  // Next frame may not fit
+    if (urgent) {
+        _statOverflowGuards.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    HMS_CAM_RateDecision decision = HMS_CAM_RATE_HOLD;
+    uint32_t load = _load();
+    if (_hold && !urgent) {
+        _hold--;
+    } else if (urgent || load > 100u + _config.hysteresisPercent) {
+        decision = _worsen(urgent);
+    } else if (load && load < 100u - _config.hysteresisPercent) {
+        decision = _improve(load);
+    }
+
+    if (decision != HMS_CAM_RATE_HOLD) {
+        _hold = _config.holdFrames;
+    }
+    _publish(decision);
+    return decision;
+}
+
+void HMS_CAM_RateControl::getStats(HMS_CAM_RateStatsTypeDef &stats) const {
+    stats.quality        = _statQuality.load(std::memory_order_relaxed);
+    stats.frameSize      = (framesize_t)_statFrameSize.load(std::memory_order_relaxed);
+    stats.bytesPerFrame  = _statBytesPerFrame.load(std::memory_order_relaxed);
+    stats.bytesPerSecond = _statBytesPerSecond.load(std::memory_order_relaxed);
+    stats.latencyUs      = _statLatencyUs.load(std::memory_order_relaxed);
+    stats.load           = _statLoad.load(std::memory_order_relaxed);
+    stats.qualityChanges = _statQualityChanges.load(std::memory_order_relaxed);
+    stats.sizeChanges    = _statSizeChanges.load(std::memory_order_relaxed);
+    stats.overflowGuards = _statOverflowGuards.load(std::memory_order_relaxed);
+    stats.lastDecision   = (HMS_CAM_RateDecision)_statDecision.load(std::memory_order_relaxed);
+}
+
+uint32_t HMS_CAM_RateControl::_load() const {
+    uint64_t load = 0;
+    if (_config.targetBytesPerFrame) {
+        load = (uint64_t)_bytes * 100 / _config.targetBytesPerFrame;
+    }
+    if (_config.targetBytesPerSecond && _intervalUs) {
+        uint64_t rate = (uint64_t)_bytes * 1000000 / _intervalUs;
+        uint64_t part = rate * 100 / _config.targetBytesPerSecond;
+        load = part > load ? part : load;
+    }
+    if (_config.maxLatencyUs) {
+        uint64_t part = (uint64_t)_latencyUs * 100 / _config.maxLatencyUs;
+        load = part > load ? part : load;
+    }
+    return load > UINT32_MAX ? UINT32_MAX : (uint32_t)load;
+}
+
+HMS_CAM_RateDecision HMS_CAM_RateControl::_worsen(bool urgent) {
+    int step = _config.qualityStep * (urgent ? 2 : 1);
+    if (_quality < _config.qualityWorst) {
+        _quality = _quality + step < _config.qualityWorst ? _quality + step : _config.qualityWorst;
+        _statQualityChanges.fetch_add(1, std::memory_order_relaxed);
+        return HMS_CAM_RATE_QUALITY_DOWN;
+    }
+    if (_config.allowResize && _level > 0) {
+        _level--;
+        _statSizeChanges.fetch_add(1, std::memory_order_relaxed);
+        return HMS_CAM_RATE_SIZE_DOWN;
+    }
+    return HMS_CAM_RATE_HOLD;                                                               // Nothing left to give
+}
+
+HMS_CAM_RateDecision HMS_CAM_RateControl::_improve(uint32_t load) {
+    if (_config.allowResize && _level + 1 < _ladderCount) {
+        uint64_t predicted = (uint64_t)load * rateArea(_ladder[_level + 1]) / rateArea(_ladder[_level]);
+        if (predicted < 100u - _config.hysteresisPercent) {                                // Only if the larger size fits the band
+            _level++;
+            _statSizeChanges.fetch_add(1, std::memory_order_relaxed);
+            return HMS_CAM_RATE_SIZE_UP;
+        }
+    }
+    if (_quality > _config.qualityBest) {
+        _quality = _quality - _config.qualityStep > _config.qualityBest ? _quality - _config.qualityStep : _config.qualityBest;
+        _statQualityChanges.fetch_add(1, std::memory_order_relaxed);
+        return HMS_CAM_RATE_QUALITY_UP;
+    }
+    return HMS_CAM_RATE_HOLD;
+}
+
+void HMS_CAM_RateControl::_publish(HMS_CAM_RateDecision decision) {
+    _statQuality.store(_quality, std::memory_order_relaxed);
+    _statFrameSize.store(_ladder[_level], std::memory_order_relaxed);
+    _statBytesPerFrame.store(_bytes, std::memory_order_relaxed);
+    _statBytesPerSecond.store(_intervalUs ? (uint32_t)((uint64_t)_bytes * 1000000 / _intervalUs) : 0, std::memory_order_relaxed);
+    _statLatencyUs.store(_latencyUs, std::memory_order_relaxed);
+    _statLoad.store(_load(), std::memory_order_relaxed);
+    _statDecision.store(decision, std::memory_order_relaxed);
+}
+
+#endif // HMS_CAM_HAS_CAMERA_API
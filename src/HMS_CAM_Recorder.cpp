@@ -0,0 +1,516 @@
+#include "HMS_CAM_Recorder.h"
+
+#ifdef HMS_CAM_HAS_CAMERA_API
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+
+#if defined(_WIN32)
+    #include <io.h>
+#else
+    #include <unistd.h>
+#endif
+
+#if defined(HMS_CAM_PLATFORM_ESP_IDF)
+    #include "esp_heap_caps.h"
+#endif
+
+#define RECORDER_MOVI           (HMS_CAM_RECORDER_HEADER_SIZE - 4)                          // File offset of the 'movi' fourcc
+#define RECORDER_KEYFRAME       0x10                                                        // AVIIF_KEYFRAME, every JPEG is one
+#define RECORDER_HAS_INDEX      0x10                                                        // AVIF_HASINDEX
+#define RECORDER_DEFAULT_US     33333                                                       // Frame interval without timestamps
+
+static void recorderPut16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;          p[1] = (uint8_t)(v >> 8);
+}
+
+static void recorderPut32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;          p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);  p[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t recorderGet32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static int recorderOpen(const char *path) {
+    #if defined(_WIN32)
+        return _open(path, _O_RDWR | _O_CREAT | _O_TRUNC | _O_BINARY, 0644);
+    #else
+        return ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    #endif
+}
+
+static void recorderClose(int fd) {
+    #if defined(_WIN32)
+        _close(fd);
+    #else
+        ::close(fd);
+    #endif
+}
+
+static bool recorderSeek(int fd, uint64_t offset) {
+    #if defined(_WIN32)
+        return _lseeki64(fd, (int64_t)offset, SEEK_SET) == (int64_t)offset;
+    #else
+        return lseek(fd, (off_t)offset, SEEK_SET) == (off_t)offset;
+    #endif
+}
+
+static bool recorderWrite(int fd, const uint8_t *data, size_t length) {
+    while (length) {
+        #if defined(_WIN32)
+            int n = _write(fd, data, (unsigned)length);
+        #else
+            ssize_t n = ::write(fd, data, length);
+        #endif
+        if (n <= 0) {
+            return false;                                                                   // Card full or removed
+        }
+        data   += n;
+        length -= (size_t)n;
+    }
+    return true;
+}
+
+static long recorderRead(int fd, uint8_t *data, size_t length) {
+    #if defined(_WIN32)
+        return _read(fd, data, (unsigned)length);
+    #else
+        return (long)::read(fd, data, length);
+    #endif
+}
+
+static void recorderSync(int fd) {
+    #if defined(_WIN32)
+        _commit(fd);
+    #else
+        fsync(fd);
+    #endif
+}
+
+static bool recorderTruncate(int fd, uint64_t length) {
+    #if defined(_WIN32)
+        return _chsize_s(fd, (int64_t)length) == 0;
+    #else
+        return ftruncate(fd, (off_t)length) == 0;
+    #endif
+}
+
+static bool recorderReserve(int fd, uint64_t bytes) {
+    #if defined(__linux__)
+        return posix_fallocate(fd, 0, (off_t)bytes) == 0;
+    #elif defined(_WIN32)
+        return _chsize_s(fd, (int64_t)bytes) == 0;
+    #else
+        uint8_t zero = 0;                                                                   // FAT links the whole chain on a write past the end
+        bool ok = recorderSeek(fd, bytes - 1) && recorderWrite(fd, &zero, 1);
+        return recorderSeek(fd, 0) && ok;
+    #endif
+}
+
+static void recorderFree(void *ptr) {
+    #if defined(HMS_CAM_PLATFORM_ESP_IDF)
+        heap_caps_free(ptr);
+    #else
+        free(ptr);
+    #endif
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_Recorder::begin(const char *path, uint64_t preallocateBytes, size_t bufferBytes) {
+    end();
+    if (!path || bufferBytes < HMS_CAM_RECORDER_HEADER_SIZE || bufferBytes % HMS_CAM_RECORDER_SECTOR) {
+        return HMS_CAM_ERROR;                                                               // Headers are built in the buffer
+    }
+
+    #if defined(HMS_CAM_PLATFORM_ESP_IDF)
+        _buffer = (uint8_t *)heap_caps_malloc(bufferBytes, MALLOC_CAP_DMA);                 // SDMMC copies from internal RAM
+        if (!_buffer) {
+            _buffer = (uint8_t *)heap_caps_malloc(bufferBytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        }
+    #else
+        _buffer = (uint8_t *)malloc(bufferBytes);
+    #endif
+    _indexPath = (char *)malloc(strlen(path) + sizeof(HMS_CAM_RECORDER_INDEX_SUFFIX));
+    if (!_buffer || !_indexPath) {
+        _close();
+        return HMS_CAM_NO_MEM;
+    }
+    sprintf(_indexPath, "%s%s", path, HMS_CAM_RECORDER_INDEX_SUFFIX);
+
+    _fd      = recorderOpen(path);
+    _indexFd = recorderOpen(_indexPath);
+    if (_fd < 0 || _indexFd < 0) {
+        HMS_CAM_LOGGER(error, "Cannot create recording %s", path);
+        _close();
+        return HMS_CAM_ERROR;
+    }
+
+    _bufferBytes  = bufferBytes;
+    _used         = 0;
+    _indexUsed    = 0;
+    _position     = HMS_CAM_RECORDER_HEADER_SIZE;
+    _preallocated = 0;
+    _width        = 0;
+    _height       = 0;
+    _firstUs      = 0;
+    _lastUs       = 0;
+    _stats        = {};
+
+    preallocateBytes = preallocateBytes < HMS_CAM_RECORDER_MAX_BYTES ? preallocateBytes : HMS_CAM_RECORDER_MAX_BYTES;
+    if (preallocateBytes > HMS_CAM_RECORDER_HEADER_SIZE) {
+        if (recorderReserve(_fd, preallocateBytes)) {
+            _preallocated = preallocateBytes;
+        } else {
+            HMS_CAM_LOGGER(warn, "Cannot preallocate %llu bytes for %s", (unsigned long long)preallocateBytes, path);
+        }
+    }
+
+    HMS_CAM_StatusTypeDef status = _writeHeader(HMS_CAM_RECORDER_HEADER_SIZE, 4);           // Valid RIFF start even if never closed
+    if (status != HMS_CAM_OK) {
+        _close();
+    }
+    return status;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_Recorder::append(const HMS_CAM_FrameBufferTypeDef &frame) {
+    if (_fd < 0) {
+        return HMS_CAM_ERROR;
+    }
+    if (!frame.buf || frame.length < 4 || frame.buf[0] != 0xFF || frame.buf[1] != 0xD8) {
+        return HMS_CAM_ERROR;                                                               // MJPEG stream, JPEG frames only
+    }
+
+    uint64_t chunk   = _position + _used;
+    size_t   padding = frame.length & 1;                                                    // RIFF chunks are word aligned
+    uint64_t closed  = chunk + 8 + frame.length + padding + 8 + (uint64_t)(_stats.frames + 1) * HMS_CAM_RECORDER_ENTRY_SIZE;
+    if (closed > HMS_CAM_RECORDER_MAX_BYTES) {
+        return HMS_CAM_NO_MEM;                                                              // Caller rotates to a new file
+    }
+
+    if (!_stats.frames) {
+        _width   = (uint16_t)frame.width;
+        _height  = (uint16_t)frame.height;
+        _firstUs = frame.timestampUs;
+    }
+    _lastUs = frame.timestampUs;
+
+    uint8_t header[8];
+    static const uint8_t zero = 0;
+    memcpy(header, "00dc", 4);
+    recorderPut32(header + 4, (uint32_t)frame.length);
+    HMS_CAM_StatusTypeDef status = _stage(header, sizeof(header));
+    if (status == HMS_CAM_OK) status = _stage(frame.buf, frame.length);
+    if (status == HMS_CAM_OK && padding) status = _stage(&zero, 1);
+    if (status != HMS_CAM_OK) {
+        return status;
+    }
+
+    uint8_t *entry = _index + _indexUsed;
+    memcpy(entry, "00dc", 4);
+    recorderPut32(entry + 4, RECORDER_KEYFRAME);
+    recorderPut32(entry + 8, (uint32_t)(chunk - RECORDER_MOVI));
+    recorderPut32(entry + 12, (uint32_t)frame.length);
+    _indexUsed += HMS_CAM_RECORDER_ENTRY_SIZE;
+    if (_indexUsed == sizeof(_index)) {
+        status = _writeIndex();
+    }
+
+    _stats.frames++;
+    _stats.maxFrame = frame.length > _stats.maxFrame ? (uint32_t)frame.length : _stats.maxFrame;
+    return status;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_Recorder::sync() {
+    if (_fd < 0) {
+        return HMS_CAM_ERROR;
+    }
+
+    size_t padding = (size_t)((HMS_CAM_RECORDER_SECTOR - (_position + _used) % HMS_CAM_RECORDER_SECTOR) % HMS_CAM_RECORDER_SECTOR);
+    HMS_CAM_StatusTypeDef status = HMS_CAM_OK;
+    if (padding) {
+        padding += padding < 8 ? HMS_CAM_RECORDER_SECTOR : 0;                               // Room for the JUNK header
+        uint8_t junk[64] = {};
+        memcpy(junk, "JUNK", 4);
+        recorderPut32(junk + 4, (uint32_t)(padding - 8));
+        for (size_t left = padding; left && status == HMS_CAM_OK; ) {
+            size_t n = left < sizeof(junk) ? left : sizeof(junk);
+            status = _stage(junk, n);
+            memset(junk, 0, 8);
+            left -= n;
+        }
+    }
+    if (status == HMS_CAM_OK) status = _writeBuffer();
+    if (status == HMS_CAM_OK) status = _writeIndex();
+    if (status == HMS_CAM_OK) {
+        recorderSync(_fd);
+        recorderSync(_indexFd);
+        _stats.syncs++;
+    }
+    return status;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_Recorder::end() {
+    if (_fd < 0) {
+        _close();
+        return HMS_CAM_OK;
+    }
+
+    HMS_CAM_StatusTypeDef status = _writeBuffer();
+    if (status == HMS_CAM_OK) status = _writeIndex();
+
+    uint64_t moviEnd = _position;
+    if (status == HMS_CAM_OK) status = _finishIndex();
+    if (status == HMS_CAM_OK) status = _writeHeader(_position, moviEnd - RECORDER_MOVI);
+    if (status == HMS_CAM_OK && _preallocated > _position && !recorderTruncate(_fd, _position)) {
+        status = HMS_CAM_ERROR;
+    }
+    recorderSync(_fd);
+
+    if (status == HMS_CAM_OK) {
+        recorderClose(_indexFd);
+        _indexFd = -1;
+        remove(_indexPath);                                                                 // idx1 holds the same entries now
+    } else {
+        HMS_CAM_LOGGER(error, "Recording not finalized, sidecar index kept");
+    }
+    _close();
+    return status;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_Recorder::open(const uint8_t *data, size_t length, HMS_CAM_RecordingTypeDef &recording) {
+    recording = {};
+    if (!data || length < 12 || memcmp(data, "RIFF", 4) != 0 || memcmp(data + 8, "AVI ", 4) != 0) {
+        return HMS_CAM_ERROR;
+    }
+
+    uint64_t riffEnd = 8 + (uint64_t)recorderGet32(data + 4);
+    size_t   end     = riffEnd < length ? (size_t)riffEnd : length;
+    bool     movi    = false, index = false;
+    for (size_t pos = 12; pos + 8 <= end; ) {                                               // Top level chunks only
+        const uint8_t *chunk = data + pos;
+        uint32_t size = recorderGet32(chunk + 4);
+
+        if (memcmp(chunk, "LIST", 4) == 0 && size >= 4 && pos + 12 <= end) {
+            if (memcmp(chunk + 8, "movi", 4) == 0) {
+                recording.movi = pos + 8;
+                movi = true;
+            } else if (memcmp(chunk + 8, "hdrl", 4) == 0 && size >= 4 + 8 + 40 && pos + 60 <= end &&
+                       memcmp(chunk + 12, "avih", 4) == 0) {
+                recording.usPerFrame = recorderGet32(chunk + 20);
+                recording.width      = (uint16_t)recorderGet32(chunk + 52);
+                recording.height     = (uint16_t)recorderGet32(chunk + 56);
+            }
+        } else if (memcmp(chunk, "idx1", 4) == 0) {
+            if (pos + 8 + (uint64_t)size > length) {
+                return HMS_CAM_ERROR;                                                       // Truncated copy
+            }
+            recording.index  = pos + 8;
+            recording.frames = size / HMS_CAM_RECORDER_ENTRY_SIZE;
+            index = true;
+        }
+        pos += 8 + (size_t)size + (size & 1);
+    }
+
+    if (!movi || !index) {
+        return HMS_CAM_NOT_FOUND;                                                           // Not finalized, or no index
+    }
+    recording.base   = data;
+    recording.length = length;
+    return HMS_CAM_OK;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_Recorder::frameAt(const HMS_CAM_RecordingTypeDef &recording, uint32_t index,
+                                                const uint8_t *&data, size_t &length) {
+    if (!recording.base || index >= recording.frames) {
+        return HMS_CAM_NOT_FOUND;
+    }
+
+    const uint8_t *entry = recording.base + recording.index + (size_t)index * HMS_CAM_RECORDER_ENTRY_SIZE;
+    uint32_t offset = recorderGet32(entry + 8);
+    uint32_t size   = recorderGet32(entry + 12);
+    auto fits = [&](uint64_t chunk) {
+        return chunk + 8 + size <= recording.length && memcmp(recording.base + chunk, entry, 4) == 0;
+    };
+
+    uint64_t chunk = (uint64_t)recording.movi + offset;                                     // Relative to 'movi', as written here
+    if (!fits(chunk)) {
+        chunk = offset;                                                                     // Some writers store file offsets
+        if (!fits(chunk)) {
+            return HMS_CAM_ERROR;
+        }
+    }
+    data   = recording.base + chunk + 8;
+    length = size;
+    return HMS_CAM_OK;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_Recorder::_stage(const uint8_t *data, size_t length) {
+    while (length) {
+        size_t n = _bufferBytes - _used;
+        n = length < n ? length : n;
+        memcpy(_buffer + _used, data, n);
+        _used  += n;
+        data   += n;
+        length -= n;
+        if (_used == _bufferBytes) {
+            HMS_CAM_StatusTypeDef status = _writeBuffer();                                  // Full buffer, sector aligned
+            if (status != HMS_CAM_OK) {
+                return status;
+            }
+        }
+    }
+    return HMS_CAM_OK;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_Recorder::_writeBuffer() {
+    if (!_used) {
+        return HMS_CAM_OK;
+    }
+
+    int64_t start = HMS_CAM_Micros();
+    if (!recorderWrite(_fd, _buffer, _used)) {
+        HMS_CAM_LOGGER(error, "Recording write of %u bytes failed", (unsigned)_used);
+        return HMS_CAM_ERROR;
+    }
+    uint32_t spent = (uint32_t)(HMS_CAM_Micros() - start);
+
+    _stats.writes++;
+    _stats.bytes      += _used;
+    _stats.maxWriteUs  = spent > _stats.maxWriteUs ? spent : _stats.maxWriteUs;
+    _position         += _used;
+    _used              = 0;
+    return HMS_CAM_OK;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_Recorder::_writeIndex() {
+    if (!_indexUsed) {
+        return HMS_CAM_OK;
+    }
+    if (!recorderWrite(_indexFd, _index, _indexUsed)) {
+        HMS_CAM_LOGGER(error, "Recording index write failed");
+        return HMS_CAM_ERROR;
+    }
+    _indexUsed = 0;
+    return HMS_CAM_OK;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_Recorder::_finishIndex() {
+    uint32_t bytes = _stats.frames * HMS_CAM_RECORDER_ENTRY_SIZE;
+    if (!recorderSeek(_indexFd, 0)) {
+        return HMS_CAM_ERROR;
+    }
+
+    memcpy(_buffer, "idx1", 4);
+    recorderPut32(_buffer + 4, bytes);
+    _used = 8;
+
+    uint32_t copied = 0;
+    for (;;) {
+        long n = recorderRead(_indexFd, _buffer + _used, _bufferBytes - _used);
+        if (n < 0) {
+            return HMS_CAM_ERROR;
+        }
+        if (n == 0) {
+            break;
+        }
+        _used  += (size_t)n;
+        copied += (uint32_t)n;
+        if (_used == _bufferBytes && _writeBuffer() != HMS_CAM_OK) {
+            return HMS_CAM_ERROR;
+        }
+    }
+    if (copied != bytes) {
+        HMS_CAM_LOGGER(error, "Sidecar index holds %u bytes, expected %u", (unsigned)copied, (unsigned)bytes);
+        _used = 0;
+        return HMS_CAM_ERROR;
+    }
+    return _writeBuffer();
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_Recorder::_writeHeader(uint64_t fileLength, uint64_t moviBytes) {
+    uint32_t frames     = _stats.frames;
+    uint32_t usPerFrame = RECORDER_DEFAULT_US;
+    if (frames > 1 && _lastUs > _firstUs) {
+        usPerFrame = (uint32_t)((_lastUs - _firstUs) / (frames - 1));
+    }
+    uint32_t maxFrame   = _stats.maxFrame;
+    uint32_t byteRate   = (uint32_t)((uint64_t)maxFrame * 1000000 / (usPerFrame ? usPerFrame : 1));
+
+    uint8_t *h = _buffer;                                                                   // Only called with nothing staged
+    memset(h, 0, HMS_CAM_RECORDER_HEADER_SIZE);
+    memcpy(h, "RIFF", 4);           recorderPut32(h + 4, (uint32_t)(fileLength - 8));      memcpy(h + 8, "AVI ", 4);
+    memcpy(h + 12, "LIST", 4);      recorderPut32(h + 16, 192);                             memcpy(h + 20, "hdrl", 4);
+
+    memcpy(h + 24, "avih", 4);      recorderPut32(h + 28, 56);
+    uint8_t *avih = h + 32;
+    recorderPut32(avih + 0,  usPerFrame);
+    recorderPut32(avih + 4,  byteRate);
+    recorderPut32(avih + 12, RECORDER_HAS_INDEX);
+    recorderPut32(avih + 16, frames);
+    recorderPut32(avih + 24, 1);                                                            // One stream
+    recorderPut32(avih + 28, maxFrame);
+    recorderPut32(avih + 32, _width);
+    recorderPut32(avih + 36, _height);
+
+    memcpy(h + 88, "LIST", 4);      recorderPut32(h + 92, 116);                             memcpy(h + 96, "strl", 4);
+    memcpy(h + 100, "strh", 4);     recorderPut32(h + 104, 56);
+    uint8_t *strh = h + 108;
+    memcpy(strh, "vids", 4);
+    memcpy(strh + 4, "MJPG", 4);
+    recorderPut32(strh + 20, usPerFrame);                                                   // dwScale / dwRate = frame interval
+    recorderPut32(strh + 24, 1000000);
+    recorderPut32(strh + 32, frames);
+    recorderPut32(strh + 36, maxFrame);
+    recorderPut32(strh + 40, 0xFFFFFFFF);                                                   // Default quality
+    recorderPut16(strh + 52, _width);
+    recorderPut16(strh + 54, _height);
+
+    memcpy(h + 164, "strf", 4);     recorderPut32(h + 168, 40);
+    uint8_t *strf = h + 172;
+    recorderPut32(strf + 0,  40);
+    recorderPut32(strf + 4,  _width);
+    recorderPut32(strf + 8,  _height);
+    recorderPut16(strf + 12, 1);
+    recorderPut16(strf + 14, 24);
+    memcpy(strf + 16, "MJPG", 4);
+    recorderPut32(strf + 20, (uint32_t)_width * _height * 3);
+
+    memcpy(h + 212, "JUNK", 4);     recorderPut32(h + 216, RECORDER_MOVI - 8 - 220);        // Pads movi data to the header size
+    memcpy(h + RECORDER_MOVI - 8, "LIST", 4);
+    recorderPut32(h + RECORDER_MOVI - 4, (uint32_t)moviBytes);
+    memcpy(h + RECORDER_MOVI, "movi", 4);
+
+    bool ok = recorderSeek(_fd, 0) && recorderWrite(_fd, h, HMS_CAM_RECORDER_HEADER_SIZE) && recorderSeek(_fd, _position);
+    if (!ok) {
+        HMS_CAM_LOGGER(error, "Recording header write failed");
+        return HMS_CAM_ERROR;
+    }
+    _stats.writes++;
+    _stats.bytes += HMS_CAM_RECORDER_HEADER_SIZE;
+    return HMS_CAM_OK;
+}
+
+void HMS_CAM_Recorder::_close() {
+    if (_fd >= 0) {
+        recorderClose(_fd);
+    }
+    if (_indexFd >= 0) {
+        recorderClose(_indexFd);
+    }
+    if (_buffer) {
+        recorderFree(_buffer);
+    }
+    free(_indexPath);
+    _fd          = -1;
+    _indexFd     = -1;
+    _buffer      = NULL;
+    _indexPath   = NULL;
+    _bufferBytes = 0;
+    _used        = 0;
+    _indexUsed   = 0;
+}
+
+#endif // HMS_CAM_HAS_CAMERA_API
@@ -0,0 +1,424 @@
+#include "HMS_CAM_Sensor.h"
+
+#ifdef HMS_CAM_HAS_CAMERA_API
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Setting, setter suffix and camera_status_t field. gainceiling │
+  │       takes a gainceiling_t and is handled next to the list.        │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+#define HMS_CAM_SENSOR_SETTINGS(X)                                          \
+    X(BRIGHTNESS,       brightness,         brightness)                     \
+    X(CONTRAST,         contrast,           contrast)                       \
+    X(SATURATION,       saturation,         saturation)                     \
+    X(SHARPNESS,        sharpness,          sharpness)                      \
+    X(DENOISE,          denoise,            denoise)                        \
+    X(SPECIAL_EFFECT,   special_effect,     special_effect)                 \
+    X(WHITEBAL,         whitebal,           awb)                            \
+    X(AWB_GAIN,         awb_gain,           awb_gain)                       \
+    X(WB_MODE,          wb_mode,            wb_mode)                        \
+    X(EXPOSURE_CTRL,    exposure_ctrl,      aec)                            \
+    X(AEC2,             aec2,               aec2)                           \
+    X(AE_LEVEL,         ae_level,           ae_level)                       \
+    X(AEC_VALUE,        aec_value,          aec_value)                      \
+    X(GAIN_CTRL,        gain_ctrl,          agc)                            \
+    X(AGC_GAIN,         agc_gain,           agc_gain)                       \
+    X(BPC,              bpc,                bpc)                            \
+    X(WPC,              wpc,                wpc)                            \
+    X(RAW_GMA,          raw_gma,            raw_gma)                        \
+    X(LENC,             lenc,               lenc)                           \
+    X(HMIRROR,          hmirror,            hmirror)                        \
+    X(VFLIP,            vflip,              vflip)                          \
+    X(DCW,              dcw,                dcw)                            \
+    X(COLORBAR,         colorbar,           colorbar)
+
+static constexpr HMS_CAM_SensorEntryTypeDef sensorDefaultEntries[] = {
+    { HMS_CAM_SENSOR_BRIGHTNESS,        0   },                                              // -2 to 2
+    { HMS_CAM_SENSOR_CONTRAST,          0   },                                              // -2 to 2
+    { HMS_CAM_SENSOR_SATURATION,        0   },                                              // -2 to 2
+    { HMS_CAM_SENSOR_SPECIAL_EFFECT,    0   },                                              // 0 - No Effect
+    { HMS_CAM_SENSOR_WHITEBAL,          1   },                                              // Enable white balance
+    { HMS_CAM_SENSOR_AWB_GAIN,          1   },                                              // Enable AWB gain
+    { HMS_CAM_SENSOR_WB_MODE,           0   },                                              // Auto white balance
+    { HMS_CAM_SENSOR_EXPOSURE_CTRL,     1   },                                              // Enable exposure control
+    { HMS_CAM_SENSOR_AEC2,              0   },                                              // Disable AEC2
+    { HMS_CAM_SENSOR_AE_LEVEL,          0   },                                              // Auto exposure level
+    { HMS_CAM_SENSOR_AEC_VALUE,         300 },                                              // AEC value
+    { HMS_CAM_SENSOR_GAIN_CTRL,         1   },                                              // Enable gain control
+    { HMS_CAM_SENSOR_AGC_GAIN,          0   },                                              // Auto gain
+    { HMS_CAM_SENSOR_GAINCEILING,       0   },                                              // Gain ceiling
+    { HMS_CAM_SENSOR_BPC,               1   },                                              // Enable black pixel correct
+    { HMS_CAM_SENSOR_WPC,               1   },                                              // Enable white pixel correct
+    { HMS_CAM_SENSOR_RAW_GMA,           1   },                                              // Enable gamma
+    { HMS_CAM_SENSOR_LENC,              1   },                                              // Enable lens correction
+    { HMS_CAM_SENSOR_HMIRROR,           0   },                                              // No horizontal mirror
+    { HMS_CAM_SENSOR_VFLIP,             0   },                                              // No vertical flip
+    { HMS_CAM_SENSOR_DCW,               1   },                                              // Enable downsize
+    { HMS_CAM_SENSOR_COLORBAR,          0   },                                              // Disable color bar
+};
+
+static constexpr HMS_CAM_SensorProfileTypeDef sensorDefaultProfile = {
+    "default", sensorDefaultEntries, (uint8_t)(sizeof(sensorDefaultEntries) / sizeof(sensorDefaultEntries[0]))
+};
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Built-in module tables. Mode frame rates are the datasheet    │
+  │       figures at 24 MHz XCLK. PLL entries follow the esp32-camera   │
+  │       JPEG settings with the pixel clock divider halved, they are   │
+  │       only applied when a minimum frame rate is requested.          │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+static constexpr HMS_CAM_SensorEntryTypeDef sensorHighFpsEntries[] = {
+    { HMS_CAM_SENSOR_AEC2,              0   },                                              // Night mode stretches frames
+    { HMS_CAM_SENSOR_GAINCEILING,       2   },                                              // 8x, gain before exposure time
+};
+
+static constexpr HMS_CAM_SensorProfileTypeDef sensorHighFpsProfile = {
+    "high-fps", sensorHighFpsEntries, (uint8_t)(sizeof(sensorHighFpsEntries) / sizeof(sensorHighFpsEntries[0]))
+};
+
+static constexpr HMS_CAM_SensorModeTypeDef sensorOV2640Modes[] = {
+    { FRAMESIZE_CIF,    60, true,  OV2640_MODE_CIF  },                                      // 1/4 subsampled window
+    { FRAMESIZE_SVGA,   30, true,  OV2640_MODE_SVGA },                                      // 1/2 subsampled window
+    { FRAMESIZE_UXGA,   15, false, OV2640_MODE_UXGA },
+};
+
+static constexpr HMS_CAM_SensorEntryTypeDef sensorOV3660Entries[] = {
+    { HMS_CAM_SENSOR_WHITEBAL,          1   },
+    { HMS_CAM_SENSOR_AWB_GAIN,          1   },
+    { HMS_CAM_SENSOR_EXPOSURE_CTRL,     1   },
+    { HMS_CAM_SENSOR_GAIN_CTRL,         1   },
+    { HMS_CAM_SENSOR_BPC,               1   },
+    { HMS_CAM_SENSOR_WPC,               1   },
+    { HMS_CAM_SENSOR_RAW_GMA,           1   },
+    { HMS_CAM_SENSOR_LENC,              1   },
+    { HMS_CAM_SENSOR_DENOISE,           1   },                                              // Less noise, smaller JPEG frames
+    { HMS_CAM_SENSOR_DCW,               1   },
+};
+
+static constexpr HMS_CAM_SensorProfileTypeDef sensorOV3660Profile = {
+    "ov3660", sensorOV3660Entries, (uint8_t)(sizeof(sensorOV3660Entries) / sizeof(sensorOV3660Entries[0]))
+};
+
+static constexpr HMS_CAM_SensorModeTypeDef sensorOV3660Modes[] = {
+    { FRAMESIZE_VGA,    60, true,  0 },                                                     // Binned
+    { FRAMESIZE_XGA,    45, true,  0 },
+    { FRAMESIZE_QXGA,   15, false, 0 },
+};
+
+static constexpr HMS_CAM_SensorClockTypeDef sensorOV3660Clocks[] = {
+    { 20000000, 0, 30, 1, 3, 0, 0, 1, 5  },                                                 // 50 MHz SYSCLK, 20 MHz PCLK
+    { 0,        0, 24, 1, 3, 0, 0, 1, 4  },                                                 // 40 MHz SYSCLK at 16 MHz XCLK
+};
+
+static constexpr HMS_CAM_SensorEntryTypeDef sensorOV5640Entries[] = {
+    { HMS_CAM_SENSOR_WHITEBAL,          1   },
+    { HMS_CAM_SENSOR_AWB_GAIN,          1   },
+    { HMS_CAM_SENSOR_EXPOSURE_CTRL,     1   },
+    { HMS_CAM_SENSOR_GAIN_CTRL,         1   },
+    { HMS_CAM_SENSOR_BPC,               1   },
+    { HMS_CAM_SENSOR_WPC,               1   },
+    { HMS_CAM_SENSOR_RAW_GMA,           1   },
+    { HMS_CAM_SENSOR_LENC,              1   },
+    { HMS_CAM_SENSOR_DENOISE,           1   },                                              // Less noise, smaller JPEG frames
+    { HMS_CAM_SENSOR_SHARPNESS,         -1  },                                              // Soft edges compress better
+};
+
+static constexpr HMS_CAM_SensorProfileTypeDef sensorOV5640Profile = {
+    "ov5640", sensorOV5640Entries, (uint8_t)(sizeof(sensorOV5640Entries) / sizeof(sensorOV5640Entries[0]))
+};
+
+static constexpr HMS_CAM_SensorModeTypeDef sensorOV5640Modes[] = {
+    { FRAMESIZE_HD,     60, true,  0 },                                                     // 2x2 binned
+    { FRAMESIZE_FHD,    30, true,  0 },                                                     // Cropped window
+    { FRAMESIZE_QSXGA,  15, false, 0 },
+};
+
+static constexpr HMS_CAM_SensorClockTypeDef sensorOV5640Clocks[] = {
+    { 20000000, 0, 200, 4, 2, 0, 2, 1, 2 },                                                 // 20 MHz PCLK
+    { 0,        0, 160, 4, 2, 0, 2, 1, 2 },                                                 // 16 MHz XCLK
+};
+
+static constexpr HMS_CAM_SensorEntryTypeDef sensorOV7670Entries[] = {
+    { HMS_CAM_SENSOR_WHITEBAL,          1   },
+    { HMS_CAM_SENSOR_EXPOSURE_CTRL,     1   },
+    { HMS_CAM_SENSOR_GAIN_CTRL,         1   },
+    { HMS_CAM_SENSOR_HMIRROR,           0   },
+    { HMS_CAM_SENSOR_VFLIP,             0   },
+    { HMS_CAM_SENSOR_COLORBAR,          0   },
+};
+
+static constexpr HMS_CAM_SensorProfileTypeDef sensorOV7670Profile = {
+    "ov7670", sensorOV7670Entries, (uint8_t)(sizeof(sensorOV7670Entries) / sizeof(sensorOV7670Entries[0]))
+};
+
+static constexpr HMS_CAM_SensorModeTypeDef sensorOV7670Modes[] = {
+    { FRAMESIZE_VGA,    30, false, 0 },
+};
+
+#define HMS_CAM_SENSOR_COUNT(table)     (uint8_t)(sizeof(table) / sizeof(table[0]))
+
+static constexpr HMS_CAM_SensorDriverTypeDef sensorBuiltinDrivers[] = {
+    { HMS_CAM_OV2640, OV2640_PID, "OV2640", 24000000, 24000000, true,  10,                  // Low quality values overflow the fb
+      sensorOV2640Modes, HMS_CAM_SENSOR_COUNT(sensorOV2640Modes), NULL, 0,                  // CLKRC is set per window by the driver
+      &sensorDefaultProfile, &sensorHighFpsProfile,
+      HMS_CAM_SENSOR_WINDOW_MODE, {} },                                                     // set_res_raw() takes ov2640_sensor_mode_t
+    { HMS_CAM_OV3660, OV3660_PID, "OV3660", 24000000, 27000000, true,  4,
+      sensorOV3660Modes, HMS_CAM_SENSOR_COUNT(sensorOV3660Modes),
+      sensorOV3660Clocks, HMS_CAM_SENSOR_COUNT(sensorOV3660Clocks),
+      &sensorOV3660Profile, &sensorHighFpsProfile,
+      HMS_CAM_SENSOR_WINDOW_ARRAY, { 31, 11, 16, 6, 2300, 17 } },
+    { HMS_CAM_OV5640, OV5640_PID, "OV5640", 24000000, 54000000, true,  4,
+      sensorOV5640Modes, HMS_CAM_SENSOR_COUNT(sensorOV5640Modes),
+      sensorOV5640Clocks, HMS_CAM_SENSOR_COUNT(sensorOV5640Clocks),
+      &sensorOV5640Profile, &sensorHighFpsProfile,
+      HMS_CAM_SENSOR_WINDOW_ARRAY, { 63, 31, 32, 16, 2844, 17 } },
+    { HMS_CAM_OV7670, OV7670_PID, "OV7670", 24000000, 48000000, false, 0,                   // Raw formats only
+      sensorOV7670Modes, HMS_CAM_SENSOR_COUNT(sensorOV7670Modes), NULL, 0,
+      &sensorOV7670Profile, NULL,
+      HMS_CAM_SENSOR_WINDOW_NONE, {} },
+};
+
+static const HMS_CAM_SensorDriverTypeDef *sensorDrivers[HMS_CAM_SENSOR_MAX_DRIVERS];
+static uint8_t sensorDriverCount = 0;
+
+static inline bool sensorFits(framesize_t size, framesize_t mode) {
+    return resolution[size].width <= resolution[mode].width && resolution[size].height <= resolution[mode].height;
+}
+
+static inline uint32_t sensorModeFps(const HMS_CAM_SensorDriverTypeDef &driver, const HMS_CAM_SensorModeTypeDef &mode,
+                                     uint32_t xclkHz) {
+    uint32_t xclk = xclkHz < driver.maxXclkHz ? xclkHz : driver.maxXclkHz;
+    return (uint32_t)((uint64_t)mode.fps * xclk / driver.refXclkHz);                        // Pixel clock scales with XCLK
+}
+
+const HMS_CAM_SensorProfileTypeDef& HMS_CAM_Sensor::defaultProfile() {
+    return sensorDefaultProfile;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_Sensor::apply(sensor_t *sensor, const HMS_CAM_SensorProfileTypeDef &profile, bool force,
+                                            HMS_CAM_SensorApplyTypeDef &report) {
+    report = {};
+    if (sensor == NULL) {
+        return HMS_CAM_ERROR;
+    }
+
+    int64_t start = HMS_CAM_Micros();
+    for (uint8_t i = 0; i < profile.count; i++) {
+        HMS_CAM_SensorSetting setting = (HMS_CAM_SensorSetting)profile.entries[i].setting;
+        int                   value   = profile.entries[i].value;
+
+        if (!isSupported(sensor, setting)) {
+            report.unsupported++;
+            continue;
+        }
+        if (!force && read(sensor, setting) == value) {
+            report.skipped++;                                                               // No SCCB transaction
+            continue;
+        }
+        if (write(sensor, setting, value) != 0) {
+            HMS_CAM_LOGGER(warn, "Sensor %s = %d failed", settingName(setting), value);
+            report.failed++;
+            continue;
+        }
+        report.written++;
+    }
+    report.durationUs = (uint32_t)(HMS_CAM_Micros() - start);
+
+    HMS_CAM_LOGGER(debug, "Sensor profile %s: %u written, %u skipped in %u us", profile.name,
+                   report.written, report.skipped, (unsigned)report.durationUs);
+    return HMS_CAM_OK;
+}
+
+bool HMS_CAM_Sensor::isSupported(const sensor_t *sensor, HMS_CAM_SensorSetting setting) {
+    switch (setting) {
+        #define HMS_CAM_SENSOR_SUPPORTED(id, setter, field)                                 \
+            case HMS_CAM_SENSOR_##id:           return sensor->set_##setter != NULL;
+        HMS_CAM_SENSOR_SETTINGS(HMS_CAM_SENSOR_SUPPORTED)
+        #undef HMS_CAM_SENSOR_SUPPORTED
+        case HMS_CAM_SENSOR_GAINCEILING:        return sensor->set_gainceiling != NULL;
+        default:                                return false;
+    }
+}
+
+int HMS_CAM_Sensor::read(const sensor_t *sensor, HMS_CAM_SensorSetting setting) {
+    switch (setting) {
+        #define HMS_CAM_SENSOR_READ(id, setter, field)                                      \
+            case HMS_CAM_SENSOR_##id:           return sensor->status.field;
+        HMS_CAM_SENSOR_SETTINGS(HMS_CAM_SENSOR_READ)
+        #undef HMS_CAM_SENSOR_READ
+        case HMS_CAM_SENSOR_GAINCEILING:        return sensor->status.gainceiling;
+        default:                                return -1;
+    }
+}
+
+int HMS_CAM_Sensor::write(sensor_t *sensor, HMS_CAM_SensorSetting setting, int value) {
+    if (!isSupported(sensor, setting)) {
+        return -1;
+    }
+    switch (setting) {
+        #define HMS_CAM_SENSOR_WRITE(id, setter, field)                                     \
+            case HMS_CAM_SENSOR_##id:           return sensor->set_##setter(sensor, value);
+        HMS_CAM_SENSOR_SETTINGS(HMS_CAM_SENSOR_WRITE)
+        #undef HMS_CAM_SENSOR_WRITE
+        case HMS_CAM_SENSOR_GAINCEILING:        return sensor->set_gainceiling(sensor, (gainceiling_t)value);
+        default:                                return -1;
+    }
+}
+
+const char* HMS_CAM_Sensor::settingName(HMS_CAM_SensorSetting setting) {
+    switch (setting) {
+        #define HMS_CAM_SENSOR_NAME(id, setter, field)                                      \
+            case HMS_CAM_SENSOR_##id:           return #setter;
+        HMS_CAM_SENSOR_SETTINGS(HMS_CAM_SENSOR_NAME)
+        #undef HMS_CAM_SENSOR_NAME
+        case HMS_CAM_SENSOR_GAINCEILING:        return "gainceiling";
+        default:                                return "unknown";
+    }
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_Sensor::registerDriver(const HMS_CAM_SensorDriverTypeDef *driver) {
+    if (driver == NULL || driver->modes == NULL || driver->modeCount == 0 || driver->refXclkHz == 0) {
+        return HMS_CAM_ERROR;
+    }
+    for (uint8_t i = 0; i < sensorDriverCount; i++) {
+        if (sensorDrivers[i]->pid == driver->pid) {
+            sensorDrivers[i] = driver;                                                      // Replace the earlier registration
+            return HMS_CAM_OK;
+        }
+    }
+    if (sensorDriverCount >= HMS_CAM_SENSOR_MAX_DRIVERS) {
+        return HMS_CAM_NO_MEM;
+    }
+    sensorDrivers[sensorDriverCount++] = driver;
+    return HMS_CAM_OK;
+}
+
+const HMS_CAM_SensorDriverTypeDef* HMS_CAM_Sensor::findDriver(uint16_t pid) {
+    for (uint8_t i = 0; i < sensorDriverCount; i++) {
+        if (sensorDrivers[i]->pid == pid) {
+            return sensorDrivers[i];
+        }
+    }
+    for (const HMS_CAM_SensorDriverTypeDef &driver : sensorBuiltinDrivers) {
+        if (driver.pid == pid) {
+            return &driver;
+        }
+    }
+    return NULL;
+}
+
+const HMS_CAM_SensorDriverTypeDef* HMS_CAM_Sensor::findDriver(HMS_CAM_ModuleType module) {
+    for (uint8_t i = 0; i < sensorDriverCount; i++) {
+        if (sensorDrivers[i]->module == module) {
+            return sensorDrivers[i];
+        }
+    }
+    for (const HMS_CAM_SensorDriverTypeDef &driver : sensorBuiltinDrivers) {
+        if (driver.module == module) {
+            return &driver;
+        }
+    }
+    return NULL;
+}
+
+const HMS_CAM_SensorDriverTypeDef* HMS_CAM_Sensor::detect(const sensor_t *sensor) {
+    return sensor ? findDriver(sensor->id.PID) : NULL;
+}
+
+const HMS_CAM_SensorModeTypeDef& HMS_CAM_Sensor::modeFor(const HMS_CAM_SensorDriverTypeDef &driver, framesize_t size) {
+    for (uint8_t i = 0; i < driver.modeCount; i++) {
+        if (sensorFits(size, driver.modes[i].maxFrameSize)) {
+            return driver.modes[i];                                                         // Smallest window that holds the frame
+        }
+    }
+    return driver.modes[driver.modeCount - 1];
+}
+
+uint32_t HMS_CAM_Sensor::frameTimeUs(const HMS_CAM_SensorDriverTypeDef &driver, framesize_t size, uint32_t xclkHz) {
+    uint32_t fps = sensorModeFps(driver, modeFor(driver, size), xclkHz);
+    return fps ? 1000000 / fps : 1000000;
+}
+
+framesize_t HMS_CAM_Sensor::maxFrameSizeFor(const HMS_CAM_SensorDriverTypeDef &driver, uint8_t fps, uint32_t xclkHz) {
+    for (int i = driver.modeCount - 1; i >= 0; i--) {
+        if (sensorModeFps(driver, driver.modes[i], xclkHz) >= fps) {
+            return driver.modes[i].maxFrameSize;
+        }
+    }
+    return FRAMESIZE_INVALID;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_Sensor::applyClock(sensor_t *sensor, const HMS_CAM_SensorDriverTypeDef &driver, uint32_t xclkHz) {
+    if (sensor == NULL) {
+        return HMS_CAM_ERROR;
+    }
+    for (uint8_t i = 0; i < driver.clockCount; i++) {
+        const HMS_CAM_SensorClockTypeDef &clock = driver.clocks[i];
+        if (xclkHz < clock.xclkHz) {
+            continue;
+        }
+        if (sensor->set_pll == NULL || sensor->set_pll(sensor, clock.bypass, clock.mul, clock.sys, clock.root, clock.pre,
+                                                       clock.seld5, clock.pclken, clock.pclk) != 0) {
+            HMS_CAM_LOGGER(warn, "%s: set_pll for %u Hz XCLK failed", driver.name, (unsigned)xclkHz);
+            return HMS_CAM_ERROR;
+        }
+        return HMS_CAM_OK;
+    }
+    return HMS_CAM_NOT_FOUND;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_Sensor::setWindow(sensor_t *sensor, const HMS_CAM_SensorDriverTypeDef &driver,
+                                                HMS_CAM_SensorWindowTypeDef &window) {
+    if (sensor == NULL || sensor->set_res_raw == NULL || driver.windowing == HMS_CAM_SENSOR_WINDOW_NONE) {
+        HMS_CAM_LOGGER(error, "%s has no raw windowing", driver.name);
+        return HMS_CAM_ERROR;
+    }
+
+    const resolution_info_t &array = resolution[driver.modes[driver.modeCount - 1].maxFrameSize];
+    window.x         &= ~3;
+    window.y         &= ~3;
+    window.width     &= ~3;
+    window.height    &= ~3;
+    window.outWidth  &= ~15;
+    window.outHeight &= ~7;
+    if (window.outWidth < 16 || window.outHeight < 8 || window.outWidth > window.width || window.outHeight > window.height ||
+        window.x + window.width > array.width || window.y + window.height > array.height) {
+        HMS_CAM_LOGGER(error, "Window %ux%u+%u+%u -> %ux%u does not fit the %ux%u array", window.width, window.height,
+                       window.x, window.y, window.outWidth, window.outHeight, array.width, array.height);
+        return HMS_CAM_ERROR;
+    }
+
+    int ret = -1;
+    if (driver.windowing == HMS_CAM_SENSOR_WINDOW_MODE) {
+        for (uint8_t i = 0; i < driver.modeCount; i++) {                                    // Fastest mode that keeps the detail
+            const resolution_info_t &mode = resolution[driver.modes[i].maxFrameSize];
+            uint32_t x = (uint32_t)window.x * mode.width / array.width;
+            uint32_t y = (uint32_t)window.y * mode.height / array.height;
+            uint32_t w = (uint32_t)window.width * mode.width / array.width;
+            uint32_t h = (uint32_t)window.height * mode.height / array.height;
+            if (w < window.outWidth || h < window.outHeight || x + w > mode.width || y + h > mode.height) {
+                continue;
+            }
+            ret = sensor->set_res_raw(sensor, driver.modes[i].rawMode, 0, 0, 0, x, y, w, h,
+                                      window.outWidth, window.outHeight, false, false);
+            break;
+        }
+    } else {
+        const HMS_CAM_SensorWindowRegsTypeDef &regs = driver.windowRegs;
+        int endY = window.y + window.height + regs.marginY;
+        ret = sensor->set_res_raw(sensor, window.x, window.y, window.x + window.width + regs.marginX, endY,
+                                  regs.offsetX, regs.offsetY, regs.hts, endY - window.y + regs.vblank,   // Fewer lines, shorter frame
+                                  window.outWidth, window.outHeight,
+                                  window.outWidth != window.width || window.outHeight != window.height, false);
+    }
+    if (ret != 0) {
+        HMS_CAM_LOGGER(warn, "%s: set_res_raw failed", driver.name);
+        return HMS_CAM_ERROR;
+    }
+    return HMS_CAM_OK;
+}
+
+#endif // HMS_CAM_HAS_CAMERA_API
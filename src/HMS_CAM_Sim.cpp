@@ -0,0 +1,1185 @@
+#include "HMS_CAM_Sim.h"
+#include "HMS_CAM_JPEG.h"
+#include "HMS_CAM_Sensor.h"
+#include "HMS_CAM_Planner.h"
+#include "HMS_CAM_Recorder.h"
+
+#ifdef HMS_CAM_PLATFORM_DESKTOP
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <filesystem>
+
+#if !defined(_WIN32)
+  #include <fcntl.h>
+  #include <unistd.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+#endif
+
+const resolution_info_t resolution[FRAMESIZE_INVALID] = {
+    {   96,   96, ASPECT_RATIO_1X1   },                                                     // 96x96
+    {  160,  120, ASPECT_RATIO_4X3   },                                                     // QQVGA
+    {  128,  128, ASPECT_RATIO_1X1   },                                                     // 128x128
+    {  176,  144, ASPECT_RATIO_5X4   },                                                     // QCIF
+    {  240,  176, ASPECT_RATIO_4X3   },                                                     // HQVGA
+    {  240,  240, ASPECT_RATIO_1X1   },                                                     // 240x240
+    {  320,  240, ASPECT_RATIO_4X3   },                                                     // QVGA
+    {  320,  320, ASPECT_RATIO_1X1   },                                                     // 320x320
+    {  400,  296, ASPECT_RATIO_4X3   },                                                     // CIF
+    {  480,  320, ASPECT_RATIO_3X2   },                                                     // HVGA
+    {  640,  480, ASPECT_RATIO_4X3   },                                                     // VGA
+    {  800,  600, ASPECT_RATIO_4X3   },                                                     // SVGA
+    { 1024,  768, ASPECT_RATIO_4X3   },                                                     // XGA
+    { 1280,  720, ASPECT_RATIO_16X9  },                                                     // HD
+    { 1280, 1024, ASPECT_RATIO_5X4   },                                                     // SXGA
+    { 1600, 1200, ASPECT_RATIO_4X3   },                                                     // UXGA
+    { 1920, 1080, ASPECT_RATIO_16X9  },                                                     // FHD
+    {  720, 1280, ASPECT_RATIO_9X16  },                                                     // Portrait HD
+    {  864, 1536, ASPECT_RATIO_9X16  },                                                     // Portrait 3MP
+    { 2048, 1536, ASPECT_RATIO_4X3   },                                                     // QXGA
+    { 2560, 1440, ASPECT_RATIO_16X9  },                                                     // QHD
+    { 2560, 1600, ASPECT_RATIO_16X10 },                                                     // WQXGA
+    { 1080, 1920, ASPECT_RATIO_9X16  },                                                     // Portrait FHD
+    { 2560, 1920, ASPECT_RATIO_4X3   },                                                     // QSXGA
+    { 2592, 1944, ASPECT_RATIO_4X3   },                                                     // 5MP
+};
+
+void simSCCB(sensor_t *sensor) {
+    HMS_CAM_SimSensor *sim = static_cast<HMS_CAM_SimSensor*>(sensor->priv);
+    sim->_sccbWrites.fetch_add(1, std::memory_order_relaxed);
+    if (sim->_sccbUs) {
+        std::this_thread::sleep_for(std::chrono::microseconds(sim->_sccbUs));              // Register write over SCCB
+    }
+}
+
+namespace {
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Minimal baseline JPEG encoder (YCbCr 4:2:2, standard tables)  │
+  │       Only used to render test patterns at init, never per frame.   │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+
+const uint8_t kZigZag[64] = {
+     0,  1,  8, 16,  9,  2,  3, 10, 17, 24, 32, 25, 18, 11,  4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13,  6,  7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63
+};
+
+const uint8_t kLumaQuant[64] = {
+    16, 11, 10, 16,  24,  40,  51,  61,  12, 12, 14, 19,  26,  58,  60,  55,
+    14, 13, 16, 24,  40,  57,  69,  56,  14, 17, 22, 29,  51,  87,  80,  62,
+    18, 22, 37, 56,  68, 109, 103,  77,  24, 35, 55, 64,  81, 104, 113,  92,
+    49, 64, 78, 87, 103, 121, 120, 101,  72, 92, 95, 98, 112, 100, 103,  99
+};
+
+const uint8_t kChromaQuant[64] = {
+    17, 18, 24, 47, 99, 99, 99, 99,  18, 21, 26, 66, 99, 99, 99, 99,
+    24, 26, 56, 99, 99, 99, 99, 99,  47, 66, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,  99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,  99, 99, 99, 99, 99, 99, 99, 99
+};
+
+const uint8_t kDcLumaBits[16]   = { 0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0 };
+const uint8_t kDcChromaBits[16] = { 0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0 };
+const uint8_t kDcVals[12]       = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+
+const uint8_t kAcLumaBits[16]   = { 0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d };
+const uint8_t kAcLumaVals[162]  = {
+    0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+    0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xa1, 0x08, 0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0,
+    0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+    0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+    0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+    0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7,
+    0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5,
+    0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2,
+    0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+    0xf9, 0xfa
+};
+
+const uint8_t kAcChromaBits[16] = { 0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77 };
+const uint8_t kAcChromaVals[162] = {
+    0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+    0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xa1, 0xb1, 0xc1, 0x09, 0x23, 0x33, 0x52, 0xf0,
+    0x15, 0x62, 0x72, 0xd1, 0x0a, 0x16, 0x24, 0x34, 0xe1, 0x25, 0xf1, 0x17, 0x18, 0x19, 0x1a, 0x26,
+    0x27, 0x28, 0x29, 0x2a, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+    0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+    0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+    0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5,
+    0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3,
+    0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda,
+    0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+    0xf9, 0xfa
+};
+
+struct HuffTable {
+    uint16_t code[256];
+    uint8_t  size[256];
+
+    void build(const uint8_t *bits, const uint8_t *vals) {
+        memset(size, 0, sizeof(size));
+        uint16_t next = 0;
+        int k = 0;
+        for (int len = 1; len <= 16; len++) {
+            for (int i = 0; i < bits[len - 1]; i++, k++) {
+                code[vals[k]] = next++;
+                size[vals[k]] = (uint8_t)len;
+            }
+            next <<= 1;
+        }
+    }
+};
+
+class JpegWriter {
+public:
+    explicit JpegWriter(std::vector<uint8_t> &out) : _out(out) {}
+
+    void marker(uint8_t m)                                  { _out.push_back(0xFF); _out.push_back(m); }
+    void u8(uint8_t v)                                      { _out.push_back(v); }
+    void u16(uint16_t v)                                    { _out.push_back(v >> 8); _out.push_back(v & 0xFF); }
+
+    void bits(uint32_t code, int size) {
+        _acc    = (_acc << size) | (code & ((1u << size) - 1));
+        _count += size;
+        while (_count >= 8) {
+            uint8_t b = (uint8_t)(_acc >> (_count - 8));
+            _out.push_back(b);
+            if (b == 0xFF) _out.push_back(0x00);                                            // Byte stuffing
+            _count -= 8;
+        }
+        _acc &= (1u << _count) - 1;
+    }
+
+    void flush() {
+        if (_count > 0) bits(0x7F, 8 - _count);                                             // Pad with 1-bits
+    }
+
+private:
+    std::vector<uint8_t>    &_out;
+    uint32_t                _acc    = 0;
+    int                     _count  = 0;
+};
+
+void simJpegQuant(int quality, const uint8_t *base, uint8_t *table) {
+    int ijg   = std::min(100, std::max(1, 100 - (quality * 100) / 64));                     // esp32-camera 0-63 → IJG 1-100
+    int scale = ijg < 50 ? 5000 / ijg : 200 - ijg * 2;
+    for (int i = 0; i < 64; i++) {
+        table[i] = (uint8_t)std::min(255, std::max(1, (base[i] * scale + 50) / 100));
+    }
+}
+
+void simJpegBlock(JpegWriter &w, const float *block, const uint8_t *quant, int &prevDc,
+                  const HuffTable &dc, const HuffTable &ac) {
+    static const struct CosTable {                                                          // Built once, thread-safe static init
+        float v[8][8];
+        CosTable() {
+            for (int u = 0; u < 8; u++) {
+                for (int x = 0; x < 8; x++) {
+                    float cu = (u == 0) ? 0.70710678f : 1.0f;
+                    v[u][x] = 0.5f * cu * cosf((2 * x + 1) * u * 3.14159265f / 16.0f);
+                }
+            }
+        }
+    } cosTable;
+
+    float tmp[64];
+    for (int y = 0; y < 8; y++) {                                                           // Rows
+        for (int u = 0; u < 8; u++) {
+            float s = 0;
+            for (int x = 0; x < 8; x++) s += cosTable.v[u][x] * block[y * 8 + x];
+            tmp[y * 8 + u] = s;
+        }
+    }
+
+    int coef[64];
+    for (int u = 0; u < 8; u++) {                                                           // Columns + quantization
+        for (int v = 0; v < 8; v++) {
+            float s = 0;
+            for (int y = 0; y < 8; y++) s += cosTable.v[v][y] * tmp[y * 8 + u];
+            coef[v * 8 + u] = (int)lroundf(s / quant[v * 8 + u]);
+        }
+    }
+
+    auto category = [](int v) {
+        int a = v < 0 ? -v : v, n = 0;
+        while (a) { n++; a >>= 1; }
+        return n;
+    };
+
+    int diff = coef[0] - prevDc;
+    prevDc   = coef[0];
+    int cat  = category(diff);
+    w.bits(dc.code[cat], dc.size[cat]);
+    if (cat) w.bits(diff < 0 ? diff - 1 : diff, cat);
+
+    int run = 0;
+    for (int k = 1; k < 64; k++) {
+        int v = coef[kZigZag[k]];
+        if (v == 0) { run++; continue; }
+        while (run > 15) {
+            w.bits(ac.code[0xF0], ac.size[0xF0]);                                           // ZRL
+            run -= 16;
+        }
+        cat = category(v);
+        int sym = (run << 4) | cat;
+        w.bits(ac.code[sym], ac.size[sym]);
+        w.bits(v < 0 ? v - 1 : v, cat);
+        run = 0;
+    }
+    if (run) w.bits(ac.code[0x00], ac.size[0x00]);                                          // EOB
+}
+
+void simJpegEncode(const uint8_t *rgb, int width, int height, int quality, std::vector<uint8_t> &out) {
+    static const struct HuffTables {                                                        // Shared by every simulated sensor
+        HuffTable dcLuma, acLuma, dcChroma, acChroma;
+        HuffTables() {
+            dcLuma.build(kDcLumaBits, kDcVals);
+            acLuma.build(kAcLumaBits, kAcLumaVals);
+            dcChroma.build(kDcChromaBits, kDcVals);
+            acChroma.build(kAcChromaBits, kAcChromaVals);
+        }
+    } tables;
+
+    uint8_t qLuma[64], qChroma[64];
+    simJpegQuant(quality, kLumaQuant, qLuma);
+    simJpegQuant(quality, kChromaQuant, qChroma);
+
+    out.clear();
+    out.reserve((size_t)width * height / 4);
+    JpegWriter w(out);
+
+    w.marker(0xD8);                                                                         // SOI
+
+    w.marker(0xDB); w.u16(132);                                                             // DQT
+    w.u8(0x00); for (int i = 0; i < 64; i++) w.u8(qLuma[kZigZag[i]]);
+    w.u8(0x01); for (int i = 0; i < 64; i++) w.u8(qChroma[kZigZag[i]]);
+
+    w.marker(0xC0); w.u16(17); w.u8(8);                                                     // SOF0, 4:2:2
+    w.u16((uint16_t)height); w.u16((uint16_t)width); w.u8(3);
+    w.u8(1); w.u8(0x21); w.u8(0);
+    w.u8(2); w.u8(0x11); w.u8(1);
+    w.u8(3); w.u8(0x11); w.u8(1);
+
+    auto dht = [&](uint8_t cls, const uint8_t *bits, const uint8_t *vals, int count) {
+        w.u8(cls);
+        for (int i = 0; i < 16; i++) w.u8(bits[i]);
+        for (int i = 0; i < count; i++) w.u8(vals[i]);
+    };
+    w.marker(0xC4); w.u16(418);                                                             // DHT
+    dht(0x00, kDcLumaBits, kDcVals, 12);
+    dht(0x10, kAcLumaBits, kAcLumaVals, 162);
+    dht(0x01, kDcChromaBits, kDcVals, 12);
+    dht(0x11, kAcChromaBits, kAcChromaVals, 162);
+
+    w.marker(0xDA); w.u16(12); w.u8(3);                                                     // SOS
+    w.u8(1); w.u8(0x00);
+    w.u8(2); w.u8(0x11);
+    w.u8(3); w.u8(0x11);
+    w.u8(0); w.u8(63); w.u8(0);
+
+    int   dcY = 0, dcCb = 0, dcCr = 0;
+    float y0[64], y1[64], cb[64], cr[64];
+    for (int my = 0; my < height; my += 8) {
+        for (int mx = 0; mx < width; mx += 16) {
+            for (int j = 0; j < 8; j++) {
+                int py = std::min(my + j, height - 1);
+                for (int i = 0; i < 16; i++) {
+                    int px = std::min(mx + i, width - 1);
+                    const uint8_t *p = &rgb[((size_t)py * width + px) * 3];
+                    float Y  =  0.299f   * p[0] + 0.587f   * p[1] + 0.114f   * p[2];
+                    float Cb = -0.16874f * p[0] - 0.33126f * p[1] + 0.5f     * p[2];
+                    float Cr =  0.5f     * p[0] - 0.41869f * p[1] - 0.08131f * p[2];
+                    if (i < 8) y0[j * 8 + i] = Y - 128.0f; else y1[j * 8 + i - 8] = Y - 128.0f;
+                    if (i & 1) {
+                        cb[j * 8 + i / 2] = (cb[j * 8 + i / 2] + Cb) * 0.5f;
+                        cr[j * 8 + i / 2] = (cr[j * 8 + i / 2] + Cr) * 0.5f;
+                    } else {
+                        cb[j * 8 + i / 2] = Cb;
+                        cr[j * 8 + i / 2] = Cr;
+                    }
+                }
+            }
+            simJpegBlock(w, y0, qLuma,   dcY,  tables.dcLuma,   tables.acLuma);
+            simJpegBlock(w, y1, qLuma,   dcY,  tables.dcLuma,   tables.acLuma);
+            simJpegBlock(w, cb, qChroma, dcCb, tables.dcChroma, tables.acChroma);
+            simJpegBlock(w, cr, qChroma, dcCr, tables.dcChroma, tables.acChroma);
+        }
+    }
+    w.flush();
+    w.marker(0xD9);                                                                         // EOI
+}
+
+size_t simBytesPerPixel(pixformat_t format) {
+    switch (format) {
+        case PIXFORMAT_GRAYSCALE:   return 1;
+        case PIXFORMAT_RGB565:
+        case PIXFORMAT_YUV422:      return 2;
+        case PIXFORMAT_RGB888:      return 3;
+        default:                    return 0;
+    }
+}
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Pattern rendering (RGB888 master, converted per pixformat)    │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+
+void simRenderPattern(HMS_CAM_SimPattern pattern, int index, int count, int width, int height,
+                      std::mt19937 &rng, std::vector<uint8_t> &rgb) {
+    static const uint8_t bars[8][3] = {
+        { 255, 255, 255 }, { 255, 255,   0 }, {   0, 255, 255 }, {   0, 255,   0 },
+        { 255,   0, 255 }, { 255,   0,   0 }, {   0,   0, 255 }, {   0,   0,   0 }
+    };
+
+    rgb.resize((size_t)width * height * 3);
+    uint8_t *p = rgb.data();
+
+    int boxW = std::max(8, width / 6), boxH = std::max(8, height / 6);
+    int span = std::max(1, count - 1);
+    int boxX = (width - boxW) * index / span;
+    int boxY = (height - boxH) * ((index * 2) % (span + 1)) / span;
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++, p += 3) {
+            switch (pattern) {
+                case HMS_CAM_SIM_COLOR_BARS: {
+                    const uint8_t *c = bars[(x * 8) / width];
+                    p[0] = c[0]; p[1] = c[1]; p[2] = c[2];
+                    break;
+                }
+                case HMS_CAM_SIM_NOISE: {
+                    uint32_t r = rng();
+                    p[0] = (uint8_t)r; p[1] = (uint8_t)(r >> 8); p[2] = (uint8_t)(r >> 16);
+                    break;
+                }
+                case HMS_CAM_SIM_MOVING_BOX:
+                    if (x >= boxX && x < boxX + boxW && y >= boxY && y < boxY + boxH) {
+                        p[0] = 240; p[1] = 32; p[2] = 32;
+                        break;
+                    }
+                    // fall through
+                case HMS_CAM_SIM_GRADIENT:
+                default:
+                    p[0] = (uint8_t)(x * 255 / width);
+                    p[1] = (uint8_t)(y * 255 / height);
+                    p[2] = (uint8_t)((x + y) * 255 / (width + height));
+                    break;
+            }
+        }
+    }
+}
+
+void simCrop(const std::vector<uint8_t> &rgb, int width, int x, int y, int w, int h, int outWidth, int outHeight,
+             std::vector<uint8_t> &out) {
+    out.resize((size_t)outWidth * outHeight * 3);
+    uint8_t *p = out.data();
+    for (int oy = 0; oy < outHeight; oy++) {
+        const uint8_t *row = rgb.data() + (size_t)(y + oy * h / outHeight) * width * 3;
+        for (int ox = 0; ox < outWidth; ox++, p += 3) {
+            const uint8_t *s = row + (size_t)(x + ox * w / outWidth) * 3;                   // Nearest neighbour, like the ISP
+            p[0] = s[0]; p[1] = s[1]; p[2] = s[2];
+        }
+    }
+}
+
+bool simConvert(const std::vector<uint8_t> &rgb, int width, int height, pixformat_t format, int quality,
+                std::vector<uint8_t> &out) {
+    size_t pixels = (size_t)width * height;
+    const uint8_t *s = rgb.data();
+
+    auto luma = [](const uint8_t *p) { return (uint8_t)((77 * p[0] + 150 * p[1] + 29 * p[2]) >> 8); };
+
+    switch (format) {
+        case PIXFORMAT_JPEG:
+            simJpegEncode(s, width, height, quality, out);
+            return true;
+        case PIXFORMAT_RGB888:
+            out = rgb;
+            return true;
+        case PIXFORMAT_GRAYSCALE:
+            out.resize(pixels);
+            for (size_t i = 0; i < pixels; i++) out[i] = luma(&s[i * 3]);
+            return true;
+        case PIXFORMAT_RGB565:
+            out.resize(pixels * 2);
+            for (size_t i = 0; i < pixels; i++) {
+                const uint8_t *p = &s[i * 3];
+                uint16_t v = (uint16_t)(((p[0] >> 3) << 11) | ((p[1] >> 2) << 5) | (p[2] >> 3));
+                out[i * 2]     = (uint8_t)(v >> 8);                                             // DVP order: high byte first
+                out[i * 2 + 1] = (uint8_t)(v & 0xFF);
+            }
+            return true;
+        case PIXFORMAT_YUV422:
+            out.resize(pixels * 2);
+            for (size_t i = 0; i + 1 < pixels; i += 2) {
+                const uint8_t *a = &s[i * 3], *b = &s[(i + 1) * 3];
+                int r = (a[0] + b[0]) / 2, g = (a[1] + b[1]) / 2, bl = (a[2] + b[2]) / 2;
+                out[i * 2]     = luma(a);
+                out[i * 2 + 1] = (uint8_t)std::min(255, std::max(0, ((-43 * r - 85 * g + 128 * bl) >> 8) + 128));
+                out[i * 2 + 2] = luma(b);
+                out[i * 2 + 3] = (uint8_t)std::min(255, std::max(0, ((128 * r - 107 * g - 21 * bl) >> 8) + 128));
+            }
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool simReadFile(const std::filesystem::path &path, std::vector<uint8_t> &out) {
+    FILE *f = fopen(path.string().c_str(), "rb");
+    if (!f) return false;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    out.resize(size > 0 ? (size_t)size : 0);
+    bool ok = size > 0 && fread(out.data(), 1, out.size(), f) == out.size();
+    fclose(f);
+    return ok;
+}
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Emulated sensor_t control block                               │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+
+#define HMS_CAM_SIM_SETTER(name, field)                                     \
+    int simSet_##name(sensor_t *sensor, int value) {                        \
+        simSCCB(sensor);                                                    \
+        sensor->status.field = value;                                       \
+        return 0;                                                           \
+    }
+
+HMS_CAM_SIM_SETTER(contrast,        contrast)
+HMS_CAM_SIM_SETTER(brightness,      brightness)
+HMS_CAM_SIM_SETTER(saturation,      saturation)
+HMS_CAM_SIM_SETTER(sharpness,       sharpness)
+HMS_CAM_SIM_SETTER(denoise,         denoise)
+HMS_CAM_SIM_SETTER(colorbar,        colorbar)
+HMS_CAM_SIM_SETTER(whitebal,        awb)
+HMS_CAM_SIM_SETTER(gain_ctrl,       agc)
+HMS_CAM_SIM_SETTER(exposure_ctrl,   aec)
+HMS_CAM_SIM_SETTER(hmirror,         hmirror)
+HMS_CAM_SIM_SETTER(vflip,           vflip)
+HMS_CAM_SIM_SETTER(aec2,            aec2)
+HMS_CAM_SIM_SETTER(awb_gain,        awb_gain)
+HMS_CAM_SIM_SETTER(agc_gain,        agc_gain)
+HMS_CAM_SIM_SETTER(aec_value,       aec_value)
+HMS_CAM_SIM_SETTER(special_effect,  special_effect)
+HMS_CAM_SIM_SETTER(wb_mode,         wb_mode)
+HMS_CAM_SIM_SETTER(ae_level,        ae_level)
+HMS_CAM_SIM_SETTER(dcw,             dcw)
+HMS_CAM_SIM_SETTER(bpc,             bpc)
+HMS_CAM_SIM_SETTER(wpc,             wpc)
+HMS_CAM_SIM_SETTER(raw_gma,         raw_gma)
+HMS_CAM_SIM_SETTER(lenc,            lenc)
+
+int simSetGainceiling(sensor_t *sensor, gainceiling_t gainceiling) {
+    simSCCB(sensor);
+    sensor->status.gainceiling = (uint8_t)gainceiling;
+    return 0;
+}
+
+int simInitStatus(sensor_t *sensor)                                                         { (void)sensor; return 0; }
+int simReset(sensor_t *sensor)                                                              { (void)sensor; return 0; }
+int simGetReg(sensor_t *sensor, int reg, int mask)                                          { (void)sensor; (void)reg; (void)mask; return -1; }
+int simSetReg(sensor_t *sensor, int reg, int mask, int value)                               { (void)sensor; (void)reg; (void)mask; (void)value; return -1; }
+int simSetXclk(sensor_t *sensor, int timer, int xclk)                                       { (void)timer; sensor->xclk_freq_hz = xclk * 1000000; return 0; }
+int simSetPll(sensor_t *sensor, int, int, int, int, int, int, int, int)                    { simSCCB(sensor); return 0; }
+
+} // namespace
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Simulated heap, one buffer per allocation like esp32-camera.  │
+  │       Free space is modelled as the largest block plus one block    │
+  │       holding the rest, so a fragmented region can fail where the   │
+  │       planner's free-space check passes. DMA line buffers always    │
+  │       come out of DRAM.                                             │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+static bool simHeapFits(const HMS_CAM_MemoryTypeDef &memory, camera_fb_location_t location, size_t bytes, size_t count) {
+    if (memory.dramFree < HMS_CAM_PLAN_DMA_BYTES || !bytes) {
+        return false;
+    }
+    size_t largest = location == CAMERA_FB_IN_PSRAM ? memory.psramLargest : memory.dramLargest;
+    size_t free    = location == CAMERA_FB_IN_PSRAM ? memory.psramFree : memory.dramFree - HMS_CAM_PLAN_DMA_BYTES;
+    largest        = largest < free ? largest : free;
+    return largest / bytes + (free - largest) / bytes >= count;
+}
+
+HMS_CAM_SimSensor::HMS_CAM_SimSensor() : _rng(0x484D53u) {
+    // Constructor implementation
+}
+
+HMS_CAM_SimSensor::~HMS_CAM_SimSensor() {
+    deinit();
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_SimSensor::init(const camera_config_t *config) {
+    if (!config || config->frame_size >= FRAMESIZE_INVALID || config->fb_count < 1) {
+        HMS_CAM_LOGGER(error, "Simulated sensor: invalid configuration");
+        return HMS_CAM_ERROR;
+    }
+    if (_running) deinit();
+
+    const HMS_CAM_SensorDriverTypeDef *driver = HMS_CAM_Sensor::findDriver(_module);
+    if (driver && !driver->jpeg && config->pixel_format == PIXFORMAT_JPEG) {
+        HMS_CAM_LOGGER(error, "Simulated sensor: %s has no JPEG encoder", driver->name);
+        return HMS_CAM_ERROR;
+    }
+    if (driver && (resolution[config->frame_size].width > resolution[driver->modes[driver->modeCount - 1].maxFrameSize].width ||
+                   resolution[config->frame_size].height > resolution[driver->modes[driver->modeCount - 1].maxFrameSize].height)) {
+        HMS_CAM_LOGGER(error, "Simulated sensor: frame size %d exceeds the %s array", (int)config->frame_size, driver->name);
+        return HMS_CAM_ERROR;
+    }
+
+    size_t bytes = HMS_CAM_Planner::bufferBytes(config->frame_size, config->pixel_format);
+    if (!simHeapFits(_memory, config->fb_location, bytes, config->fb_count)) {
+        HMS_CAM_LOGGER(warn, "Simulated sensor: %u x %u B frame buffers do not fit %s", (unsigned)config->fb_count,
+                       (unsigned)bytes, HMS_CAM_Planner::regionName(config->fb_location));
+        return HMS_CAM_NO_MEM;
+    }
+
+    _config = *config;
+    _window = {};
+    _setupSensor();
+
+    HMS_CAM_StatusTypeDef status = _loadSource();
+    if (status != HMS_CAM_OK) {
+        _releaseSource();
+        return status;
+    }
+
+    _settleLeft = _settleCount;                                                             // AEC restarts with the sensor
+    _sccbWrites.store(0);
+
+    _slots.assign(_config.fb_count, Slot{});
+    for (Slot &slot : _slots) {
+        slot.inUse = false;
+    }
+
+    _cursor  = 0;
+    _nextDue = std::chrono::steady_clock::now();
+    _duePending = false;
+    _running = true;
+
+    HMS_CAM_LOGGER(
+        debug, "Simulated sensor ready: %u frames, %ux%u, format %d",
+        (unsigned)_frames.size(), resolution[_config.frame_size].width,
+        resolution[_config.frame_size].height, (int)_config.pixel_format
+    );
+    return HMS_CAM_OK;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_SimSensor::deinit() {
+    std::lock_guard<std::mutex> guard(_lock);
+    _running = false;
+    _slots.clear();
+    _retired.clear();
+    _releaseSource();
+    return HMS_CAM_OK;
+}
+
+camera_fb_t* HMS_CAM_SimSensor::fbGet(int64_t deadlineUs) {
+    std::unique_lock<std::mutex> guard(_lock);
+    if (!_running) {
+        return nullptr;
+    }
+
+    if (!_pace(guard, deadlineUs)) {
+        return nullptr;                                                                     // Deadline first, or deinit() meanwhile
+    }
+
+    if (_frames.empty()) {
+        return nullptr;
+    }
+    bool settling = _settleLeft && _settleLeft <= _settleFrames.size();
+    if (!settling && _cursor >= _frames.size()) {
+        if (!_loop) {
+            return nullptr;                                                                 // Source exhausted
+        }
+        _cursor = 0;
+    }
+
+    Slot *slot = nullptr;
+    for (Slot &s : _slots) {
+        if (!s.inUse) {
+            slot = &s;
+            break;
+        }
+    }
+    if (!slot) {
+        return nullptr;                                                                     // All fb_count buffers are held
+    }
+
+    const Frame &frame = settling ? _settleFrames[_settleFrames.size() - _settleLeft--] : _frames[_cursor++];
+    size_t len         = frame.len;
+    bool   faulty      = _fault != HMS_CAM_SIM_FAULT_NONE && _fault != HMS_CAM_SIM_FAULT_STALL &&
+                         _faultEvery && (++_faultCounter % _faultEvery) == 0;
+    if (_copyFrames || faulty) {
+        size_t padding = (faulty && _fault == HMS_CAM_SIM_FAULT_PADDING) ? _faultPadding : 0;
+        if (slot->copy.size() < frame.len + padding) slot->copy.resize(frame.len + padding);
+        memcpy(slot->copy.data(), frame.data, frame.len);
+        slot->fb.buf = slot->copy.data();
+
+        if (faulty) {
+            switch (_fault) {
+                case HMS_CAM_SIM_FAULT_TRUNCATE:    len = frame.len / 2;                        break;
+                case HMS_CAM_SIM_FAULT_PADDING:     memset(slot->fb.buf + len, 0, padding);
+                                                    len += padding;                             break;
+                case HMS_CAM_SIM_FAULT_NO_SOI:      slot->fb.buf[0] = 0x00;                     break;
+                default:                                                                        break;
+            }
+        }
+    } else {
+        slot->fb.buf = const_cast<uint8_t*>(frame.data);                                   // Zero-copy view of the frame store
+    }
+
+    int64_t us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+
+    slot->fb.len                = len;
+    slot->fb.width              = frame.width;
+    slot->fb.height             = frame.height;
+    slot->fb.format             = _config.pixel_format;
+    slot->fb.timestamp.tv_sec   = (long)(us / 1000000);
+    slot->fb.timestamp.tv_usec  = (long)(us % 1000000);
+    slot->inUse                 = true;
+    return &slot->fb;
+}
+
+void HMS_CAM_SimSensor::setFault(HMS_CAM_SimFault fault, uint32_t everyN, size_t padding) {
+    std::lock_guard<std::mutex> guard(_lock);
+    _fault        = fault;
+    _faultEvery   = everyN;
+    _faultPadding = padding;
+    _faultCounter = 0;
+}
+
+void HMS_CAM_SimSensor::fbReturn(camera_fb_t *fb) {
+    if (!fb) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> guard(_lock);
+    bool anyInUse = false;
+    for (Slot &slot : _slots) {
+        if (&slot.fb == fb) {
+            slot.inUse = false;
+        }
+        anyInUse |= slot.inUse;
+    }
+    if (!anyInUse) {
+        _retired.clear();
+    }
+}
+
+uint32_t HMS_CAM_SimSensor::getFrameTimeUs() const {
+    if (_fps > 0.0f) {
+        return (uint32_t)(1000000.0f / _fps);
+    }
+    const HMS_CAM_SensorDriverTypeDef *driver = HMS_CAM_Sensor::findDriver(_module);
+    if (driver == NULL || !_running) {
+        return 0;
+    }
+    return HMS_CAM_Sensor::frameTimeUs(*driver, _sensor.status.framesize, (uint32_t)_sensor.xclk_freq_hz);  // Mode for the size
+}
+
+bool HMS_CAM_SimSensor::_pace(std::unique_lock<std::mutex> &lock, int64_t deadlineUs) {
+    using namespace std::chrono;
+    for (;;) {                                                                              // Another caller may take the frame
+        if (!_duePending) {
+            auto now = steady_clock::now();
+            _due     = now;
+
+            uint32_t periodUs = getFrameTimeUs();
+            if (periodUs) {
+                auto period = microseconds(periodUs);
+                _nextDue += period;
+                if (_nextDue + period < now) {
+                    _nextDue = now;                                                         // Consumer fell behind, resync
+                }
+
+                _due = _nextDue;
+                if (_jitterUs) {
+                    std::uniform_int_distribution<int32_t> jitter(-(int32_t)_jitterUs, (int32_t)_jitterUs);
+                    _due += microseconds(jitter(_rng));
+                }
+            }
+            if (_fault == HMS_CAM_SIM_FAULT_STALL && _faultEvery && (++_faultCounter % _faultEvery) == 0) {
+                _due = (_due > now ? _due : now) + milliseconds(_stallMs);
+            }
+            _duePending = true;                                                             // Kept across calls that time out
+        }
+
+        auto now = steady_clock::now();
+        if (_due <= now) {
+            _duePending = false;
+            return true;
+        }
+
+        auto due      = _due;
+        bool expires  = false;
+        if (deadlineUs != HMS_CAM_NO_DEADLINE) {
+            steady_clock::time_point deadline{microseconds(deadlineUs)};                    // HMS_CAM_Micros() clock
+            if (deadline < due) {
+                due     = deadline;
+                expires = true;
+            }
+        }
+
+        lock.unlock();                                                                      // Other calls may pace or release
+        std::this_thread::sleep_until(due);
+        lock.lock();
+        if (expires || !_running) {
+            return false;
+        }
+    }
+}
+
+void HMS_CAM_SimSensor::_setupSensor() {
+    _sensor                             = {};
+    _sensor.id.MIDH                     = 0x7F;
+    _sensor.id.MIDL                     = 0xA2;
+    _sensor.id.PID                      = OV2640_PID;
+    const HMS_CAM_SensorDriverTypeDef *driver = HMS_CAM_Sensor::findDriver(_module);
+    if (driver) {
+        _sensor.id.PID                  = driver->pid;
+    }
+    _sensor.slv_addr                    = 0x30;
+    _sensor.pixformat                   = _config.pixel_format;
+    _sensor.xclk_freq_hz                = _config.xclk_freq_hz;
+    _sensor.status.framesize            = _config.frame_size;
+    _sensor.status.quality              = (uint8_t)_config.jpeg_quality;
+    _sensor.priv                        = this;
+
+    _sensor.init_status                 = simInitStatus;
+    _sensor.reset                       = simReset;
+    _sensor.set_pixformat               = _sensorSetPixformat;
+    _sensor.set_framesize               = _sensorSetFramesize;
+    _sensor.set_quality                 = _sensorSetQuality;
+    _sensor.set_contrast                = simSet_contrast;
+    _sensor.set_brightness              = simSet_brightness;
+    _sensor.set_saturation              = simSet_saturation;
+    _sensor.set_sharpness               = simSet_sharpness;
+    _sensor.set_denoise                 = simSet_denoise;
+    _sensor.set_gainceiling             = simSetGainceiling;
+    _sensor.set_colorbar                = simSet_colorbar;
+    _sensor.set_whitebal                = simSet_whitebal;
+    _sensor.set_gain_ctrl               = simSet_gain_ctrl;
+    _sensor.set_exposure_ctrl           = simSet_exposure_ctrl;
+    _sensor.set_hmirror                 = simSet_hmirror;
+    _sensor.set_vflip                   = simSet_vflip;
+    _sensor.set_aec2                    = simSet_aec2;
+    _sensor.set_awb_gain                = simSet_awb_gain;
+    _sensor.set_agc_gain                = simSet_agc_gain;
+    _sensor.set_aec_value               = simSet_aec_value;
+    _sensor.set_special_effect          = simSet_special_effect;
+    _sensor.set_wb_mode                 = simSet_wb_mode;
+    _sensor.set_ae_level                = simSet_ae_level;
+    _sensor.set_dcw                     = simSet_dcw;
+    _sensor.set_bpc                     = simSet_bpc;
+    _sensor.set_wpc                     = simSet_wpc;
+    _sensor.set_raw_gma                 = simSet_raw_gma;
+    _sensor.set_lenc                    = simSet_lenc;
+    _sensor.get_reg                     = simGetReg;
+    _sensor.set_reg                     = simSetReg;
+    _sensor.set_res_raw                 = _sensorSetResRaw;
+    _sensor.set_pll                     = driver && driver->clockCount ? simSetPll : NULL;     // OV2640 and OV7670 have no PLL API
+    _sensor.set_xclk                    = simSetXclk;
+}
+
+int HMS_CAM_SimSensor::_sensorSetPixformat(sensor_t *sensor, pixformat_t pixformat) {
+    HMS_CAM_SimSensor *sim = static_cast<HMS_CAM_SimSensor*>(sensor->priv);
+    simSCCB(sensor);
+    std::lock_guard<std::mutex> guard(sim->_lock);
+
+    pixformat_t previous        = sim->_config.pixel_format;
+    sim->_config.pixel_format   = pixformat;
+    if (sim->_loadSource() != HMS_CAM_OK) {
+        sim->_config.pixel_format = previous;
+        sim->_loadSource();
+        return -1;
+    }
+    sensor->pixformat = pixformat;
+    return 0;
+}
+
+int HMS_CAM_SimSensor::_sensorSetFramesize(sensor_t *sensor, framesize_t framesize) {
+    HMS_CAM_SimSensor *sim = static_cast<HMS_CAM_SimSensor*>(sensor->priv);
+    simSCCB(sensor);
+    if (framesize >= FRAMESIZE_INVALID) {
+        return -1;
+    }
+    std::lock_guard<std::mutex> guard(sim->_lock);
+
+    framesize_t previous        = sim->_config.frame_size;
+    Window      window          = sim->_window;
+    sim->_config.frame_size     = framesize;
+    sim->_window                = {};                                                       // Framesize rewrites the window
+    if (sim->_loadSource() != HMS_CAM_OK) {
+        sim->_config.frame_size = previous;
+        sim->_window            = window;
+        sim->_loadSource();
+        return -1;
+    }
+    sensor->status.framesize = framesize;
+    return 0;
+}
+
+int HMS_CAM_SimSensor::_sensorSetResRaw(sensor_t *sensor, int startX, int startY, int endX, int endY, int offsetX,
+                                        int offsetY, int totalX, int totalY, int outputX, int outputY, bool scale,
+                                        bool binning) {
+    HMS_CAM_SimSensor *sim = static_cast<HMS_CAM_SimSensor*>(sensor->priv);
+    simSCCB(sensor);
+    const HMS_CAM_SensorDriverTypeDef *driver = HMS_CAM_Sensor::findDriver(sensor->id.PID);
+    if (driver == NULL || sim->_source != HMS_CAM_SIM_PATTERN) {
+        return -1;                                                                          // Crop needs the rendered pattern
+    }
+
+    Window window = {};
+    if (driver->windowing == HMS_CAM_SENSOR_WINDOW_MODE) {
+        uint8_t index = 0;
+        while (index < driver->modeCount && driver->modes[index].rawMode != startX) {       // startX is the driver mode enum
+            index++;
+        }
+        if (index == driver->modeCount) {
+            return -1;
+        }
+        const resolution_info_t &array = resolution[driver->modes[driver->modeCount - 1].maxFrameSize];
+        const resolution_info_t &mode  = resolution[driver->modes[index].maxFrameSize];
+        window.x      = (uint16_t)(offsetX * array.width / mode.width);                     // Back to array coordinates
+        window.y      = (uint16_t)(offsetY * array.height / mode.height);
+        window.width  = (uint16_t)(totalX * array.width / mode.width);
+        window.height = (uint16_t)(totalY * array.height / mode.height);
+    } else if (driver->windowing == HMS_CAM_SENSOR_WINDOW_ARRAY) {
+        window.x      = (uint16_t)startX;
+        window.y      = (uint16_t)startY;
+        window.width  = (uint16_t)(endX - startX - driver->windowRegs.marginX);
+        window.height = (uint16_t)(endY - startY - driver->windowRegs.marginY);
+    } else {
+        return -1;
+    }
+    window.outWidth  = (uint16_t)outputX;
+    window.outHeight = (uint16_t)outputY;
+
+    const resolution_info_t &array = resolution[driver->modes[driver->modeCount - 1].maxFrameSize];
+    if (!window.width || !window.height || !window.outWidth || !window.outHeight ||
+        window.x + window.width > array.width || window.y + window.height > array.height ||
+        window.outWidth > window.width || window.outHeight > window.height) {
+        return -1;
+    }
+
+    std::lock_guard<std::mutex> guard(sim->_lock);
+    Window previous = sim->_window;
+    sim->_window    = window;
+    if (sim->_loadSource() != HMS_CAM_OK) {
+        sim->_window = previous;
+        sim->_loadSource();
+        return -1;
+    }
+    sensor->status.scale   = scale;
+    sensor->status.binning = binning;
+    return 0;
+}
+
+int HMS_CAM_SimSensor::_sensorSetQuality(sensor_t *sensor, int quality) {
+    HMS_CAM_SimSensor *sim = static_cast<HMS_CAM_SimSensor*>(sensor->priv);
+    simSCCB(sensor);
+    if (quality < 0 || quality > 63) {
+        return -1;
+    }
+    std::lock_guard<std::mutex> guard(sim->_lock);
+
+    sim->_config.jpeg_quality = quality;
+    if (sim->_source == HMS_CAM_SIM_PATTERN && sim->_config.pixel_format == PIXFORMAT_JPEG) {
+        sim->_loadSource();                                                                 // Re-encode at the new quality
+    }
+    sensor->status.quality = (uint8_t)quality;
+    return 0;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_SimSensor::_loadSource() {
+    bool leased = false;
+    for (const Slot &slot : _slots) {
+        leased |= slot.inUse;
+    }
+    if (leased) {
+        for (auto &store : _storage) {
+            _retired.push_back(std::move(store));                                           // Keep leased frames valid
+        }
+    }
+    _storage.clear();
+    _frames.clear();
+    _settleFrames.clear();
+    _cursor = 0;
+
+    switch (_source) {
+        case HMS_CAM_SIM_PATTERN:   return _loadPattern();
+        case HMS_CAM_SIM_DIRECTORY: return _loadDirectory();
+        case HMS_CAM_SIM_RAW_FILE:  return _loadRawFile();
+        case HMS_CAM_SIM_RECORDING: return _loadRecording();
+        default:                    return HMS_CAM_ERROR;
+    }
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_SimSensor::_loadPattern() {
+    int width   = resolution[_config.frame_size].width;
+    int height  = resolution[_config.frame_size].height;
+    int renderW = width;
+    int renderH = height;
+    int count   = 1;
+
+    if (_window.outWidth) {
+        const HMS_CAM_SensorDriverTypeDef *driver = HMS_CAM_Sensor::findDriver(_sensor.id.PID);
+        const resolution_info_t &array = resolution[driver->modes[driver->modeCount - 1].maxFrameSize];
+        renderW = array.width;                                                              // Render the array, crop the window
+        renderH = array.height;
+        width   = _window.outWidth;
+        height  = _window.outHeight;
+    }
+
+    if (_pattern == HMS_CAM_SIM_MOVING_BOX) {
+        count = 16;
+    } else if (_pattern == HMS_CAM_SIM_NOISE) {
+        count = 4;
+    }
+
+    std::vector<uint8_t> rgb, array;
+    auto render = [&](int index) {
+        if (!_window.outWidth) {
+            simRenderPattern(_pattern, index, count, width, height, _rng, rgb);
+            return;
+        }
+        simRenderPattern(_pattern, index, count, renderW, renderH, _rng, array);
+        simCrop(array, renderW, _window.x, _window.y, _window.width, _window.height, width, height, rgb);
+    };
+
+    _storage.resize(count);
+    for (int i = 0; i < count; i++) {
+        render(i);
+        if (!simConvert(rgb, width, height, _config.pixel_format, _config.jpeg_quality, _storage[i])) {
+            HMS_CAM_LOGGER(error, "Simulated sensor: pixel format %d not supported", (int)_config.pixel_format);
+            return HMS_CAM_ERROR;
+        }
+    }
+
+    if (_settleCount) {
+        render(0);
+        std::vector<uint8_t> dim(rgb.size());
+        for (uint32_t i = 0; i < _settleCount; i++) {
+            uint32_t scale = (i + 1) * 256 / (_settleCount + 1);                           // Linear ramp up to full exposure
+            for (size_t j = 0; j < rgb.size(); j++) {
+                dim[j] = (uint8_t)((rgb[j] * scale) >> 8);
+            }
+            _storage.emplace_back();
+            simConvert(dim, width, height, _config.pixel_format, _config.jpeg_quality, _storage.back());
+        }
+    }
+
+    for (size_t i = 0; i < _storage.size(); i++) {
+        Frame frame = { _storage[i].data(), _storage[i].size(), (uint16_t)width, (uint16_t)height };
+        if (i < (size_t)count) {
+            _frames.push_back(frame);
+        } else {
+            _settleFrames.push_back(frame);
+        }
+    }
+    return HMS_CAM_OK;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_SimSensor::_loadDirectory() {
+    namespace fs = std::filesystem;
+
+    std::error_code ec;
+    if (_path.empty() || !fs::is_directory(_path, ec)) {
+        HMS_CAM_LOGGER(error, "Simulated sensor: directory not found: %s", _path.c_str());
+        return HMS_CAM_NOT_FOUND;
+    }
+
+    std::vector<fs::path> files;
+    for (const auto &entry : fs::directory_iterator(_path, ec)) {
+        if (entry.is_regular_file()) {
+            files.push_back(entry.path());
+        }
+    }
+    std::sort(files.begin(), files.end());
+
+    bool   jpeg     = _config.pixel_format == PIXFORMAT_JPEG;
+    int    width    = resolution[_config.frame_size].width;
+    int    height   = resolution[_config.frame_size].height;
+    size_t rawSize  = (size_t)width * height * simBytesPerPixel(_config.pixel_format);
+
+    for (const fs::path &file : files) {
+        std::string ext = file.extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+        bool isJpeg = (ext == ".jpg" || ext == ".jpeg");
+        if (isJpeg != jpeg) {
+            continue;                                                                       // Only frames of the configured format
+        }
+
+        std::vector<uint8_t> data;
+        if (!simReadFile(file, data)) {
+            continue;
+        }
+
+        uint16_t w = (uint16_t)width, h = (uint16_t)height;
+        if (isJpeg ? !HMS_CAM_JPEG::parseHeader(data.data(), data.size(), w, h) : data.size() != rawSize) {
+            HMS_CAM_LOGGER(warn, "Simulated sensor: skipping %s", file.string().c_str());
+            continue;
+        }
+
+        _storage.push_back(std::move(data));
+        _frames.push_back({ _storage.back().data(), _storage.back().size(), w, h });
+    }
+
+    if (_frames.empty()) {
+        HMS_CAM_LOGGER(error, "Simulated sensor: no usable frames in %s", _path.c_str());
+        return HMS_CAM_NOT_FOUND;
+    }
+    return HMS_CAM_OK;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_SimSensor::_mapFile() {
+    if (_map) {
+        return HMS_CAM_OK;
+    }
+
+    #if defined(_WIN32)
+        if (!simReadFile(_path, _fileData)) {
+            HMS_CAM_LOGGER(error, "Simulated sensor: cannot read %s", _path.c_str());
+            return HMS_CAM_NOT_FOUND;
+        }
+        _map        = _fileData.data();
+        _mapLength  = _fileData.size();
+    #else
+        int fd = open(_path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            HMS_CAM_LOGGER(error, "Simulated sensor: cannot open %s", _path.c_str());
+            return HMS_CAM_NOT_FOUND;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            close(fd);
+            return HMS_CAM_ERROR;
+        }
+        void *map = mmap(nullptr, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED) {
+            HMS_CAM_LOGGER(error, "Simulated sensor: mmap failed for %s", _path.c_str());
+            return HMS_CAM_ERROR;
+        }
+        madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+        _map        = map;
+        _mapLength  = (size_t)st.st_size;
+    #endif
+    return HMS_CAM_OK;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_SimSensor::_loadRawFile() {
+    HMS_CAM_StatusTypeDef status = _mapFile();
+    if (status != HMS_CAM_OK) {
+        return status;
+    }
+
+    const uint8_t *base = static_cast<const uint8_t*>(_map);
+    uint16_t width      = resolution[_config.frame_size].width;
+    uint16_t height     = resolution[_config.frame_size].height;
+
+    if (_config.pixel_format == PIXFORMAT_JPEG) {
+        size_t pos = 0;                                                                     // Concatenated JPEG (MJPEG) stream
+        while (pos + 4 <= _mapLength) {
+            size_t start = HMS_CAM_JPEG::findMarker(base, _mapLength, pos, 0xD8);
+            size_t end   = HMS_CAM_JPEG::findMarker(base, _mapLength, start + 2, 0xD9);
+            if (end >= _mapLength) break;
+            end += 2;
+            uint16_t w = width, h = height;
+            if (HMS_CAM_JPEG::parseHeader(base + start, end - start, w, h)) {
+                _frames.push_back({ base + start, end - start, w, h });
+            }
+            pos = end;
+        }
+    } else {
+        size_t frameSize = (size_t)width * height * simBytesPerPixel(_config.pixel_format);
+        for (size_t pos = 0; frameSize && pos + frameSize <= _mapLength; pos += frameSize) {
+            _frames.push_back({ base + pos, frameSize, width, height });
+        }
+    }
+
+    if (_frames.empty()) {
+        HMS_CAM_LOGGER(error, "Simulated sensor: no frames in %s", _path.c_str());
+        return HMS_CAM_NOT_FOUND;
+    }
+    return HMS_CAM_OK;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_SimSensor::_loadRecording() {
+    if (_config.pixel_format != PIXFORMAT_JPEG) {
+        HMS_CAM_LOGGER(error, "Simulated sensor: recordings replay as JPEG only");
+        return HMS_CAM_ERROR;
+    }
+    HMS_CAM_StatusTypeDef status = _mapFile();
+    if (status != HMS_CAM_OK) {
+        return status;
+    }
+
+    HMS_CAM_RecordingTypeDef recording;
+    status = HMS_CAM_Recorder::open(static_cast<const uint8_t*>(_map), _mapLength, recording);
+    if (status != HMS_CAM_OK) {
+        HMS_CAM_LOGGER(error, "Simulated sensor: %s is not an indexed AVI", _path.c_str());
+        return status;
+    }
+
+    _frames.reserve(recording.frames);
+    for (uint32_t i = 0; i < recording.frames; i++) {
+        const uint8_t *data;
+        size_t length;
+        if (HMS_CAM_Recorder::frameAt(recording, i, data, length) != HMS_CAM_OK) {
+            continue;                                                                       // Entry points outside the file
+        }
+        uint16_t w = recording.width, h = recording.height;
+        HMS_CAM_JPEG::parseHeader(data, length, w, h);
+        _frames.push_back({ data, length, w, h });
+    }
+
+    if (_frames.empty()) {
+        HMS_CAM_LOGGER(error, "Simulated sensor: no frames in %s", _path.c_str());
+        return HMS_CAM_NOT_FOUND;
+    }
+    return HMS_CAM_OK;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_SimSensor::seek(size_t frame) {
+    std::lock_guard<std::mutex> guard(_lock);
+    if (frame >= _frames.size()) {
+        return HMS_CAM_NOT_FOUND;
+    }
+    _cursor = frame;
+    return HMS_CAM_OK;
+}
+
+void HMS_CAM_SimSensor::_releaseSource() {
+    #if defined(_WIN32)
+        _fileData.clear();
+    #else
+        if (_map) {
+            munmap(_map, _mapLength);
+        }
+    #endif
+    _map        = nullptr;
+    _mapLength  = 0;
+    _frames.clear();
+    _storage.clear();
+    _cursor     = 0;
+}
+
+#endif // HMS_CAM_PLATFORM_DESKTOP
@@ -0,0 +1,196 @@
+#include "HMS_CAM_Stats.h"
+
+#include <string.h>
+
+int HMS_CAM_Stats::_bucket(uint32_t us) {
+    int bucket = 0;
+    while (us && bucket < HMS_CAM_STATS_BUCKETS - 1) {
+        us >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+void HMS_CAM_Stats::reset() {
+    _frames.store(0);
+    _bytes.store(0);
+    _bytesWraps.store(0);
+    _fbGetFailures.store(0);
+    _invalidFrames.store(0);
+    _trimmedFrames.store(0);
+    _trimmedBytes.store(0);
+    _retries.store(0);
+    _busyRejections.store(0);
+    _timeouts.store(0);
+    _lastSequence.store(0);
+    _firstMs.store(0);
+    _lastMs.store(0);
+    _lastUs.store(0);
+    _intervalUs.store(0);
+    for (int i = 0; i < HMS_CAM_STATS_BUCKETS; i++) {
+        _fbWait[i].store(0);
+        _latency[i].store(0);
+    }
+    for (int i = 0; i < HMS_CAM_JPEG_RESULT_COUNT; i++) {
+        _jpegErrors[i].store(0);
+    }
+}
+
+void HMS_CAM_Stats::recordInvalid(HMS_CAM_JPEGResult result) {
+    _invalidFrames.fetch_add(1, std::memory_order_relaxed);
+    if (result < HMS_CAM_JPEG_RESULT_COUNT) {
+        _jpegErrors[result].fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void HMS_CAM_Stats::recordTrim(size_t bytes) {
+    _trimmedFrames.fetch_add(1, std::memory_order_relaxed);
+    _trimmedBytes.fetch_add((uint32_t)bytes, std::memory_order_relaxed);
+}
+
+void HMS_CAM_Stats::recordFrame(size_t bytes, uint32_t waitUs, uint32_t latencyUs, uint32_t sequence, int64_t nowUs) {
+    uint32_t nowMs  = (uint32_t)(nowUs / 1000);
+    uint32_t nowLow = (uint32_t)nowUs;
+
+    if (_frames.fetch_add(1, std::memory_order_relaxed) == 0) {
+        _firstMs.store(nowMs, std::memory_order_relaxed);
+    } else {
+        uint32_t interval = nowLow - _lastUs.load(std::memory_order_relaxed);              // EWMA, alpha = 1/8
+        uint32_t smoothed = _intervalUs.load(std::memory_order_relaxed);
+        _intervalUs.store(smoothed ? smoothed - (smoothed >> 3) + (interval >> 3) : interval, std::memory_order_relaxed);
+    }
+    _lastUs.store(nowLow, std::memory_order_relaxed);
+    _lastMs.store(nowMs, std::memory_order_relaxed);
+    _lastSequence.store(sequence, std::memory_order_relaxed);
+
+    uint32_t previous = _bytes.fetch_add((uint32_t)bytes, std::memory_order_relaxed);
+    if ((uint32_t)(previous + (uint32_t)bytes) < previous) {
+        _bytesWraps.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    _fbWait[_bucket(waitUs)].fetch_add(1, std::memory_order_relaxed);
+    _latency[_bucket(latencyUs)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void HMS_CAM_Stats::snapshot(HMS_CAM_StatsTypeDef &out) const {
+    memset(&out, 0, sizeof(out));
+
+    out.frames          = _frames.load(std::memory_order_relaxed);
+    out.bytes           = ((uint64_t)_bytesWraps.load(std::memory_order_relaxed) << 32) | _bytes.load(std::memory_order_relaxed);
+    out.fbGetFailures   = _fbGetFailures.load(std::memory_order_relaxed);
+    out.invalidFrames   = _invalidFrames.load(std::memory_order_relaxed);
+    out.trimmedFrames   = _trimmedFrames.load(std::memory_order_relaxed);
+    out.trimmedBytes    = _trimmedBytes.load(std::memory_order_relaxed);
+    out.retries         = _retries.load(std::memory_order_relaxed);
+    out.busyRejections  = _busyRejections.load(std::memory_order_relaxed);
+    out.timeouts        = _timeouts.load(std::memory_order_relaxed);
+    out.lastSequence    = _lastSequence.load(std::memory_order_relaxed);
+    out.elapsedMs       = out.frames > 1 ? _lastMs.load(std::memory_order_relaxed) - _firstMs.load(std::memory_order_relaxed) : 0;
+
+    if (out.elapsedMs) {
+        out.fps             = (out.frames - 1) * 1000.0f / out.elapsedMs;
+        out.bytesPerSecond  = out.bytes * 1000.0f / out.elapsedMs;
+    }
+    uint32_t interval = _intervalUs.load(std::memory_order_relaxed);
+    out.recentFps = interval ? 1000000.0f / interval : 0.0f;
+
+    for (int i = 0; i < HMS_CAM_STATS_BUCKETS; i++) {
+        out.fbWaitUs[i]  = _fbWait[i].load(std::memory_order_relaxed);
+        out.latencyUs[i] = _latency[i].load(std::memory_order_relaxed);
+    }
+    for (int i = 0; i < HMS_CAM_JPEG_RESULT_COUNT; i++) {
+        out.jpegErrors[i] = _jpegErrors[i].load(std::memory_order_relaxed);
+    }
+}
+
+uint32_t HMS_CAM_Stats::percentile(const uint32_t *histogram, float p) {
+    uint64_t total = 0;
+    for (int i = 0; i < HMS_CAM_STATS_BUCKETS; i++) {
+        total += histogram[i];
+    }
+    if (!total) {
+        return 0;
+    }
+
+    uint64_t target = (uint64_t)(total * p + 0.5f), seen = 0;
+    for (int i = 0; i < HMS_CAM_STATS_BUCKETS; i++) {
+        seen += histogram[i];
+        if (seen >= target && histogram[i]) {
+            return i == 0 ? 0 : (1u << i) - 1;                                              // Upper bound of the bucket
+        }
+    }
+    return (1u << (HMS_CAM_STATS_BUCKETS - 1)) - 1;
+}
+
+size_t HMS_CAM_Stats::toJSON(const HMS_CAM_StatsTypeDef &stats, char *buf, size_t len) {
+    size_t used = 0;
+    auto put = [&](const char *fmt, auto... args) {
+        if (used < len) {
+            int n = snprintf(buf + used, len - used, fmt, args...);
+            used += n > 0 ? (size_t)n : 0;
+        }
+    };
+    auto histogram = [&](const char *name, const uint32_t *h) {
+        put(",\"%s\":{\"p50\":%u,\"p90\":%u,\"p99\":%u,\"hist\":[", name,
+            (unsigned)percentile(h, 0.50f), (unsigned)percentile(h, 0.90f), (unsigned)percentile(h, 0.99f));
+        for (int i = 0; i < HMS_CAM_STATS_BUCKETS; i++) {
+            put(i ? ",%u" : "%u", (unsigned)h[i]);
+        }
+        put("]}");
+    };
+
+    put("{\"frames\":%u,\"bytes\":%llu,\"fps\":%.2f,\"recent_fps\":%.2f,\"bytes_per_second\":%.0f,"
+        "\"fb_get_failures\":%u,\"invalid\":%u,\"trimmed\":%u,\"trimmed_bytes\":%u,"
+        "\"retries\":%u,\"dropped\":%u,\"busy\":%u,\"timeouts\":%u,\"sequence\":%u,\"elapsed_ms\":%u",
+        (unsigned)stats.frames, (unsigned long long)stats.bytes, stats.fps, stats.recentFps, stats.bytesPerSecond,
+        (unsigned)stats.fbGetFailures, (unsigned)stats.invalidFrames, (unsigned)stats.trimmedFrames,
+        (unsigned)stats.trimmedBytes, (unsigned)stats.retries, (unsigned)stats.droppedFrames,
+        (unsigned)stats.busyRejections, (unsigned)stats.timeouts, (unsigned)stats.lastSequence, (unsigned)stats.elapsedMs);
+    histogram("fb_wait_us", stats.fbWaitUs);
+    histogram("latency_us", stats.latencyUs);
+    put(",\"jpeg_errors\":{");
+    for (int i = HMS_CAM_JPEG_VALID + 1; i < HMS_CAM_JPEG_RESULT_COUNT; i++) {
+        put(i > 1 ? ",\"%s\":%u" : "\"%s\":%u", HMS_CAM_JPEG::resultName((HMS_CAM_JPEGResult)i),
+            (unsigned)stats.jpegErrors[i]);
+    }
+    put("}}");
+
+    return used < len ? used : 0;                                                           // 0 when truncated
+}
+
+size_t HMS_CAM_Stats::toBinary(const HMS_CAM_StatsTypeDef &stats, uint8_t *buf, size_t len) {
+    const size_t required = 4 + 2 + 2 + 4 * 11 + 8 + 4 * 3 + 4 * HMS_CAM_STATS_BUCKETS * 2 + 4 * HMS_CAM_JPEG_RESULT_COUNT;
+    if (!buf || len < required) {
+        return 0;
+    }
+
+    size_t pos = 0;
+    auto u16 = [&](uint16_t v) { buf[pos++] = v & 0xFF; buf[pos++] = v >> 8; };
+    auto u32 = [&](uint32_t v) { for (int i = 0; i < 4; i++) buf[pos++] = (uint8_t)(v >> (8 * i)); };
+    auto u64 = [&](uint64_t v) { u32((uint32_t)v); u32((uint32_t)(v >> 32)); };
+    auto f32 = [&](float v)    { uint32_t bits; memcpy(&bits, &v, 4); u32(bits); };
+
+    u32(HMS_CAM_STATS_MAGIC);                                                               // Little endian, fixed layout
+    u16(HMS_CAM_STATS_VERSION);
+    u16(HMS_CAM_STATS_BUCKETS);
+    u32(stats.frames);
+    u64(stats.bytes);
+    u32(stats.fbGetFailures);
+    u32(stats.invalidFrames);
+    u32(stats.trimmedFrames);
+    u32(stats.trimmedBytes);
+    u32(stats.retries);
+    u32(stats.droppedFrames);
+    u32(stats.busyRejections);
+    u32(stats.timeouts);
+    u32(stats.lastSequence);
+    u32(stats.elapsedMs);
+    f32(stats.fps);
+    f32(stats.recentFps);
+    f32(stats.bytesPerSecond);
+    for (int i = 0; i < HMS_CAM_STATS_BUCKETS; i++) u32(stats.fbWaitUs[i]);
+    for (int i = 0; i < HMS_CAM_STATS_BUCKETS; i++) u32(stats.latencyUs[i]);
+    for (int i = 0; i < HMS_CAM_JPEG_RESULT_COUNT; i++) u32(stats.jpegErrors[i]);
+
+    return pos;
+}
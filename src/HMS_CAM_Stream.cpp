@@ -0,0 +1,241 @@
+#include "HMS_CAM.h"
+#include "HMS_CAM_Stream.h"
+
+#ifdef HMS_CAM_HAS_CAMERA_API
+
+#include <string.h>
+
+#if defined(HMS_CAM_PLATFORM_DESKTOP) && !defined(_WIN32)
+  #include <errno.h>
+  #include <sys/uio.h>
+  #include <sys/socket.h>
+#endif
+
+static const uint8_t streamTrailer[] = { '\r', '\n' };
+
+HMS_CAM_StatusTypeDef HMS_CAM_Stream::begin(HMS_CAM &camera, HMS_CAM_StreamSink sink, void *context) {
+    HMS_CAM_StatusTypeDef status = begin(sink, context);
+    if (status != HMS_CAM_OK) {
+        return status;
+    }
+
+    _subscriber = camera.subscribe(HMS_CAM_DROP_LATEST);
+    if (!_subscriber) {
+        _sink = NULL;
+        return HMS_CAM_BUSY;
+    }
+    _camera = &camera;
+
+    if (!camera.isCaptureTaskRunning()) {
+        HMS_CAM_LOGGER(warn, "Capture task not running, stream waits for frames");
+    }
+    return HMS_CAM_OK;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_Stream::begin(HMS_CAM_StreamSink sink, void *context) {
+    end();
+    if (!sink) {
+        return HMS_CAM_ERROR;
+    }
+
+    _sink    = sink;
+    _context = context;
+    _nextUs  = 0;
+    _stats   = {};
+    return HMS_CAM_OK;
+}
+
+void HMS_CAM_Stream::end() {
+    _finish();
+    if (_camera && _subscriber) {
+        _camera->unsubscribe(_subscriber);
+    }
+    _camera     = NULL;
+    _subscriber = NULL;
+    _sink       = NULL;
+    _context    = NULL;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_Stream::pump(uint32_t timeoutMs) {
+    if (!_sink || !_subscriber) {
+        return HMS_CAM_ERROR;
+    }
+    if (_pending) {
+        return flush();
+    }
+
+    HMS_CAM_FrameView view;
+    HMS_CAM_StatusTypeDef status = _subscriber->receive(view, timeoutMs);
+    if (status != HMS_CAM_OK) {
+        return status;
+    }
+
+    int64_t now = HMS_CAM_Micros();
+    if (_intervalUs) {
+        if (now < _nextUs) {
+            _stats.framesSkipped++;                                                         // Over the frame rate cap
+            return HMS_CAM_BUSY;
+        }
+        _nextUs = (now - _nextUs < _intervalUs) ? _nextUs + _intervalUs : now + _intervalUs;   // Keep cadence, no bursts
+    }
+
+    _view = std::move(view);
+    if (_prepare(_view.frame()) != HMS_CAM_OK) {
+        _view.release();
+        return HMS_CAM_ERROR;
+    }
+    return flush();
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_Stream::write(const HMS_CAM_FrameBufferTypeDef &frame) {
+    if (!_sink || !frame.buf) {
+        return HMS_CAM_ERROR;
+    }
+    if (_pending) {
+        _stats.framesSkipped++;
+        return HMS_CAM_BUSY;
+    }
+
+    if (_prepare(frame) != HMS_CAM_OK) {
+        return HMS_CAM_ERROR;
+    }
+    return flush();
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_Stream::flush() {
+    if (!_pending) {
+        return HMS_CAM_OK;
+    }
+
+    while (_iovIndex < HMS_CAM_STREAM_IOV_COUNT) {
+        int32_t written = _sink(&_iov[_iovIndex], HMS_CAM_STREAM_IOV_COUNT - _iovIndex, _context);
+        if (written < 0) {
+            HMS_CAM_LOGGER(warn, "Stream sink failed, closing");
+            _finish();
+            return HMS_CAM_ERROR;
+        }
+
+        if (written == 0) {
+            int64_t now = HMS_CAM_Micros();
+            _stats.stalls++;
+            if (!_stallSinceUs) {
+                _stallSinceUs = now;
+            } else if (_stallMs && now - _stallSinceUs >= (int64_t)_stallMs * 1000) {
+                HMS_CAM_LOGGER(warn, "Stream sink stalled for %u ms, closing", (unsigned)_stallMs);
+                _finish();
+                return HMS_CAM_ERROR;
+            }
+            return HMS_CAM_BUSY;
+        }
+
+        _stallSinceUs     = 0;
+        _stats.bytesSent += written;
+
+        size_t left = (size_t)written;                                                      // Advance over fully written chunks
+        while (_iovIndex < HMS_CAM_STREAM_IOV_COUNT && left >= _iov[_iovIndex].length) {
+            left -= _iov[_iovIndex].length;
+            _iovIndex++;
+        }
+        if (_iovIndex < HMS_CAM_STREAM_IOV_COUNT) {
+            _iov[_iovIndex].base   += left;
+            _iov[_iovIndex].length -= left;
+        }
+    }
+
+    _stats.framesSent++;
+    _finish();
+    return HMS_CAM_OK;
+}
+
+void HMS_CAM_Stream::setBoundary(const char *boundary) {
+    if (!boundary || !boundary[0] || strlen(boundary) > HMS_CAM_STREAM_BOUNDARY_MAX) {
+        HMS_CAM_LOGGER(warn, "Invalid multipart boundary, keeping \"%s\"", _boundary);
+        return;
+    }
+    strcpy(_boundary, boundary);
+}
+
+size_t HMS_CAM_Stream::getContentType(char *buf, size_t len) const {
+    int n = snprintf(buf, len, "multipart/x-mixed-replace;boundary=%s", _boundary);
+    return (n > 0 && (size_t)n < len) ? (size_t)n : 0;                                     // 0 when truncated
+}
+
+size_t HMS_CAM_Stream::getHTTPHeader(char *buf, size_t len) const {
+    int n = snprintf(buf, len,
+                     "HTTP/1.1 200 OK\r\n"
+                     "Content-Type: multipart/x-mixed-replace;boundary=%s\r\n"
+                     "Cache-Control: no-cache, no-store\r\n"
+                     "Connection: close\r\n"
+                     "\r\n", _boundary);
+    return (n > 0 && (size_t)n < len) ? (size_t)n : 0;
+}
+
+void HMS_CAM_Stream::getStats(HMS_CAM_StreamStatsTypeDef &stats) const {
+    stats = _stats;
+    if (_subscriber) {
+        stats.framesSkipped += _subscriber->getDropped();                                   // Replaced while the sink was busy
+    }
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_Stream::_prepare(const HMS_CAM_FrameBufferTypeDef &frame) {
+    int n = snprintf(_header, sizeof(_header),
+                     "--%s\r\n"
+                     "Content-Type: image/jpeg\r\n"
+                     "Content-Length: %u\r\n"
+                     "X-Timestamp: %lld.%06lld\r\n"
+                     "\r\n", _boundary, (unsigned)frame.length,
+                     (long long)(frame.timestampUs / 1000000), (long long)(frame.timestampUs % 1000000));
+
+    if (n < 0 || (size_t)n >= sizeof(_header)) {
+        HMS_CAM_LOGGER(error, "Stream part header does not fit (%d bytes)", n);
+        return HMS_CAM_ERROR;                                                               // Never send a truncated header
+    }
+
+    _iov[0]       = { (const uint8_t*)_header, (size_t)n };
+    _iov[1]       = { frame.buf, frame.length };
+    _iov[2]       = { streamTrailer, sizeof(streamTrailer) };
+    _iovIndex     = 0;
+    _stallSinceUs = 0;
+    _pending      = true;
+    return HMS_CAM_OK;
+}
+
+void HMS_CAM_Stream::_finish() {
+    _view.release();
+    _pending      = false;
+    _iovIndex     = 0;
+    _stallSinceUs = 0;
+}
+
+#if defined(HMS_CAM_PLATFORM_DESKTOP) && !defined(_WIN32)
+int32_t HMS_CAM_Stream::fdSink(const HMS_CAM_IOVecTypeDef *iov, size_t count, void *context) {
+    int fd = (int)(intptr_t)context;
+
+    struct iovec vec[HMS_CAM_STREAM_IOV_COUNT];
+    count = count < HMS_CAM_STREAM_IOV_COUNT ? count : HMS_CAM_STREAM_IOV_COUNT;
+    for (size_t i = 0; i < count; i++) {
+        vec[i].iov_base = (void*)iov[i].base;
+        vec[i].iov_len  = iov[i].length;
+    }
+
+    struct msghdr msg = {};
+    msg.msg_iov    = vec;
+    msg.msg_iovlen = count;
+
+    int flags = MSG_DONTWAIT;                                                               // Never block the caller
+    #ifdef MSG_NOSIGNAL
+        flags |= MSG_NOSIGNAL;                                                              // EPIPE instead of SIGPIPE
+    #endif
+
+    ssize_t written = sendmsg(fd, &msg, flags);
+    if (written < 0 && errno == ENOTSOCK) {
+        written = writev(fd, vec, (int)count);                                              // Files and pipes
+    }
+    if (written < 0) {
+        return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? 0 : -1;
+    }
+    return written > INT32_MAX ? INT32_MAX : (int32_t)written;
+}
+#endif
+
+#endif // HMS_CAM_HAS_CAMERA_API
@@ -0,0 +1,229 @@
+#include "HMS_CAM_Trace.h"
+
+#ifdef HMS_CAM_HAS_CAMERA_API
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+const char* HMS_CAM_Trace::eventName(uint8_t event) {
+    switch (event) {
+        case HMS_CAM_TRACE_INIT:        return "init";
+        case HMS_CAM_TRACE_CONFIGURE:   return "configure";
+        case HMS_CAM_TRACE_APPLY:       return "apply";
+        case HMS_CAM_TRACE_SETTLE:      return "settle";
+        case HMS_CAM_TRACE_FB_GET:      return "fb_get";
+        case HMS_CAM_TRACE_VALIDATE:    return "validate";
+        case HMS_CAM_TRACE_TIMEOUT:     return "timeout";
+        case HMS_CAM_TRACE_LEASE:       return "lease";
+        case HMS_CAM_TRACE_PUBLISH:     return "publish";
+        case HMS_CAM_TRACE_RECEIVE:     return "receive";
+        case HMS_CAM_TRACE_RETURN:      return "return";
+        case HMS_CAM_TRACE_REFRESH:     return "refresh";
+        default:                        return "unknown";
+    }
+}
+
+#if HMS_CAM_TRACE_ENABLED
+
+#include <atomic>
+
+#if defined(HMS_CAM_PLATFORM_ESP_IDF)
+    #include "esp_cpu.h"
+    #include "esp_rom_sys.h"
+    #include "esp_heap_caps.h"
+    #if !defined(CONFIG_FREERTOS_UNICORE)
+        #include "esp_ipc.h"
+    #endif
+#elif defined(__linux__)
+    #include <sched.h>
+#endif
+
+static_assert(sizeof(HMS_CAM_TraceEventTypeDef) == 16, "trace events are 16 bytes");
+static_assert((HMS_CAM_TRACE_EVENTS & (HMS_CAM_TRACE_EVENTS - 1)) == 0, "HMS_CAM_TRACE_EVENTS must be a power of two");
+
+struct TraceRing {
+    std::atomic<uint32_t>       head{0};                                                    // Events claimed since clear()
+    HMS_CAM_TraceEventTypeDef   events[HMS_CAM_TRACE_EVENTS];
+};
+
+static TraceRing                traceRings[HMS_CAM_TRACE_CORES];
+static std::atomic<uint16_t>    traceThreads{0};
+static thread_local uint16_t    traceThread = 0;                                            // 0 until the thread records
+
+static inline uint64_t traceTicks() {
+    #if defined(HMS_CAM_PLATFORM_ESP_IDF)
+        return (uint64_t)esp_cpu_get_cycle_count();
+    #else
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()).count();
+    #endif
+}
+
+static inline uint32_t traceCore() {
+    #if defined(HMS_CAM_PLATFORM_ESP_IDF)
+        return (uint32_t)xPortGetCoreID();
+    #elif defined(__linux__)
+        int cpu = sched_getcpu();
+        return cpu < 0 ? 0 : (uint32_t)cpu % HMS_CAM_TRACE_CORES;
+    #else
+        return 0;
+    #endif
+}
+
+static void traceAnchor(void *arg) {
+    HMS_CAM_TraceCoreTypeDef *core = (HMS_CAM_TraceCoreTypeDef *)arg;
+    core->anchorTicks = traceTicks();
+    core->anchorUs    = HMS_CAM_Micros();
+}
+
+void HMS_CAM_Trace::record(HMS_CAM_TraceEventType event, HMS_CAM_TracePhase phase, uint32_t arg) {
+    if (!traceThread) {
+        traceThread = (uint16_t)(traceThreads.fetch_add(1, std::memory_order_relaxed) + 1);
+    }
+
+    TraceRing &ring = traceRings[traceCore()];
+    uint32_t   slot = ring.head.fetch_add(1, std::memory_order_relaxed) & (HMS_CAM_TRACE_EVENTS - 1);
+    HMS_CAM_TraceEventTypeDef &entry = ring.events[slot];
+    entry.ticks  = traceTicks();                                                            // After the claim, keeps ring order
+    entry.arg    = arg;
+    entry.thread = traceThread;
+    entry.event  = (uint8_t)event;
+    entry.phase  = (uint8_t)phase;
+}
+
+void HMS_CAM_Trace::clear() {
+    for (TraceRing &ring : traceRings) {
+        ring.head.store(0, std::memory_order_relaxed);
+    }
+}
+
+size_t HMS_CAM_Trace::dumpSize() {
+    return sizeof(HMS_CAM_TraceHeaderTypeDef) +
+           HMS_CAM_TRACE_CORES * (sizeof(HMS_CAM_TraceCoreTypeDef) + sizeof(HMS_CAM_TraceEventTypeDef) * HMS_CAM_TRACE_EVENTS);
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_Trace::dump(uint8_t *out, size_t capacity, size_t &length) {
+    length = 0;
+    if (!out || capacity < dumpSize()) {
+        return HMS_CAM_NO_MEM;
+    }
+
+    HMS_CAM_TraceHeaderTypeDef header = {};
+    header.magic    = HMS_CAM_TRACE_MAGIC;
+    header.version  = HMS_CAM_TRACE_VERSION;
+    header.cores    = HMS_CAM_TRACE_CORES;
+    #if defined(HMS_CAM_PLATFORM_ESP_IDF)
+        header.ticksPerUs = esp_rom_get_cpu_ticks_per_us();
+        header.tickBits   = 32;                                                             // CCOUNT
+    #else
+        header.ticksPerUs = 1000;
+        header.tickBits   = 64;
+    #endif
+    memcpy(out, &header, sizeof(header));
+    uint8_t *p = out + sizeof(header);
+
+    for (uint32_t c = 0; c < HMS_CAM_TRACE_CORES; c++) {
+        HMS_CAM_TraceCoreTypeDef core = {};
+        #if defined(HMS_CAM_PLATFORM_ESP_IDF) && !defined(CONFIG_FREERTOS_UNICORE)
+            esp_ipc_call_blocking(c, traceAnchor, &core);                                   // Read CCOUNT on that core
+        #else
+            traceAnchor(&core);
+        #endif
+
+        TraceRing &ring  = traceRings[c];
+        uint32_t  head   = ring.head.load(std::memory_order_acquire);
+        uint32_t  count  = head < HMS_CAM_TRACE_EVENTS ? head : HMS_CAM_TRACE_EVENTS;
+        HMS_CAM_TraceEventTypeDef *events = (HMS_CAM_TraceEventTypeDef *)(p + sizeof(core));
+        for (uint32_t i = 0; i < count; i++) {
+            events[i] = ring.events[(head - count + i) & (HMS_CAM_TRACE_EVENTS - 1)];
+        }
+
+        uint32_t reused = ring.head.load(std::memory_order_acquire) - head;                 // Slots overwritten during the copy
+        uint32_t skip   = reused < count ? reused : count;
+        if (skip) {
+            memmove(events, events + skip, (count - skip) * sizeof(*events));
+        }
+        core.count = count - skip;
+        core.lost  = head - count + skip;
+
+        memcpy(p, &core, sizeof(core));
+        p += sizeof(core) + core.count * sizeof(*events);
+    }
+
+    length = (size_t)(p - out);
+    return HMS_CAM_OK;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_Trace::dump(const char *path) {
+    if (!path) {
+        return HMS_CAM_ERROR;
+    }
+
+    size_t size = dumpSize();
+    #if defined(HMS_CAM_PLATFORM_ESP_IDF)
+        uint8_t *buffer = (uint8_t *)heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (!buffer) {
+            buffer = (uint8_t *)heap_caps_malloc(size, MALLOC_CAP_8BIT);
+        }
+    #else
+        uint8_t *buffer = (uint8_t *)malloc(size);
+    #endif
+    if (!buffer) {
+        return HMS_CAM_NO_MEM;
+    }
+
+    size_t length = 0;
+    HMS_CAM_StatusTypeDef status = dump(buffer, size, length);
+    if (status == HMS_CAM_OK) {
+        FILE *file = fopen(path, "wb");
+        if (!file) {
+            HMS_CAM_LOGGER(error, "Cannot open %s for the trace dump", path);
+            status = HMS_CAM_ERROR;
+        } else {
+            if (fwrite(buffer, 1, length, file) != length) {
+                status = HMS_CAM_ERROR;
+            }
+            if (fclose(file) != 0) {
+                status = HMS_CAM_ERROR;
+            }
+            if (status != HMS_CAM_OK) {
+                remove(path);                                                               // No partial dumps
+            }
+        }
+    }
+
+    #if defined(HMS_CAM_PLATFORM_ESP_IDF)
+        heap_caps_free(buffer);
+    #else
+        free(buffer);
+    #endif
+    return status;
+}
+
+#else
+
+void HMS_CAM_Trace::record(HMS_CAM_TraceEventType, HMS_CAM_TracePhase, uint32_t) {
+}
+
+void HMS_CAM_Trace::clear() {
+}
+
+size_t HMS_CAM_Trace::dumpSize() {
+    return sizeof(HMS_CAM_TraceHeaderTypeDef);
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_Trace::dump(uint8_t *, size_t, size_t &length) {
+    length = 0;
+    HMS_CAM_LOGGER(error, "Tracing not compiled in, build with HMS_CAM_TRACE");
+    return HMS_CAM_ERROR;
+}
+
+HMS_CAM_StatusTypeDef HMS_CAM_Trace::dump(const char *) {
+    HMS_CAM_LOGGER(error, "Tracing not compiled in, build with HMS_CAM_TRACE");
+    return HMS_CAM_ERROR;
+}
+
+#endif // HMS_CAM_TRACE_ENABLED
+
+#endif // HMS_CAM_HAS_CAMERA_API
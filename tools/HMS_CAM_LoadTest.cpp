@@ -0,0 +1,365 @@
+#include "HMS_CAM.h"
+#include "HMS_CAM_Stream.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__)
+    #include <sched.h>
+#endif
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: N simulated cameras, each with its own capture task, a LATEST │
+  │       subscriber behind an HMS_CAM_Stream and a pump thread whose   │
+  │       sink copies every part like a socket write would. Latency is  │
+  │       sensor timestamp to the last byte accepted by the sink, read  │
+  │       back from the X-Timestamp part header. Skipped frames were    │
+  │       replaced in the subscriber, missed ones never left the sensor │
+  │       because the capture task fell behind its frame period. On     │
+  │       Linux each run is pinned to the first K allowed CPUs, so the  │
+  │       --cores sweep shows how the fleet scales as cores are added.  │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+struct LoadCamera {
+    std::unique_ptr<HMS_CAM>    cam;
+    HMS_CAM_Stream              stream;
+    std::thread                 pump;
+    std::vector<uint8_t>        copy;                                                       // Sink destination
+    std::vector<uint32_t>       latencyUs;                                                  // Samples while recording
+    uint64_t                    frames          = 0;                                        // Frames sunk while recording
+    uint64_t                    bytes           = 0;
+    HMS_CAM_StreamStatsTypeDef  first           = {};                                       // Stream counters, taken by the pump
+    HMS_CAM_StreamStatsTypeDef  last            = {};
+    HMS_CAM_StatsTypeDef        capture         = {};                                       // Capture counters of the window
+};
+
+struct LoadOptions {
+    std::vector<int>            cameras         = { 4 };
+    std::vector<int>            cores;                                                      // Empty = 1, 2, 4 ... all
+    float                       fps             = 15.0f;
+    framesize_t                 size            = FRAMESIZE_VGA;
+    HMS_CAM_SimPattern          pattern         = HMS_CAM_SIM_MOVING_BOX;
+    int                         quality         = 12;
+    float                       seconds         = 5.0f;
+    float                       warmup          = 1.0f;
+    bool                        copyFrames      = true;                                     // Sensor copies like DMA
+};
+
+struct LoadResult {
+    int                         cores;
+    int                         cameras;
+    double                      fps;                                                        // Frames sent per second, all cameras
+    double                      bytesPerSecond;
+    uint64_t                    skipped;
+    uint64_t                    missed;
+    uint32_t                    p50Us;                                                      // Median of the per-camera p50
+    uint32_t                    p99Us;                                                      // Worst per-camera p99
+};
+
+static std::atomic<bool>        loadRecording{false};
+
+static int32_t loadSink(const HMS_CAM_IOVecTypeDef *iov, size_t count, void *context) {
+    LoadCamera *camera = static_cast<LoadCamera*>(context);
+    size_t      total  = 0;
+    for (size_t i = 0; i < count; i++) {
+        total += iov[i].length;
+    }
+    if (camera->copy.size() < total) {
+        camera->copy.resize(total);
+    }
+
+    size_t offset = 0;
+    for (size_t i = 0; i < count; i++) {
+        memcpy(camera->copy.data() + offset, iov[i].base, iov[i].length);
+        offset += iov[i].length;
+    }
+
+    if (!loadRecording.load(std::memory_order_relaxed)) {
+        return (int32_t)total;
+    }
+    camera->bytes += total;
+    if (count != HMS_CAM_STREAM_IOV_COUNT) {
+        return (int32_t)total;                                                              // Not the start of a frame
+    }
+
+    char   header[HMS_CAM_STREAM_PART_HEADER_MAX];
+    size_t length = std::min(iov[0].length, sizeof(header) - 1);
+    memcpy(header, iov[0].base, length);
+    header[length] = '\0';
+
+    const char *stamp = strstr(header, "X-Timestamp: ");
+    if (stamp) {
+        char    *dot = NULL;
+        int64_t  sec = strtoll(stamp + 13, &dot, 10);
+        int64_t  us  = sec * 1000000 + (dot && *dot == '.' ? strtoll(dot + 1, NULL, 10) : 0);
+        int64_t  age = HMS_CAM_Micros() - us;
+        camera->latencyUs.push_back(age < 0 ? 0 : (uint32_t)age);
+    }
+    camera->frames++;
+    return (int32_t)total;
+}
+
+static uint32_t loadPercentile(std::vector<uint32_t> &samples, float p) {
+    if (samples.empty()) {
+        return 0;
+    }
+    size_t rank = (size_t)(p / 100.0f * (float)(samples.size() - 1) + 0.5f);
+    std::nth_element(samples.begin(), samples.begin() + rank, samples.end());
+    return samples[rank];
+}
+
+static void loadPin(int cores) {
+    #if defined(__linux__)
+        static cpu_set_t allowed;
+        static bool      saved = false;
+        if (!saved) {
+            sched_getaffinity(0, sizeof(allowed), &allowed);
+            saved = true;
+        }
+
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        for (int cpu = 0, taken = 0; cpu < CPU_SETSIZE && taken < cores; cpu++) {
+            if (CPU_ISSET(cpu, &allowed)) {
+                CPU_SET(cpu, &cpus);
+                taken++;
+            }
+        }
+        sched_setaffinity(0, sizeof(cpus), &cpus);                                          // Inherited by the threads below
+    #else
+        (void)cores;
+    #endif
+}
+
+static int loadCoresAvailable() {
+    #if defined(__linux__)
+        cpu_set_t allowed;
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+            return CPU_COUNT(&allowed);
+        }
+    #endif
+    unsigned cores = std::thread::hardware_concurrency();
+    return cores ? (int)cores : 1;
+}
+
+static bool loadRun(const LoadOptions &options, int cores, int count, LoadResult &result) {
+    loadPin(cores);
+
+    std::vector<std::unique_ptr<LoadCamera>> cameras;
+    for (int i = 0; i < count; i++) {
+        char name[HMS_CAM_NAME_MAX];
+        snprintf(name, sizeof(name), "cam%02d", i);
+
+        std::unique_ptr<LoadCamera> camera(new LoadCamera());
+        camera->cam.reset(new HMS_CAM(name));
+        HMS_CAM_SimSensor &sim = camera->cam->getSimSensor();
+        sim.setPattern(options.pattern);
+        sim.setFrameRate(options.fps);
+        sim.setSeed((uint32_t)i + 1);
+        sim.setCopyFrames(options.copyFrames);
+
+        camera->cam->setPixelFormat(PIXFORMAT_JPEG);
+        camera->cam->setFrameSize(options.size);
+        camera->cam->setJPEGQuality(options.quality);
+        camera->cam->setFBCount(2);
+        camera->cam->setCaptureTask(true);
+        if (camera->cam->begin() != HMS_CAM_OK) {
+            fprintf(stderr, "%s: begin() failed\n", name);
+            return false;
+        }
+        if (camera->stream.begin(*camera->cam, loadSink, camera.get()) != HMS_CAM_OK) {
+            fprintf(stderr, "%s: no subscriber slot for the stream\n", name);
+            return false;
+        }
+        camera->latencyUs.reserve((size_t)(options.fps * options.seconds * 1.25f) + 64);
+        cameras.push_back(std::move(camera));
+    }
+
+    std::atomic<bool> running{true};
+    for (std::unique_ptr<LoadCamera> &camera : cameras) {
+        LoadCamera *c = camera.get();
+        c->pump = std::thread([c, &running]() {
+            bool recording = false;
+            while (running.load(std::memory_order_relaxed)) {
+                if (recording != loadRecording.load(std::memory_order_relaxed)) {
+                    recording = !recording;
+                    c->stream.getStats(recording ? c->first : c->last);                     // The stream is not thread-safe
+                }
+                c->stream.pump(50);
+            }
+        });
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds((int64_t)(options.warmup * 1000.0f)));
+    for (std::unique_ptr<LoadCamera> &camera : cameras) {
+        camera->cam->resetStats();
+    }
+    loadRecording.store(true);
+    int64_t start = HMS_CAM_Micros();
+    std::this_thread::sleep_for(std::chrono::milliseconds((int64_t)(options.seconds * 1000.0f)));
+    loadRecording.store(false);
+    double elapsed = (double)(HMS_CAM_Micros() - start) / 1e6;
+    for (std::unique_ptr<LoadCamera> &camera : cameras) {
+        camera->cam->getStats(camera->capture);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));                            // Pumps see the end of the window
+
+    running.store(false);
+    for (std::unique_ptr<LoadCamera> &camera : cameras) {
+        camera->pump.join();
+    }
+
+    result         = {};
+    result.cores   = cores;
+    result.cameras = count;
+    uint64_t expected = (uint64_t)(options.fps * elapsed + 0.5);
+    std::vector<uint32_t> medians;
+
+    printf("\n%d core(s), %d camera(s), %ux%u JPEG q%d at %.1f fps, %.1f s\n", cores, count,
+           resolution[options.size].width, resolution[options.size].height, options.quality, options.fps, elapsed);
+    printf("  %-8s %8s %8s %10s %10s %10s %8s %8s\n", "camera", "frames", "fps", "MB/s", "p50 ms", "p99 ms", "skipped", "missed");
+    for (std::unique_ptr<LoadCamera> &camera : cameras) {
+        uint64_t sent    = camera->frames;
+        uint64_t bytes   = camera->bytes;
+        uint64_t skipped = camera->last.framesSkipped - camera->first.framesSkipped;
+        uint64_t missed  = expected > camera->capture.frames ? expected - camera->capture.frames : 0;
+        uint32_t p50     = loadPercentile(camera->latencyUs, 50.0f);
+        uint32_t p99     = loadPercentile(camera->latencyUs, 99.0f);
+
+        printf("  %-8s %8llu %8.2f %10.2f %10.2f %10.2f %8llu %8llu\n", camera->cam->getName(),
+               (unsigned long long)sent, sent / elapsed, bytes / elapsed / 1e6, p50 / 1000.0, p99 / 1000.0,
+               (unsigned long long)skipped, (unsigned long long)missed);
+
+        result.fps            += sent / elapsed;
+        result.bytesPerSecond += bytes / elapsed;
+        result.skipped        += skipped;
+        result.missed         += missed;
+        result.p99Us           = std::max(result.p99Us, p99);
+        medians.push_back(p50);
+
+        camera->stream.end();
+    }
+    result.p50Us = loadPercentile(medians, 50.0f);
+    printf("  %-8s %8s %8.2f %10.2f %10.2f %10.2f %8llu %8llu\n", "total", "", result.fps,
+           result.bytesPerSecond / 1e6, result.p50Us / 1000.0, result.p99Us / 1000.0,
+           (unsigned long long)result.skipped, (unsigned long long)result.missed);
+    return true;
+}
+
+static bool loadParseList(const char *text, std::vector<int> &out) {
+    out.clear();
+    for (const char *p = text; *p; ) {
+        char *end = NULL;
+        long  v   = strtol(p, &end, 10);
+        if (end == p || v <= 0) {
+            return false;
+        }
+        out.push_back((int)v);
+        p = *end == ',' ? end + 1 : end;
+        if (*end && *end != ',') {
+            return false;
+        }
+    }
+    return !out.empty();
+}
+
+static bool loadParseSize(const char *text, framesize_t &size) {
+    unsigned width = 0, height = 0;
+    if (sscanf(text, "%ux%u", &width, &height) != 2) {
+        return false;
+    }
+    for (int i = 0; i < FRAMESIZE_INVALID; i++) {
+        if (resolution[i].width == width && resolution[i].height == height) {
+            size = (framesize_t)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool loadParsePattern(const char *text, HMS_CAM_SimPattern &pattern) {
+    static const struct { const char *name; HMS_CAM_SimPattern pattern; } patterns[] = {
+        { "bars", HMS_CAM_SIM_COLOR_BARS }, { "gradient", HMS_CAM_SIM_GRADIENT },
+        { "box",  HMS_CAM_SIM_MOVING_BOX }, { "noise",    HMS_CAM_SIM_NOISE    },
+    };
+    for (const auto &p : patterns) {
+        if (strcmp(text, p.name) == 0) {
+            pattern = p.pattern;
+            return true;
+        }
+    }
+    return false;
+}
+
+int main(int argc, char **argv) {
+    LoadOptions options;
+    for (int i = 1; i < argc; i++) {
+        const char *a  = argv[i];
+        bool        ok = true;
+        if (strncmp(a, "--cameras=", 10) == 0) {
+            ok = loadParseList(a + 10, options.cameras);
+        } else if (strncmp(a, "--cores=", 8) == 0) {
+            ok = loadParseList(a + 8, options.cores);
+        } else if (strncmp(a, "--fps=", 6) == 0) {
+            options.fps = strtof(a + 6, NULL);
+            ok = options.fps > 0.0f;
+        } else if (strncmp(a, "--size=", 7) == 0) {
+            ok = loadParseSize(a + 7, options.size);
+        } else if (strncmp(a, "--quality=", 10) == 0) {
+            options.quality = atoi(a + 10);
+            ok = options.quality >= 2 && options.quality <= 63;
+        } else if (strncmp(a, "--pattern=", 10) == 0) {
+            ok = loadParsePattern(a + 10, options.pattern);
+        } else if (strncmp(a, "--seconds=", 10) == 0) {
+            options.seconds = strtof(a + 10, NULL);
+            ok = options.seconds > 0.0f;
+        } else if (strcmp(a, "--zero-copy") == 0) {
+            options.copyFrames = false;
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            fprintf(stderr, "usage: %s [--cameras=<n>[,<n>...]] [--cores=<k>[,<k>...]] [--fps=<f>] [--size=<w>x<h>]\n"
+                            "          [--quality=<2-63>] [--pattern=bars|gradient|box|noise] [--seconds=<s>] [--zero-copy]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+
+    int available = loadCoresAvailable();
+    if (options.cores.empty()) {
+        for (int k = 1; k < available; k *= 2) {
+            options.cores.push_back(k);
+        }
+        options.cores.push_back(available);
+    }
+
+    std::vector<LoadResult> results;
+    for (int cores : options.cores) {
+        if (cores > available) {
+            fprintf(stderr, "Skipping %d cores, only %d available\n", cores, available);
+            continue;
+        }
+        for (int count : options.cameras) {
+            LoadResult result;
+            if (!loadRun(options, cores, count, result)) {
+                return 1;
+            }
+            results.push_back(result);
+        }
+    }
+
+    printf("\n  %5s %7s %10s %10s %10s %10s %8s %8s\n", "cores", "cameras", "fps", "MB/s", "p50 ms", "p99 ms", "skipped", "missed");
+    for (const LoadResult &r : results) {
+        printf("  %5d %7d %10.2f %10.2f %10.2f %10.2f %8llu %8llu\n", r.cores, r.cameras, r.fps,
+               r.bytesPerSecond / 1e6, r.p50Us / 1000.0, r.p99Us / 1000.0, (unsigned long long)r.skipped, (unsigned long long)r.missed);
+    }
+    return 0;
+}
@@ -0,0 +1,141 @@
+#include "HMS_CAM_Trace.h"
+
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Converts an HMS_CAM_Trace::dump() file to Chrome trace JSON,  │
+  │       which chrome://tracing and ui.perfetto.dev both open.         │
+  │       Ticks are mapped to microseconds through each core's anchor.  │
+  │       32-bit counters are unwrapped backwards from the anchor, gaps │
+  │       of more than one wrap between two events cannot be told apart.│
+  │       An end whose begin was overwritten in the ring is dropped.    │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+struct ExportEvent {
+    double      us;
+    uint32_t    core;
+    HMS_CAM_TraceEventTypeDef event;
+};
+
+static bool exportRead(const char *path, std::vector<uint8_t> &data) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+    uint8_t chunk[65536];
+    size_t  n;
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        data.insert(data.end(), chunk, chunk + n);
+    }
+    fclose(file);
+    return true;
+}
+
+static bool exportParse(const std::vector<uint8_t> &data, std::vector<ExportEvent> &events, uint64_t &lost) {
+    HMS_CAM_TraceHeaderTypeDef header;
+    if (data.size() < sizeof(header)) {
+        return false;
+    }
+    memcpy(&header, data.data(), sizeof(header));
+    if (header.magic != HMS_CAM_TRACE_MAGIC || header.version != HMS_CAM_TRACE_VERSION || !header.ticksPerUs) {
+        return false;
+    }
+
+    size_t pos = sizeof(header);
+    for (uint32_t c = 0; c < header.cores; c++) {
+        HMS_CAM_TraceCoreTypeDef core;
+        if (pos + sizeof(core) > data.size()) {
+            return false;
+        }
+        memcpy(&core, data.data() + pos, sizeof(core));
+        pos += sizeof(core);
+        if (pos + (size_t)core.count * sizeof(HMS_CAM_TraceEventTypeDef) > data.size()) {
+            return false;
+        }
+        lost += core.lost;
+
+        std::vector<HMS_CAM_TraceEventTypeDef> ring(core.count);
+        memcpy(ring.data(), data.data() + pos, ring.size() * sizeof(HMS_CAM_TraceEventTypeDef));
+        pos += ring.size() * sizeof(HMS_CAM_TraceEventTypeDef);
+
+        int64_t  back = 0;                                                                  // Ticks before the anchor
+        uint32_t next = (uint32_t)core.anchorTicks;
+        for (size_t i = ring.size(); i-- > 0; ) {
+            if (header.tickBits == 32) {
+                uint32_t ticks = (uint32_t)ring[i].ticks;
+                uint32_t delta = next - ticks;                                              // Distance back to the newer event
+                back += delta > 0xF0000000u ? (int64_t)(int32_t)delta : (int64_t)delta;     // Preempted between claim and read
+                next  = ticks;
+            } else {
+                back  = (int64_t)(core.anchorTicks - ring[i].ticks);
+            }
+            events.push_back({ (double)core.anchorUs - (double)back / header.ticksPerUs, c, ring[i] });
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2 || argc > 3) {
+        fprintf(stderr, "usage: %s <trace dump> [<output.json>]\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<uint8_t> data;
+    if (!exportRead(argv[1], data)) {
+        fprintf(stderr, "Cannot read %s\n", argv[1]);
+        return 1;
+    }
+
+    std::vector<ExportEvent> events;
+    uint64_t lost = 0;
+    if (!exportParse(data, events, lost)) {
+        fprintf(stderr, "%s is not an HMS_CAM trace dump (version %u)\n", argv[1], (unsigned)HMS_CAM_TRACE_VERSION);
+        return 1;
+    }
+    std::stable_sort(events.begin(), events.end(), [](const ExportEvent &a, const ExportEvent &b) { return a.us < b.us; });
+
+    FILE *out = argc == 3 ? fopen(argv[2], "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "Cannot create %s\n", argv[2]);
+        return 1;
+    }
+
+    std::map<uint16_t, uint32_t> depth;                                                     // Open spans per thread
+    size_t written = 0, dropped = 0;
+    fprintf(out, "{\n  \"displayTimeUnit\": \"ms\",\n  \"otherData\": { \"lost\": %llu },\n  \"traceEvents\": [",
+            (unsigned long long)lost);
+    for (const ExportEvent &e : events) {
+        const char *phase;
+        switch (e.event.phase) {
+            case HMS_CAM_TRACE_BEGIN:   phase = "B"; depth[e.event.thread]++;  break;
+            case HMS_CAM_TRACE_END:
+                if (!depth[e.event.thread]) {
+                    dropped++;
+                    continue;
+                }
+                phase = "E";
+                depth[e.event.thread]--;
+                break;
+            default:                    phase = "i";                            break;
+        }
+        fprintf(out, "%s\n    { \"name\": \"%s\", \"cat\": \"hms_cam\", \"ph\": \"%s\", \"ts\": %.3f, \"pid\": 1, \"tid\": %u,%s"
+                     " \"args\": { \"arg\": %u, \"core\": %u } }",
+                written ? "," : "", HMS_CAM_Trace::eventName(e.event.event), phase, e.us, (unsigned)e.event.thread,
+                e.event.phase == HMS_CAM_TRACE_INSTANT ? " \"s\": \"t\"," : "", (unsigned)e.event.arg, (unsigned)e.core);
+        written++;
+    }
+    fprintf(out, "\n  ]\n}\n");
+    if (out != stdout) {
+        fclose(out);
+    }
+
+    fprintf(stderr, "%zu events, %llu lost in the ring, %zu unmatched ends dropped\n", written,
+            (unsigned long long)lost, dropped);
+    return 0;
+}